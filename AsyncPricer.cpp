@@ -0,0 +1,199 @@
+#include "AsyncPricer.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+// Shared state of one asynchronous pricing
+struct AsyncPricingJob {
+    SABRParameters params;
+    unsigned int seed;
+    BermudanOption option;
+    int nPaths;
+    int totalSteps;
+    double T;
+    double discountRate;
+    int polynomialDegree;
+
+    double** F_paths;
+    double** alpha_paths;
+    std::atomic<int> chunksLeft;
+    PricingControl control;
+    std::promise<double> promise;
+    std::atomic<double> standardError;
+    std::mutex errorMutex;
+    std::exception_ptr error;     // First exception raised by a task
+
+    AsyncPricingJob(const SABRParameters& params, unsigned int seed, const BermudanOption& option,
+                    int nPaths, double r, int polyDegree)
+        : params(params), seed(seed), option(option), nPaths(nPaths),
+          totalSteps(LSMPricer::simulationSteps(option)),
+          T(option.getExerciseDate(option.getNExerciseDates() - 1)),
+          discountRate(r), polynomialDegree(polyDegree),
+          F_paths(new double*[nPaths]), alpha_paths(new double*[nPaths]),
+          chunksLeft(0), standardError(0.0) {
+        for (int i = 0; i < nPaths; i++) {
+            F_paths[i] = 0;
+            alpha_paths[i] = 0;
+        }
+    }
+
+    ~AsyncPricingJob() {
+        releasePaths();
+    }
+
+    void releasePaths() {
+        if (!F_paths) return;
+        for (int i = 0; i < nPaths; i++) {
+            delete[] F_paths[i];
+            delete[] alpha_paths[i];
+        }
+        delete[] F_paths;
+        delete[] alpha_paths;
+        F_paths = 0;
+        alpha_paths = 0;
+    }
+
+    // Simulate paths [first, first + count) unless cancelled
+    void simulateChunk(int first, int count) {
+        if (control.isCancelled()) return;
+        for (int i = first; i < first + count; i++) {
+            F_paths[i] = new double[totalSteps + 1];
+            alpha_paths[i] = new double[totalSteps + 1];
+        }
+        SABRSimulator sim(params, seed);
+        sim.simulatePaths(count, totalSteps, T, F_paths + first, alpha_paths + first, first);
+        control.pathsSimulated += count;
+    }
+
+    // Keep the first error and stop the other chunks
+    void fail(std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = e;
+        control.cancel();
+    }
+
+    // Backward induction once every chunk is in; fulfils the promise
+    void finish() {
+        double price = -1.0;
+        try {
+            if (!error && !control.isCancelled()) {
+                LSMPricer pricer(discountRate, polynomialDegree);
+                pricer.setVerbose(false);
+                pricer.setControl(&control);
+                price = pricer.priceFromPaths(F_paths, alpha_paths, nPaths, totalSteps, T, option);
+                standardError = pricer.getStandardError();
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        releasePaths();
+        if (error) {
+            promise.set_exception(error);
+        } else {
+            promise.set_value(price);
+        }
+    }
+};
+
+// Constructor (empty handle)
+PricingHandle::PricingHandle() {
+}
+
+// Constructor
+PricingHandle::PricingHandle(const std::shared_ptr<AsyncPricingJob>& job,
+                             const std::shared_future<double>& result)
+    : job(job), result(result) {
+}
+
+// Result
+double PricingHandle::get() const {
+    return result.get();
+}
+
+// Wait for completion
+void PricingHandle::wait() const {
+    result.wait();
+}
+
+// Wait with timeout
+bool PricingHandle::waitFor(double seconds) const {
+    return result.wait_for(std::chrono::duration<double>(seconds)) == std::future_status::ready;
+}
+
+// Completion check
+bool PricingHandle::isDone() const {
+    return waitFor(0.0);
+}
+
+// Cancellation
+void PricingHandle::cancel() {
+    if (job) job->control.cancel();
+}
+
+bool PricingHandle::isCancelled() const {
+    return job && job->control.isCancelled();
+}
+
+// Progress
+int PricingHandle::getPathsSimulated() const {
+    return job ? job->control.pathsSimulated.load() : 0;
+}
+
+int PricingHandle::getDatesProcessed() const {
+    return job ? job->control.datesProcessed.load() : 0;
+}
+
+int PricingHandle::getNPaths() const {
+    return job ? job->nPaths : 0;
+}
+
+int PricingHandle::getNDates() const {
+    return job ? job->option.getNExerciseDates() - 1 : 0;
+}
+
+double PricingHandle::getStandardError() const {
+    return job ? job->standardError.load() : 0.0;
+}
+
+// Constructor
+AsyncPricer::AsyncPricer(ThreadPool& pool, double r, int polyDegree, int chunkPaths)
+    : pool(pool) {
+    this->discountRate = r;
+    this->polynomialDegree = polyDegree;
+    this->chunkPaths = std::max(chunkPaths, 1);
+}
+
+// Destructor
+AsyncPricer::~AsyncPricer() {
+    // Jobs own their state; nothing to clean up
+}
+
+// Queue the simulation chunks of one pricing
+PricingHandle AsyncPricer::submit(const SABRParameters& params, unsigned int seed,
+                                  const BermudanOption& option, int nPaths) {
+    std::shared_ptr<AsyncPricingJob> job(
+        new AsyncPricingJob(params, seed, option, nPaths, discountRate, polynomialDegree));
+    std::shared_future<double> result = job->promise.get_future().share();
+
+    int nChunks = (nPaths + chunkPaths - 1) / chunkPaths;
+    job->chunksLeft = nChunks;
+    if (nChunks == 0) {
+        job->finish();
+    }
+    for (int c = 0; c < nChunks; c++) {
+        int first = c * chunkPaths;
+        int count = std::min(chunkPaths, nPaths - first);
+        pool.submit([job, first, count]() {
+            try {
+                job->simulateChunk(first, count);
+            } catch (...) {
+                job->fail(std::current_exception());
+            }
+            // The last chunk to finish runs the backward induction
+            if (--job->chunksLeft == 0) {
+                job->finish();
+            }
+        });
+    }
+    return PricingHandle(job, result);
+}
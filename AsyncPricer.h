@@ -0,0 +1,82 @@
+#ifndef ASYNCPRICER_H
+#define ASYNCPRICER_H
+
+#include "SABRSimulator.h"
+#include "BermudanOption.h"
+#include "LSMPricer.h"
+#include "ThreadPool.h"
+#include <future>
+#include <memory>
+
+// State of one asynchronous pricing, shared by its tasks and handle
+struct AsyncPricingJob;
+
+// Handle on an asynchronous pricing
+// Copies share the same pricing. get() blocks until the price is known;
+// a cancelled pricing yields -1 (like the other LSMPricer failures).
+class PricingHandle {
+private:
+    std::shared_ptr<AsyncPricingJob> job;
+    std::shared_future<double> result;
+
+public:
+    // Constructor (empty handle; see AsyncPricer::submit)
+    PricingHandle();
+    PricingHandle(const std::shared_ptr<AsyncPricingJob>& job, const std::shared_future<double>& result);
+
+    // Block until done; price, or -1 if cancelled
+    // Rethrows an exception raised while pricing
+    double get() const;
+
+    // Block until done, or for at most seconds; true if done
+    void wait() const;
+    bool waitFor(double seconds) const;
+    bool isDone() const;
+
+    // Request cooperative cancellation: checked between simulation chunks
+    // and between exercise dates, so it takes effect within one chunk/date
+    void cancel();
+    bool isCancelled() const;
+
+    // Progress
+    int getPathsSimulated() const;
+    int getDatesProcessed() const;      // Backward-induction exercise dates done
+    int getNPaths() const;
+    int getNDates() const;              // Exercise dates to process (dates - 1)
+
+    // Standard error of the finished pricing (0 before)
+    double getStandardError() const;
+};
+
+// Asynchronous Bermudan pricing on a shared ThreadPool
+// Each pricing is split into simulation chunks of chunkPaths paths, one pool
+// task each (paths keep their own RNG substreams, so the price equals
+// LSMPricer::price with the same seed); the task finishing the last chunk
+// runs the backward induction. Tasks never block on each other, so any
+// number of pricings can be queued on one pool: they share its threads
+// instead of each bringing its own.
+class AsyncPricer {
+private:
+    ThreadPool& pool;
+    double discountRate;
+    int polynomialDegree;
+    int chunkPaths;
+
+public:
+    // Constructor
+    AsyncPricer(ThreadPool& pool, double r = 0.05, int polyDegree = 3, int chunkPaths = 16384);
+
+    // Destructor
+    ~AsyncPricer();
+
+    // Start pricing option under model (params, seed) with nPaths paths
+    PricingHandle submit(const SABRParameters& params, unsigned int seed,
+                         const BermudanOption& option, int nPaths);
+
+    // Get parameters
+    double getDiscountRate() const { return discountRate; }
+    int getPolynomialDegree() const { return polynomialDegree; }
+    int getChunkPaths() const { return chunkPaths; }
+};
+
+#endif
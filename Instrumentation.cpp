@@ -0,0 +1,86 @@
+#include "Instrumentation.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <time.h>
+
+#ifdef LSM_COUNT_ALLOCATIONS
+// Count every allocation through the global operator new (replaces it for
+// the whole program)
+static std::atomic<long long> allocations(0);
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (p == 0) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (p == 0) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+#endif
+
+// Clear diagnostics
+void PricingDiagnostics::clear() {
+    simulation.clear();
+    itmScan.clear();
+    regression.clear();
+    exerciseDecision.clear();
+    reduction.clear();
+    nPaths = 0;
+    pathsPerSecond = 0.0;
+    nItm.clear();
+    itmFraction.clear();
+    conditionNumber.clear();
+    regressionPoints.clear();
+}
+
+// Monotonic wall clock
+double Instrumentation::wallTime() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Thread CPU clock
+double Instrumentation::cpuTime() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// Allocations so far (0 unless built with LSM_COUNT_ALLOCATIONS)
+long long Instrumentation::allocationCount() {
+#ifdef LSM_COUNT_ALLOCATIONS
+    return allocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+// Start timing
+PhaseTimer::PhaseTimer(PhaseStats& stats) : stats(stats) {
+    wall0 = Instrumentation::wallTime();
+    cpu0 = Instrumentation::cpuTime();
+    alloc0 = Instrumentation::allocationCount();
+}
+
+// Stop timing and accumulate
+PhaseTimer::~PhaseTimer() {
+    stats.wallSeconds += Instrumentation::wallTime() - wall0;
+    stats.cpuSeconds += Instrumentation::cpuTime() - cpu0;
+    stats.allocations += Instrumentation::allocationCount() - alloc0;
+    stats.calls++;
+}
@@ -0,0 +1,79 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <vector>
+
+// Hot-path instrumentation for the pricer
+// Enabled by default; build with -DLSM_NO_INSTRUMENTATION to compile every
+// probe out (LSM_PHASE expands to nothing).
+// Allocation counting is opt-in: build with -DLSM_COUNT_ALLOCATIONS to have
+// Instrumentation.cpp replace the global operator new / new[] (and delete)
+// with counting versions. That replacement applies to the whole program
+// linking it, not only to the pricer; without it allocations read 0.
+#ifndef LSM_NO_INSTRUMENTATION
+#define LSM_INSTRUMENT 1
+#endif
+#if defined(LSM_COUNT_ALLOCATIONS) && !defined(LSM_INSTRUMENT)
+#undef LSM_COUNT_ALLOCATIONS
+#endif
+
+// Accumulated cost of one pricing phase
+struct PhaseStats {
+    double wallSeconds;
+    double cpuSeconds;       // CPU time of the calling thread
+    long long calls;
+    long long allocations;   // operator new calls (process-wide) during the phase
+                             // (LSM_COUNT_ALLOCATIONS builds only, 0 otherwise)
+    
+    PhaseStats() { clear(); }
+    void clear() { wallSeconds = 0.0; cpuSeconds = 0.0; calls = 0; allocations = 0; }
+};
+
+// Per-pricing diagnostics recorded by LSMPricer
+struct PricingDiagnostics {
+    PhaseStats simulation;          // SABRSimulator::simulatePaths
+    PhaseStats itmScan;             // In-the-money selection
+    PhaseStats regression;          // PolynomialRegression::fit
+    PhaseStats exerciseDecision;    // Exercise vs continue update
+    PhaseStats reduction;           // Final discounting, mean and std error
+    int nPaths;
+    double pathsPerSecond;          // Simulation throughput
+    
+    // Per exercise date (index m = 0..n-2; maturity has no regression)
+    std::vector<int> nItm;
+    std::vector<double> itmFraction;
+    std::vector<double> conditionNumber;    // 1-norm condition of X^T X
+    std::vector<int> regressionPoints;      // ITM paths the regression used
+    
+    PricingDiagnostics() { clear(); }
+    void clear();
+};
+
+// Clocks and counters
+class Instrumentation {
+public:
+    static double wallTime();             // Seconds, monotonic
+    static double cpuTime();              // Seconds of CPU used by this thread
+    static long long allocationCount();   // operator new calls so far (see LSM_COUNT_ALLOCATIONS)
+};
+
+// RAII timer adding its scope's cost to a PhaseStats
+class PhaseTimer {
+private:
+    PhaseStats& stats;
+    double wall0;
+    double cpu0;
+    long long alloc0;
+    
+public:
+    PhaseTimer(PhaseStats& stats);
+    ~PhaseTimer();
+};
+
+#ifdef LSM_INSTRUMENT
+#define LSM_PHASE(name, stats) PhaseTimer name(stats)
+#else
+#define LSM_PHASE(name, stats)
+#endif
+
+#endif
@@ -1,12 +1,25 @@
 #include "LSMPricer.h"
 #include <iostream>
 #include <algorithm>
+#include <future>
+#include <cstdlib>
+#include <limits>
+#include <unistd.h>
 
 // Constructor
 LSMPricer::LSMPricer(double r, int polyDegree) {
     this->discountRate = r;
     this->polynomialDegree = polyDegree;
     this->standardError = 0.0;
+    this->verbose = true;
+    this->lastConditionNumber = 0.0;
+    this->lastRegressionPoints = 0;
+    this->subsampleSize = 0;
+    this->subsampleTolerance = 0.01;
+    this->boundaryDecision = false;
+    this->control = 0;
+    this->maxTimeStep = 0.0;
+    this->extrapolationError = 0.0;
 }
 
 // Destructor
@@ -16,28 +29,163 @@ LSMPricer::~LSMPricer() {
 
 // Regression fit - public method for least squares
 std::vector<double> LSMPricer::regressionFit(const std::vector<double>& X, const std::vector<double>& Y) {
-    PolynomialRegression reg(polynomialDegree);
+    return regressionFit(X, Y, std::vector<double>());
+}
+
+// Evaluate sum_j c[j] x^j
+static double polynomialValue(const std::vector<double>& c, double x) {
+    double result = 0.0;
+    for (int j = static_cast<int>(c.size()) - 1; j >= 0; j--) {
+        result = result * x + c[j];
+    }
+    return result;
+}
+
+// Greatest common divisor (subsample stride)
+static long long gcd(long long a, long long b) {
+    while (b != 0) {
+        long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Fit on a growing subsample of (X, Y, W); returns the points used
+// Points are visited with a golden-ratio stride coprime to n, a full
+// cycle without repeats whose every prefix is spread evenly over the data.
+// The normal equations are extended batch by batch (online least squares)
+// and re-solved after each doubling until the fitted function moves less
+// than subsampleTolerance * RMS(Y) over the sampled range of X. The fit is
+// in z = (X - center) / scale, centred on the first batch, so the normal
+// equations stay well conditioned; coeffs are converted back to powers of X.
+int LSMPricer::subsampledFit(PolynomialRegression& reg, const std::vector<double>& X,
+                             const std::vector<double>& Y, const std::vector<double>& W,
+                             std::vector<double>& coeffs) {
+    int n = static_cast<int>(X.size());
+    int p = polynomialDegree + 1;
+    long long stride = std::max(1LL, static_cast<long long>(n * 0.6180339887498949));
+    while (gcd(stride, n) != 1) {
+        stride++;
+    }
     
-    // Convert vectors to arrays for PolynomialRegression
-    int n = X.size();
-    double* X_arr = new double[n];
-    double* Y_arr = new double[n];
+    std::vector<double> Z_batch, Y_batch, W_batch;
+    std::vector<double> previous(p), current(p);
+    double center = 0.0, scale = 1.0;
+    double lo = 0.0, hi = 0.0, sumSquares = 0.0;
+    long long index = 0;
+    int added = 0;
+    int target = std::min(n, subsampleSize);
+    reg.reset();
+    
+    while (true) {
+        Z_batch.clear();
+        Y_batch.clear();
+        W_batch.clear();
+        long long start = index;
+        if (added == 0) {
+            // Center and scale from the first batch
+            double xMin = X[index], xMax = X[index];
+            for (int k = 0; k < target; k++) {
+                xMin = std::min(xMin, X[start]);
+                xMax = std::max(xMax, X[start]);
+                start += stride;
+                if (start >= n) start -= n;
+            }
+            center = 0.5 * (xMin + xMax);
+            scale = (xMax > xMin) ? 0.5 * (xMax - xMin) : 1.0;
+            lo = (xMin - center) / scale;
+            hi = (xMax - center) / scale;
+        }
+        for (; added < target; added++) {
+            double z = (X[index] - center) / scale;
+            Z_batch.push_back(z);
+            Y_batch.push_back(Y[index]);
+            if (!W.empty()) W_batch.push_back(W[index]);
+            lo = std::min(lo, z);
+            hi = std::max(hi, z);
+            sumSquares += Y[index] * Y[index];
+            index += stride;
+            if (index >= n) index -= n;
+        }
+        if (W.empty()) {
+            reg.addPoints(&Z_batch[0], &Y_batch[0], static_cast<int>(Z_batch.size()));
+        } else {
+            reg.addWeightedPoints(&Z_batch[0], &Y_batch[0], &W_batch[0], static_cast<int>(Z_batch.size()));
+        }
+        reg.solve();
+        for (int j = 0; j < p; j++) {
+            current[j] = reg.getCoefficient(j);
+        }
+        if (added >= n) {
+            break;
+        }
+        
+        // Converged: RMS change of the fit over the batch just added
+        if (added > subsampleSize) {
+            double change = 0.0;
+            for (size_t k = 0; k < Z_batch.size(); k++) {
+                double d = polynomialValue(current, Z_batch[k]) - polynomialValue(previous, Z_batch[k]);
+                change += d * d;
+            }
+            if (sqrt(change / Z_batch.size()) <= subsampleTolerance * sqrt(sumSquares / added)) {
+                break;
+            }
+        }
+        previous.swap(current);
+        target = static_cast<int>(std::min(static_cast<long long>(n), 2LL * target));
+    }
     
-    for (int i = 0; i < n; i++) {
-        X_arr[i] = X[i];
-        Y_arr[i] = Y[i];
+    // sum_k a_k ((X - c) / s)^k = sum_i coeffs[i] X^i
+    coeffs.assign(p, 0.0);
+    for (int k = 0; k < p; k++) {
+        double ak = current[k] / pow(scale, k);
+        double binomial = 1.0;   // C(k, i)
+        for (int i = 0; i <= k; i++) {
+            coeffs[i] += ak * binomial * pow(-center, k - i);
+            binomial = binomial * (k - i) / (i + 1);
+        }
     }
+    return added;
+}
+
+// Weighted regression fit
+std::vector<double> LSMPricer::regressionFit(const std::vector<double>& X, const std::vector<double>& Y,
+                                             const std::vector<double>& W) {
+    PolynomialRegression reg(polynomialDegree);
     
-    reg.fit(X_arr, Y_arr, n);
+    // Convert vectors to arrays for PolynomialRegression
+    int n = X.size();
     
-    // Extract coefficients
     std::vector<double> coeffs(polynomialDegree + 1);
-    for (int i = 0; i <= polynomialDegree; i++) {
-        coeffs[i] = reg.getCoefficient(i);
+    if (subsampleSize > 0 && n > 2 * subsampleSize) {
+        lastRegressionPoints = subsampledFit(reg, X, Y, W, coeffs);
+    } else {
+        double* X_arr = new double[n];
+        double* Y_arr = new double[n];
+        for (int i = 0; i < n; i++) {
+            X_arr[i] = X[i];
+            Y_arr[i] = Y[i];
+        }
+        if (W.empty()) {
+            reg.fit(X_arr, Y_arr, n);
+        } else {
+            reg.reset();
+            reg.addWeightedPoints(X_arr, Y_arr, &W[0], n);
+            reg.solve();
+        }
+        delete[] X_arr;
+        delete[] Y_arr;
+        lastRegressionPoints = n;
+        
+        // Extract coefficients
+        for (int i = 0; i <= polynomialDegree; i++) {
+            coeffs[i] = reg.getCoefficient(i);
+        }
     }
-    
-    delete[] X_arr;
-    delete[] Y_arr;
+#ifdef LSM_INSTRUMENT
+    lastConditionNumber = reg.conditionNumber();
+#endif
     
     return coeffs;
 }
@@ -52,16 +200,213 @@ std::vector<double> LSMPricer::basisFunctions(double F, double alpha) {
     return basis;
 }
 
+// Real roots of sum_j c[j] x^j in (lo, hi), ascending
+// The derivative's roots split [lo, hi] into monotone pieces; each piece
+// with a sign change holds exactly one root, found by bisection.
+static void polynomialRoots(std::vector<double> c, double lo, double hi, std::vector<double>& roots) {
+    while (c.size() > 1 && c.back() == 0.0) {
+        c.pop_back();
+    }
+    int degree = static_cast<int>(c.size()) - 1;
+    if (degree < 1 || !(lo < hi)) {
+        return;
+    }
+    
+    std::vector<double> points(1, lo);
+    if (degree > 1) {
+        std::vector<double> derivative(degree);
+        for (int j = 1; j <= degree; j++) {
+            derivative[j - 1] = j * c[j];
+        }
+        polynomialRoots(derivative, lo, hi, points);
+    }
+    points.push_back(hi);
+    
+    for (size_t k = 0; k + 1 < points.size(); k++) {
+        double a = points[k];
+        double b = points[k + 1];
+        double fa = polynomialValue(c, a);
+        double fb = polynomialValue(c, b);
+        if (fa == 0.0) {
+            if (roots.empty() || roots.back() < a) roots.push_back(a);
+            continue;
+        }
+        if ((fa < 0.0) == (fb < 0.0)) {
+            continue;
+        }
+        for (int iter = 0; iter < 200 && b - a > 0.0; iter++) {
+            double mid = 0.5 * (a + b);
+            if (mid <= a || mid >= b) break;
+            if ((polynomialValue(c, mid) < 0.0) == (fa < 0.0)) {
+                a = mid;
+            } else {
+                b = mid;
+            }
+        }
+        roots.push_back(b);
+    }
+}
+
+// Exercise region: where payoff - continuation > 0 in the ITM domain
+int LSMPricer::exerciseRegion(const std::vector<double>& coeffs, const BermudanOption& option,
+                              double lo, double hi, std::vector<double>& intervals) {
+    intervals.clear();
+    if (coeffs.empty() || !(lo < hi)) {
+        return 0;
+    }
+    // In the ITM domain the payoff is linear: +/-(F - K)
+    double K = option.getStrike();
+    double sign = (option.getOptionType() == CALL) ? 1.0 : -1.0;
+    std::vector<double> h(std::max<size_t>(coeffs.size(), 2), 0.0);
+    for (size_t j = 0; j < coeffs.size(); j++) {
+        h[j] = -coeffs[j];
+    }
+    h[0] -= sign * K;
+    h[1] += sign;
+    
+    std::vector<double> breaks(1, lo);
+    polynomialRoots(h, lo, hi, breaks);
+    breaks.push_back(hi);
+    for (size_t k = 0; k + 1 < breaks.size(); k++) {
+        double a = breaks[k];
+        double b = breaks[k + 1];
+        if (!(a < b) || polynomialValue(h, 0.5 * (a + b)) <= 0.0) {
+            continue;
+        }
+        if (!intervals.empty() && intervals.back() == a) {
+            intervals.back() = b;  // Merge touching intervals
+        } else {
+            intervals.push_back(a);
+            intervals.push_back(b);
+        }
+    }
+    return static_cast<int>(intervals.size() / 2);
+}
+
+// Exported boundary value for an exercise region (NaN if empty)
+static double boundaryFromRegion(const std::vector<double>& intervals, OptionType type) {
+    if (intervals.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return (type == CALL) ? intervals.front() : intervals.back();
+}
+
+// Boundary-based exercise decision at exercise date m
+void LSMPricer::boundaryExerciseDate(const double* const* F_paths, const double* const* weight_paths,
+                                     int nPaths, int step, double discountToNext,
+                                     BermudanOption& option, double* V, int m) {
+    double K = option.getStrike();
+    bool isCall = (option.getOptionType() == CALL);
+    double sign = isCall ? 1.0 : -1.0;
+    std::vector<double> column(nPaths);
+    std::vector<int> itm(nPaths);
+    
+    // Branch-free ITM compaction, in path order (same regression input
+    // as the per-path decision)
+    int nItm = 0;
+    {
+        LSM_PHASE(scanTimer, diagnostics.itmScan);
+        for (int i = 0; i < nPaths; i++) {
+            column[i] = F_paths[i][step];
+        }
+        for (int i = 0; i < nPaths; i++) {
+            itm[nItm] = i;
+            nItm += (sign * (column[i] - K) > 0.0);
+        }
+    }
+#ifdef LSM_INSTRUMENT
+    diagnostics.nItm[m] = nItm;
+    diagnostics.itmFraction[m] = static_cast<double>(nItm) / nPaths;
+#endif
+    
+    for (int i = 0; i < nPaths; i++) {
+        V[i] *= discountToNext;
+    }
+    if (nItm == 0) {
+        return;
+    }
+    
+    // Regression on ITM paths (C = discounted V, already in V)
+    std::vector<double> F_itm(nItm), C_itm(nItm), W_itm;
+    double farthest = K;
+    for (int k = 0; k < nItm; k++) {
+        F_itm[k] = column[itm[k]];
+        C_itm[k] = V[itm[k]];
+        farthest = isCall ? std::max(farthest, F_itm[k]) : std::min(farthest, F_itm[k]);
+    }
+    if (weight_paths) {
+        W_itm.resize(nItm);
+        for (int k = 0; k < nItm; k++) {
+            W_itm[k] = weight_paths[itm[k]][step];
+        }
+    }
+    std::vector<double> coeffs;
+    {
+        LSM_PHASE(regressionTimer, diagnostics.regression);
+        coeffs = regressionFit(F_itm, C_itm, W_itm);
+    }
+    exercisePolicy[m] = coeffs;
+#ifdef LSM_INSTRUMENT
+    diagnostics.conditionNumber[m] = lastConditionNumber;
+    diagnostics.regressionPoints[m] = lastRegressionPoints;
+#endif
+    
+    // Exercise region from the roots of payoff - continuation
+    LSM_PHASE(decisionTimer, diagnostics.exerciseDecision);
+    std::vector<double> intervals;
+    exerciseRegion(coeffs, option, isCall ? K : farthest, isCall ? farthest : K, intervals);
+    exerciseBoundary[m] = boundaryFromRegion(intervals, option.getOptionType());
+    if (intervals.empty()) {
+        return;
+    }
+    
+    // Partition ITM paths by the region: exercised paths become one
+    // contiguous index range, updated with the payoff
+    int* exercisedEnd = &itm[0];
+    if (intervals.size() == 2) {
+        double a = intervals[0];
+        double b = intervals[1];
+        exercisedEnd = std::partition(&itm[0], &itm[0] + nItm, [&](int i) {
+            return column[i] >= a && column[i] <= b;
+        });
+    } else {
+        exercisedEnd = std::partition(&itm[0], &itm[0] + nItm, [&](int i) {
+            for (size_t r = 0; r < intervals.size(); r += 2) {
+                if (column[i] >= intervals[r] && column[i] <= intervals[r + 1]) return true;
+            }
+            return false;
+        });
+    }
+    for (int* it = &itm[0]; it != exercisedEnd; ++it) {
+        V[*it] = sign * (column[*it] - K);
+    }
+}
+
+// Attach simulation cost to the diagnostics of the last pricing
+void LSMPricer::recordSimulation(const PhaseStats& stats, int nPaths) {
+    diagnostics.simulation = stats;
+    diagnostics.pathsPerSecond = (stats.wallSeconds > 0.0) ? nPaths / stats.wallSeconds : 0.0;
+}
+
+// Steps used by price(): 25 per exercise period
+int LSMPricer::simulationSteps(const BermudanOption& option) {
+    int stepsPerPeriod = 25;  // Default
+    return (option.getNExerciseDates() - 1) * stepsPerPeriod;
+}
+
 // Main pricing function using Longstaff-Schwartz algorithm
 // SPEC COMPLIANT: Takes SABRSimulator& and BermudanOption& as parameters
 double LSMPricer::price(SABRSimulator& sim, BermudanOption& option, int nPaths) {
     int nExerciseDates = option.getNExerciseDates();
     double T = option.getExerciseDate(nExerciseDates - 1);
     
-    // Determine time steps
-    int stepsPerPeriod = 25;  // Default
-    int totalSteps = (nExerciseDates - 1) * stepsPerPeriod;
-    double dt = T / static_cast<double>(totalSteps);
+    // Determine time steps: uniform, or a grid through the exercise dates
+    bool scheduleGrid = (maxTimeStep > 0.0);
+    TimeGrid grid;
+    if (scheduleGrid) {
+        grid = TimeGrid::fromSchedule(option, maxTimeStep);
+    }
+    int totalSteps = scheduleGrid ? grid.getNSteps() : simulationSteps(option);
     
     // Allocate path storage
     double** F_paths = new double*[nPaths];
@@ -72,17 +417,140 @@ double LSMPricer::price(SABRSimulator& sim, BermudanOption& option, int nPaths)
     }
     
     // Simulate all paths
-    std::cout << "Simulating " << nPaths << " paths..." << std::endl;
-    sim.simulatePaths(nPaths, totalSteps, T, F_paths, alpha_paths);
+    if (verbose) {
+        std::cout << "Simulating " << nPaths << " paths..." << std::endl;
+    }
+    // Likelihood ratios under importance sampling
+    double** weight_paths = 0;
+    if (sim.isImportanceSampling()) {
+        weight_paths = new double*[nPaths];
+        for (int i = 0; i < nPaths; i++) {
+            weight_paths[i] = new double[totalSteps + 1];
+        }
+    }
     
-    // Map exercise dates to time step indices
-    int* exerciseSteps = new int[nExerciseDates];
+    PhaseStats simulationStats;
+    bool cancelled = false;
+    {
+        LSM_PHASE(simulationTimer, simulationStats);
+        if (!control) {
+            if (scheduleGrid) {
+                sim.simulatePaths(nPaths, grid, F_paths, alpha_paths, 0, weight_paths);
+            } else {
+                sim.simulatePaths(nPaths, totalSteps, T, F_paths, alpha_paths, 0, weight_paths);
+            }
+        } else {
+            // Chunked (same paths: per-path streams), checking for cancellation
+            for (int first = 0; first < nPaths && !cancelled; first += SIMULATION_CHUNK) {
+                int count = std::min(SIMULATION_CHUNK, nPaths - first);
+                if (scheduleGrid) {
+                    sim.simulatePaths(count, grid, F_paths + first, alpha_paths + first, first,
+                                      weight_paths ? weight_paths + first : 0);
+                } else {
+                    sim.simulatePaths(count, totalSteps, T, F_paths + first, alpha_paths + first, first,
+                                      weight_paths ? weight_paths + first : 0);
+                }
+                control->pathsSimulated += count;
+                cancelled = control->isCancelled();
+            }
+        }
+    }
+    
+    double optionPrice = -1.0;
+    if (!cancelled) {
+        if (scheduleGrid) {
+            optionPrice = priceFromPaths(F_paths, alpha_paths, nPaths, grid, option, weight_paths);
+        } else {
+            optionPrice = priceFromPaths(F_paths, alpha_paths, nPaths, totalSteps, T, option,
+                                         weight_paths);
+        }
+        recordSimulation(simulationStats, nPaths);
+    }
+    
+    // Clean up
+    for (int i = 0; i < nPaths; i++) {
+        delete[] F_paths[i];
+        delete[] alpha_paths[i];
+    }
+    delete[] F_paths;
+    delete[] alpha_paths;
+    if (weight_paths) {
+        for (int i = 0; i < nPaths; i++) {
+            delete[] weight_paths[i];
+        }
+        delete[] weight_paths;
+    }
+    
+    return optionPrice;
+}
+
+// Backward induction on pre-simulated paths, uniform grid
+double LSMPricer::priceFromPaths(const double* const* F_paths, const double* const* alpha_paths,
+                                 int nPaths, int totalSteps, double T, BermudanOption& option,
+                                 const double* const* weight_paths) {
+    int nExerciseDates = option.getNExerciseDates();
+    double dt = T / static_cast<double>(totalSteps);
+    
+    // Map exercise dates to time step indices (nearest step)
+    std::vector<int> exerciseSteps(nExerciseDates);
     for (int m = 0; m < nExerciseDates; m++) {
         exerciseSteps[m] = static_cast<int>(option.getExerciseDate(m) / dt + 0.5);
     }
+    std::vector<double> discounts(nExerciseDates, 1.0);
+    for (int m = 0; m + 1 < nExerciseDates; m++) {
+        discounts[m] = discountFactor((exerciseSteps[m + 1] - exerciseSteps[m]) * dt);
+    }
+    return backwardInduction(F_paths, alpha_paths, nPaths, &exerciseSteps[0], &discounts[0],
+                             option, weight_paths);
+}
+
+// Backward induction on pre-simulated paths, arbitrary grid
+double LSMPricer::priceFromPaths(const double* const* F_paths, const double* const* alpha_paths,
+                                 int nPaths, const TimeGrid& grid, BermudanOption& option,
+                                 const double* const* weight_paths) {
+    int nExerciseDates = option.getNExerciseDates();
+    
+    // Exercise dates must be grid points
+    std::vector<int> exerciseSteps(nExerciseDates);
+    int j = 0;
+    for (int m = 0; m < nExerciseDates; m++) {
+        double date = option.getExerciseDate(m);
+        double tolerance = 1e-12 * std::max(1.0, date);
+        while (j < grid.getNSteps() && grid.getTime(j) < date - tolerance) {
+            j++;
+        }
+        if (fabs(grid.getTime(j) - date) > tolerance) {
+            return -1.0;
+        }
+        exerciseSteps[m] = j;
+    }
+    std::vector<double> discounts(nExerciseDates, 1.0);
+    for (int m = 0; m + 1 < nExerciseDates; m++) {
+        discounts[m] = discountFactor(option.getExerciseDate(m + 1) - option.getExerciseDate(m));
+    }
+    return backwardInduction(F_paths, alpha_paths, nPaths, &exerciseSteps[0], &discounts[0],
+                             option, weight_paths);
+}
+
+// Longstaff-Schwartz backward induction
+double LSMPricer::backwardInduction(const double* const* F_paths, const double* const* alpha_paths,
+                                    int nPaths, const int* exerciseSteps, const double* discounts,
+                                    BermudanOption& option, const double* const* weight_paths,
+                                    double* pathValues) {
+    int nExerciseDates = option.getNExerciseDates();
     
     // Value array: V[i] = value of option for path i
     double* V = new double[nPaths];
+    exercisePolicy.assign(nExerciseDates - 1, std::vector<double>());
+    exerciseBoundary.assign(nExerciseDates - 1, std::numeric_limits<double>::quiet_NaN());
+    diagnostics.clear();
+    diagnostics.nPaths = nPaths;
+#ifdef LSM_INSTRUMENT
+    diagnostics.nItm.assign(nExerciseDates - 1, 0);
+    diagnostics.itmFraction.assign(nExerciseDates - 1, 0.0);
+    diagnostics.conditionNumber.assign(nExerciseDates - 1, 0.0);
+    diagnostics.regressionPoints.assign(nExerciseDates - 1, 0);
+#endif
     
     // Initialize at maturity (last exercise date)
     int lastStep = exerciseSteps[nExerciseDates - 1];
@@ -90,27 +558,61 @@ double LSMPricer::price(SABRSimulator& sim, BermudanOption& option, int nPaths)
         V[i] = option.payoff(F_paths[i][lastStep]);
     }
     
-    std::cout << "Running backward induction..." << std::endl;
-    
+    if (verbose) {
+        std::cout << "Running backward induction..." << std::endl;
+    }
     // Backward induction through exercise dates
+    bool cancelled = false;
     for (int m = nExerciseDates - 2; m >= 0; m--) {
+        if (control) {
+            control->datesProcessed = nExerciseDates - 2 - m;   // Dates completed
+            if (control->isCancelled()) {
+                cancelled = true;
+                break;
+            }
+        }
         int currentStep = exerciseSteps[m];
         int nextStep = exerciseSteps[m + 1];
-        double discountToNext = discountFactor((nextStep - currentStep) * dt);
+        double discountToNext = discounts[m];
+        
+        // Importance sampling: express path values in pricing-measure terms
+        // at this date (likelihood ratio from this date to the next)
+        if (weight_paths) {
+            for (int i = 0; i < nPaths; i++) {
+                V[i] *= weight_paths[i][nextStep] / weight_paths[i][currentStep];
+            }
+        }
+        
+        if (boundaryDecision) {
+            boundaryExerciseDate(F_paths, weight_paths, nPaths, currentStep, discountToNext,
+                                 option, V, m);
+            continue;
+        }
         
         // Identify in-the-money paths
         std::vector<double> F_itm;
         std::vector<double> C_itm;
+        std::vector<double> W_itm;
         std::vector<int> itm_indices;
         
-        for (int i = 0; i < nPaths; i++) {
-            double payoffNow = option.payoff(F_paths[i][currentStep]);
-            if (payoffNow > 0.0) {
-                F_itm.push_back(F_paths[i][currentStep]);
-                C_itm.push_back(V[i] * discountToNext);
-                itm_indices.push_back(i);
+        {
+            LSM_PHASE(scanTimer, diagnostics.itmScan);
+            for (int i = 0; i < nPaths; i++) {
+                double payoffNow = option.payoff(F_paths[i][currentStep]);
+                if (payoffNow > 0.0) {
+                    F_itm.push_back(F_paths[i][currentStep]);
+                    C_itm.push_back(V[i] * discountToNext);
+                    itm_indices.push_back(i);
+                    if (weight_paths) {
+                        W_itm.push_back(weight_paths[i][currentStep]);
+                    }
+                }
             }
         }
+#ifdef LSM_INSTRUMENT
+        diagnostics.nItm[m] = static_cast<int>(F_itm.size());
+        diagnostics.itmFraction[m] = static_cast<double>(F_itm.size()) / nPaths;
+#endif
         
         if (F_itm.empty()) {
             // No paths in the money, just discount
@@ -121,9 +623,30 @@ double LSMPricer::price(SABRSimulator& sim, BermudanOption& option, int nPaths)
         }
         
         // Fit regression to continuation values using public method
-        std::vector<double> coeffs = regressionFit(F_itm, C_itm);
+        std::vector<double> coeffs;
+        {
+            LSM_PHASE(regressionTimer, diagnostics.regression);
+            coeffs = regressionFit(F_itm, C_itm, W_itm);
+        }
+        exercisePolicy[m] = coeffs;
+#ifdef LSM_INSTRUMENT
+        diagnostics.conditionNumber[m] = lastConditionNumber;
+        diagnostics.regressionPoints[m] = lastRegressionPoints;
+#endif
+        
+        // Exercise boundary between the strike and the farthest ITM state
+        std::vector<double> intervals;
+        if (option.getOptionType() == CALL) {
+            exerciseRegion(coeffs, option, option.getStrike(),
+                           *std::max_element(F_itm.begin(), F_itm.end()), intervals);
+        } else {
+            exerciseRegion(coeffs, option, *std::min_element(F_itm.begin(), F_itm.end()),
+                           option.getStrike(), intervals);
+        }
+        exerciseBoundary[m] = boundaryFromRegion(intervals, option.getOptionType());
         
         // Exercise decision for each path
+        LSM_PHASE(decisionTimer, diagnostics.exerciseDecision);
         for (int i = 0; i < nPaths; i++) {
             double immediatePayoff = option.payoff(F_paths[i][currentStep]);
             
@@ -146,31 +669,672 @@ double LSMPricer::price(SABRSimulator& sim, BermudanOption& option, int nPaths)
         }
     }
     
+    if (cancelled) {
+        delete[] V;
+        return -1.0;
+    }
+    if (control) {
+        control->datesProcessed = nExerciseDates - 1;
+    }
+    
     // Discount from first exercise date to t=0
     double discountToZero = discountFactor(option.getExerciseDate(0));
     
     // Compute price and standard error
+    double optionPrice;
+    {
+        LSM_PHASE(reductionTimer, diagnostics.reduction);
+        double sum = 0.0;
+        double sumSquared = 0.0;
+        for (int i = 0; i < nPaths; i++) {
+            double discounted = V[i] * discountToZero;
+            if (weight_paths) {
+                discounted *= weight_paths[i][exerciseSteps[0]];
+            }
+            if (pathValues) {
+                pathValues[i] = discounted;
+            }
+            sum += discounted;
+            sumSquared += discounted * discounted;
+        }
+        
+        optionPrice = sum / static_cast<double>(nPaths);
+        double variance = (sumSquared / nPaths) - (optionPrice * optionPrice);
+        standardError = sqrt(variance / nPaths);
+    }
+    
+    // Clean up
+    delete[] V;
+    
+    return optionPrice;
+}
+
+// Price from a mapped path file
+double LSMPricer::priceFromFile(const MappedPaths& paths, BermudanOption& option, int nPaths) {
+    if (!paths.isOpen() || option.getNExerciseDates() == 0
+        || option.getExerciseDate(option.getNExerciseDates() - 1) > paths.getT() + 1e-12) {
+        return -1.0;
+    }
+    if (nPaths <= 0 || nPaths > paths.getNPaths()) {
+        nPaths = paths.getNPaths();
+    }
+    return priceFromPaths(paths.getFPaths(), paths.getAlphaPaths(), nPaths,
+                          paths.getNSteps(), paths.getT(), option);
+}
+
+// Read exactly bytes at offset (spill files)
+static bool preadAll(int fd, void* buf, size_t bytes, off_t offset) {
+    char* p = static_cast<char*>(buf);
+    while (bytes > 0) {
+        ssize_t n = pread(fd, p, bytes, offset);
+        if (n <= 0) return false;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+// Write exactly bytes at offset (spill files)
+static bool pwriteAll(int fd, const void* buf, size_t bytes, off_t offset) {
+    const char* p = static_cast<const char*>(buf);
+    while (bytes > 0) {
+        ssize_t n = pwrite(fd, p, bytes, offset);
+        if (n <= 0) return false;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+// Anonymous spill file: created in dir and unlinked immediately
+static int openSpillFile(const std::string& dir) {
+    std::string pattern = dir + "/lsm_spill_XXXXXX";
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    int fd = mkstemp(&name[0]);
+    if (fd >= 0) {
+        unlink(&name[0]);
+    }
+    return fd;
+}
+
+// Read chunk c of an exercise-date file (fdF < 0: none) and of the V file
+static bool readChunk(int fdF, int fdV, double* F, double* V, int chunk, int nPaths, int c) {
+    int start = c * chunk;
+    int n = std::min(chunk, nPaths - start);
+    off_t offset = static_cast<off_t>(start) * sizeof(double);
+    if (fdF >= 0 && !preadAll(fdF, F, n * sizeof(double), offset)) return false;
+    return preadAll(fdV, V, n * sizeof(double), offset);
+}
+
+// Out-of-core Longstaff-Schwartz
+double LSMPricer::priceOutOfCore(SABRSimulator& sim, BermudanOption& option, int nPaths,
+                                 size_t memoryBudget, const std::string& spillDirectory) {
+    if (sim.isImportanceSampling()) {
+        return -1.0;  // Spill files carry no likelihood ratios
+    }
+    int nExerciseDates = option.getNExerciseDates();
+    double T = option.getExerciseDate(nExerciseDates - 1);
+    int totalSteps = simulationSteps(option);
+    double dt = T / static_cast<double>(totalSteps);
+    size_t row = static_cast<size_t>(totalSteps) + 1;
+    
+    // Chunk size from the budget: simulation holds full rows for a chunk,
+    // backward induction double-buffers (F, V) plus ITM scratch
+    size_t simBytesPerPath = 2 * row * sizeof(double) + sizeof(double);
+    size_t backBytesPerPath = 6 * sizeof(double);
+    size_t perPath = std::max(simBytesPerPath, backBytesPerPath);
+    int chunk = static_cast<int>(std::min(static_cast<size_t>(nPaths),
+                                          std::max(static_cast<size_t>(1), memoryBudget / perPath)));
+    int nChunks = (nPaths + chunk - 1) / chunk;
+    
+    int* exerciseSteps = new int[nExerciseDates];
+    for (int m = 0; m < nExerciseDates; m++) {
+        exerciseSteps[m] = static_cast<int>(option.getExerciseDate(m) / dt + 0.5);
+    }
+    
+    // One spill file per exercise date (except maturity) plus V
+    std::vector<int> fdF(nExerciseDates - 1, -1);
+    int fdV = openSpillFile(spillDirectory);
+    bool ok = (fdV >= 0);
+    for (int m = 0; m < nExerciseDates - 1 && ok; m++) {
+        fdF[m] = openSpillFile(spillDirectory);
+        ok = (fdF[m] >= 0);
+    }
+    
+    diagnostics.clear();
+    diagnostics.nPaths = nPaths;
+#ifdef LSM_INSTRUMENT
+    diagnostics.nItm.assign(nExerciseDates - 1, 0);
+    diagnostics.itmFraction.assign(nExerciseDates - 1, 0.0);
+    diagnostics.conditionNumber.assign(nExerciseDates - 1, 0.0);
+    diagnostics.regressionPoints.assign(nExerciseDates - 1, 0);
+#endif
+    
+    // Phase 1: simulate chunk by chunk, keep only exercise-date states
+    PhaseStats simulationStats;
+    if (ok) {
+        LSM_PHASE(simulationTimer, simulationStats);
+        if (verbose) {
+            std::cout << "Simulating " << nPaths << " paths out of core ("
+                      << nChunks << " chunks of " << chunk << ")..." << std::endl;
+        }
+        double* block = new double[2 * row * chunk];
+        double** F_rows = new double*[chunk];
+        double** alpha_rows = new double*[chunk];
+        for (int i = 0; i < chunk; i++) {
+            F_rows[i] = block + 2 * row * i;
+            alpha_rows[i] = block + 2 * row * i + row;
+        }
+        double* column = new double[chunk];
+        
+        for (int c = 0; c < nChunks && ok; c++) {
+            int start = c * chunk;
+            int n = std::min(chunk, nPaths - start);
+            off_t offset = static_cast<off_t>(start) * sizeof(double);
+            sim.simulatePaths(n, totalSteps, T, F_rows, alpha_rows, start);
+            for (int m = 0; m < nExerciseDates - 1 && ok; m++) {
+                for (int i = 0; i < n; i++) column[i] = F_rows[i][exerciseSteps[m]];
+                ok = pwriteAll(fdF[m], column, n * sizeof(double), offset);
+            }
+            int lastStep = exerciseSteps[nExerciseDates - 1];
+            for (int i = 0; i < n; i++) column[i] = option.payoff(F_rows[i][lastStep]);
+            ok = ok && pwriteAll(fdV, column, n * sizeof(double), offset);
+        }
+        delete[] block;
+        delete[] F_rows;
+        delete[] alpha_rows;
+        delete[] column;
+    }
+    recordSimulation(simulationStats, nPaths);
+    
+    // Phase 2: backward induction, streaming each date's file in chunks
+    double* F_buf[2] = {new double[chunk], new double[chunk]};
+    double* V_buf[2] = {new double[chunk], new double[chunk]};
+    double* F_itm = new double[chunk];
+    double* C_itm = new double[chunk];
+    PolynomialRegression reg(polynomialDegree);
+    exercisePolicy.assign(nExerciseDates - 1, std::vector<double>());
+    exerciseBoundary.assign(nExerciseDates - 1, std::numeric_limits<double>::quiet_NaN());
+    bool isCall = (option.getOptionType() == CALL);
+    
+    if (ok && verbose) {
+        std::cout << "Running backward induction..." << std::endl;
+    }
+    for (int m = nExerciseDates - 2; m >= 0 && ok; m--) {
+        int currentStep = exerciseSteps[m];
+        int nextStep = exerciseSteps[m + 1];
+        double discountToNext = discountFactor((nextStep - currentStep) * dt);
+        
+        // Pass 1: normal equations over ITM paths, and the farthest ITM
+        // state (bounds the exercise region search, as in price())
+        reg.reset();
+        double farthest = option.getStrike();
+        std::future<bool> next = std::async(std::launch::async, readChunk, fdF[m], fdV,
+                                            F_buf[0], V_buf[0], chunk, nPaths, 0);
+        for (int c = 0; c < nChunks && ok; c++) {
+            int cur = c % 2;
+            ok = next.get();
+            if (c + 1 < nChunks) {
+                next = std::async(std::launch::async, readChunk, fdF[m], fdV,
+                                  F_buf[1 - cur], V_buf[1 - cur], chunk, nPaths, c + 1);
+            }
+            int n = std::min(chunk, nPaths - c * chunk);
+            int nItm = 0;
+            for (int i = 0; i < n; i++) {
+                if (option.payoff(F_buf[cur][i]) > 0.0) {
+                    F_itm[nItm] = F_buf[cur][i];
+                    C_itm[nItm] = V_buf[cur][i] * discountToNext;
+                    farthest = isCall ? std::max(farthest, F_itm[nItm]) : std::min(farthest, F_itm[nItm]);
+                    nItm++;
+                }
+            }
+            reg.addPoints(F_itm, C_itm, nItm);
+        }
+        if (next.valid()) next.wait();
+        if (!ok) break;
+        
+        bool anyItm = (reg.getNAccumulated() > 0);
+        std::vector<double> coeffs;
+#ifdef LSM_INSTRUMENT
+        diagnostics.nItm[m] = static_cast<int>(reg.getNAccumulated());
+        diagnostics.itmFraction[m] = static_cast<double>(reg.getNAccumulated()) / nPaths;
+#endif
+        if (anyItm) {
+            {
+                LSM_PHASE(regressionTimer, diagnostics.regression);
+                reg.solve();
+            }
+#ifdef LSM_INSTRUMENT
+            diagnostics.conditionNumber[m] = reg.conditionNumber();
+            diagnostics.regressionPoints[m] = static_cast<int>(reg.getNAccumulated());
+#endif
+            coeffs.resize(polynomialDegree + 1);
+            for (int j = 0; j <= polynomialDegree; j++) coeffs[j] = reg.getCoefficient(j);
+            exercisePolicy[m] = coeffs;
+            
+            std::vector<double> intervals;
+            exerciseRegion(coeffs, option, isCall ? option.getStrike() : farthest,
+                           isCall ? farthest : option.getStrike(), intervals);
+            exerciseBoundary[m] = boundaryFromRegion(intervals, option.getOptionType());
+        }
+        
+        // Pass 2: exercise decision, V rewritten in place
+        next = std::async(std::launch::async, readChunk, fdF[m], fdV,
+                          F_buf[0], V_buf[0], chunk, nPaths, 0);
+        for (int c = 0; c < nChunks && ok; c++) {
+            int cur = c % 2;
+            ok = next.get();
+            if (c + 1 < nChunks) {
+                next = std::async(std::launch::async, readChunk, fdF[m], fdV,
+                                  F_buf[1 - cur], V_buf[1 - cur], chunk, nPaths, c + 1);
+            }
+            int n = std::min(chunk, nPaths - c * chunk);
+            double* F = F_buf[cur];
+            double* V = V_buf[cur];
+            for (int i = 0; i < n; i++) {
+                double immediatePayoff = option.payoff(F[i]);
+                if (anyItm && immediatePayoff > 0.0) {
+                    double continuationValue = 0.0;
+                    double basis = 1.0;
+                    for (size_t j = 0; j < coeffs.size(); j++) {
+                        continuationValue += coeffs[j] * basis;
+                        basis *= F[i];
+                    }
+                    V[i] = (immediatePayoff > continuationValue) ? immediatePayoff : V[i] * discountToNext;
+                } else {
+                    V[i] *= discountToNext;
+                }
+            }
+            ok = ok && pwriteAll(fdV, V, n * sizeof(double), static_cast<off_t>(c) * chunk * sizeof(double));
+        }
+        if (next.valid()) next.wait();
+    }
+    
+    // Phase 3: discount to t=0 and reduce
+    double discountToZero = discountFactor(option.getExerciseDate(0));
     double sum = 0.0;
     double sumSquared = 0.0;
-    for (int i = 0; i < nPaths; i++) {
-        double discounted = V[i] * discountToZero;
-        sum += discounted;
-        sumSquared += discounted * discounted;
+    for (int c = 0; c < nChunks && ok; c++) {
+        int n = std::min(chunk, nPaths - c * chunk);
+        ok = readChunk(-1, fdV, 0, V_buf[0], chunk, nPaths, c);
+        for (int i = 0; i < n && ok; i++) {
+            double discounted = V_buf[0][i] * discountToZero;
+            sum += discounted;
+            sumSquared += discounted * discounted;
+        }
     }
     
-    double optionPrice = sum / static_cast<double>(nPaths);
-    double variance = (sumSquared / nPaths) - (optionPrice * optionPrice);
-    standardError = sqrt(variance / nPaths);
+    double optionPrice = -1.0;
+    if (ok) {
+        optionPrice = sum / static_cast<double>(nPaths);
+        double variance = (sumSquared / nPaths) - (optionPrice * optionPrice);
+        standardError = sqrt(variance / nPaths);
+    }
     
     // Clean up
-    for (int i = 0; i < nPaths; i++) {
-        delete[] F_paths[i];
-        delete[] alpha_paths[i];
+    for (int k = 0; k < 2; k++) {
+        delete[] F_buf[k];
+        delete[] V_buf[k];
     }
-    delete[] F_paths;
-    delete[] alpha_paths;
+    delete[] F_itm;
+    delete[] C_itm;
+    delete[] exerciseSteps;
+    for (size_t m = 0; m < fdF.size(); m++) {
+        if (fdF[m] >= 0) close(fdF[m]);
+    }
+    if (fdV >= 0) close(fdV);
+    
+    return optionPrice;
+}
+
+// Recompute-instead-of-store Longstaff-Schwartz
+double LSMPricer::priceRecompute(SABRSimulator& sim, BermudanOption& option, int nPaths,
+                                 int checkpointInterval) {
+    if (sim.isImportanceSampling()) {
+        return -1.0;  // Regenerated paths carry no likelihood ratios
+    }
+    int nExerciseDates = option.getNExerciseDates();
+    double T = option.getExerciseDate(nExerciseDates - 1);
+    int totalSteps = simulationSteps(option);
+    double dt = T / static_cast<double>(totalSteps);
+    
+    int* exerciseSteps = new int[nExerciseDates];
+    for (int m = 0; m < nExerciseDates; m++) {
+        exerciseSteps[m] = static_cast<int>(option.getExerciseDate(m) / dt + 0.5);
+    }
+    
+    // Checkpoint c holds the state at exercise date (c+1)*k - 1
+    int k = (checkpointInterval > 0) ? checkpointInterval : nExerciseDates;
+    int nCheckpoints = (nExerciseDates - 1) / k;
+    double* F = new double[nPaths];
+    double* alpha = new double[nPaths];
+    unsigned long long* rngStates = new unsigned long long[nPaths];
+    double* V = new double[nPaths];
+    std::vector<double*> F_checkpoint(nCheckpoints), alpha_checkpoint(nCheckpoints);
+    std::vector<unsigned long long*> rng_checkpoint(nCheckpoints);
+    for (int c = 0; c < nCheckpoints; c++) {
+        F_checkpoint[c] = new double[nPaths];
+        alpha_checkpoint[c] = new double[nPaths];
+        rng_checkpoint[c] = new unsigned long long[nPaths];
+    }
+    
+    exercisePolicy.assign(nExerciseDates - 1, std::vector<double>());
+    exerciseBoundary.assign(nExerciseDates - 1, std::numeric_limits<double>::quiet_NaN());
+    diagnostics.clear();
+    diagnostics.nPaths = nPaths;
+#ifdef LSM_INSTRUMENT
+    diagnostics.nItm.assign(nExerciseDates - 1, 0);
+    diagnostics.itmFraction.assign(nExerciseDates - 1, 0.0);
+    diagnostics.conditionNumber.assign(nExerciseDates - 1, 0.0);
+    diagnostics.regressionPoints.assign(nExerciseDates - 1, 0);
+#endif
+    
+    // Forward pass: walk every path to maturity, saving checkpoints
+    PhaseStats simulationStats;
+    {
+        LSM_PHASE(simulationTimer, simulationStats);
+        if (verbose) {
+            std::cout << "Simulating " << nPaths << " paths (" << nCheckpoints
+                      << " checkpoints)..." << std::endl;
+        }
+        sim.startPaths(nPaths, F, alpha, rngStates);
+        int step = 0;
+        for (int m = 0; m < nExerciseDates; m++) {
+            sim.advancePaths(nPaths, step, exerciseSteps[m], totalSteps, T, F, alpha, rngStates);
+            step = exerciseSteps[m];
+            if ((m + 1) % k == 0 && m < nExerciseDates - 1) {
+                int c = (m + 1) / k - 1;
+                std::copy(F, F + nPaths, F_checkpoint[c]);
+                std::copy(alpha, alpha + nPaths, alpha_checkpoint[c]);
+                std::copy(rngStates, rngStates + nPaths, rng_checkpoint[c]);
+            }
+        }
+        for (int i = 0; i < nPaths; i++) {
+            V[i] = option.payoff(F[i]);
+        }
+    }
+    
+    if (verbose) {
+        std::cout << "Running backward induction (recomputing paths)..." << std::endl;
+    }
+    std::vector<double> F_itm, C_itm;
+    for (int m = nExerciseDates - 2; m >= 0; m--) {
+        int currentStep = exerciseSteps[m];
+        int nextStep = exerciseSteps[m + 1];
+        double discountToNext = discountFactor((nextStep - currentStep) * dt);
+        
+        // Regenerate F at this date from the nearest checkpoint before it
+        {
+            LSM_PHASE(simulationTimer, simulationStats);
+            int c = (m + 1) / k - 1;
+            int fromStep = 0;
+            if (c < 0) {
+                sim.startPaths(nPaths, F, alpha, rngStates);
+            } else {
+                std::copy(F_checkpoint[c], F_checkpoint[c] + nPaths, F);
+                std::copy(alpha_checkpoint[c], alpha_checkpoint[c] + nPaths, alpha);
+                std::copy(rng_checkpoint[c], rng_checkpoint[c] + nPaths, rngStates);
+                fromStep = exerciseSteps[(c + 1) * k - 1];
+            }
+            sim.advancePaths(nPaths, fromStep, currentStep, totalSteps, T, F, alpha, rngStates);
+        }
+        
+        // ITM paths, in path order (same regression input as price())
+        F_itm.clear();
+        C_itm.clear();
+        {
+            LSM_PHASE(scanTimer, diagnostics.itmScan);
+            for (int i = 0; i < nPaths; i++) {
+                if (option.payoff(F[i]) > 0.0) {
+                    F_itm.push_back(F[i]);
+                    C_itm.push_back(V[i] * discountToNext);
+                }
+            }
+        }
+#ifdef LSM_INSTRUMENT
+        diagnostics.nItm[m] = static_cast<int>(F_itm.size());
+        diagnostics.itmFraction[m] = static_cast<double>(F_itm.size()) / nPaths;
+#endif
+        
+        std::vector<double> coeffs;
+        if (!F_itm.empty()) {
+            {
+                LSM_PHASE(regressionTimer, diagnostics.regression);
+                coeffs = regressionFit(F_itm, C_itm);
+            }
+            exercisePolicy[m] = coeffs;
+#ifdef LSM_INSTRUMENT
+            diagnostics.conditionNumber[m] = lastConditionNumber;
+            diagnostics.regressionPoints[m] = lastRegressionPoints;
+#endif
+            std::vector<double> intervals;
+            if (option.getOptionType() == CALL) {
+                exerciseRegion(coeffs, option, option.getStrike(),
+                               *std::max_element(F_itm.begin(), F_itm.end()), intervals);
+            } else {
+                exerciseRegion(coeffs, option, *std::min_element(F_itm.begin(), F_itm.end()),
+                               option.getStrike(), intervals);
+            }
+            exerciseBoundary[m] = boundaryFromRegion(intervals, option.getOptionType());
+        }
+        
+        // Exercise decision
+        LSM_PHASE(decisionTimer, diagnostics.exerciseDecision);
+        for (int i = 0; i < nPaths; i++) {
+            double immediatePayoff = option.payoff(F[i]);
+            if (!coeffs.empty() && immediatePayoff > 0.0) {
+                double continuationValue = 0.0;
+                double basis = 1.0;
+                for (size_t j = 0; j < coeffs.size(); j++) {
+                    continuationValue += coeffs[j] * basis;
+                    basis *= F[i];
+                }
+                V[i] = (immediatePayoff > continuationValue) ? immediatePayoff : V[i] * discountToNext;
+            } else {
+                V[i] *= discountToNext;
+            }
+        }
+    }
+    recordSimulation(simulationStats, nPaths);
+    
+    // Discount from first exercise date to t=0
+    double discountToZero = discountFactor(option.getExerciseDate(0));
+    double optionPrice;
+    {
+        LSM_PHASE(reductionTimer, diagnostics.reduction);
+        double sum = 0.0;
+        double sumSquared = 0.0;
+        for (int i = 0; i < nPaths; i++) {
+            double discounted = V[i] * discountToZero;
+            sum += discounted;
+            sumSquared += discounted * discounted;
+        }
+        optionPrice = sum / static_cast<double>(nPaths);
+        double variance = (sumSquared / nPaths) - (optionPrice * optionPrice);
+        standardError = sqrt(variance / nPaths);
+    }
+    
+    // Clean up
+    for (int c = 0; c < nCheckpoints; c++) {
+        delete[] F_checkpoint[c];
+        delete[] alpha_checkpoint[c];
+        delete[] rng_checkpoint[c];
+    }
+    delete[] F;
+    delete[] alpha;
+    delete[] rngStates;
     delete[] V;
     delete[] exerciseSteps;
     
     return optionPrice;
 }
+
+// Weights over the levels of Richardson table entry R_L-1,order, levels
+// doubling the exercise dates: R_l,0 = P_l and
+// R_l,k = R_l,k-1 + (R_l,k-1 - R_l-1,k-1) / (2^k - 1)
+static std::vector<double> richardsonWeights(int nLevels, int order) {
+    // Row l of the table as weights on P_0 .. P_L-1
+    std::vector<std::vector<double> > R(nLevels, std::vector<double>(nLevels, 0.0));
+    for (int l = 0; l < nLevels; l++) {
+        R[l][l] = 1.0;
+    }
+    for (int k = 1; k <= order; k++) {
+        double factor = 1.0 / ((1 << k) - 1);
+        // Descending: row l-1 is still at order k-1
+        for (int l = nLevels - 1; l >= k; l--) {
+            for (int j = 0; j < nLevels; j++) {
+                R[l][j] += (R[l][j] - R[l - 1][j]) * factor;
+            }
+        }
+    }
+    return R[nLevels - 1];
+}
+
+// American limit from nested Bermudan schedules on one simulation
+double LSMPricer::priceAmericanLimit(SABRSimulator& sim, BermudanOption& option, int nPaths,
+                                     int nLevels) {
+    if (nLevels < 2 || option.getNExerciseDates() == 0) {
+        return -1.0;
+    }
+    std::vector<double> finest = TimeGrid::refineSchedule(option.getExerciseDates(), nLevels - 1);
+    int nDates = static_cast<int>(finest.size());
+    double T = finest.back();
+    double maxDt = (maxTimeStep > 0.0) ? maxTimeStep
+                                       : T / std::max(1, simulationSteps(option));
+    TimeGrid grid = TimeGrid::fromSchedule(finest, maxDt);
+    int totalSteps = grid.getNSteps();
+    bool weighted = sim.isImportanceSampling();
+    
+    // Path store: F, alpha (and likelihood ratios) at the finest dates only
+    double** F_dates = new double*[nPaths];
+    double** alpha_dates = new double*[nPaths];
+    double** weight_dates = weighted ? new double*[nPaths] : 0;
+    for (int i = 0; i < nPaths; i++) {
+        F_dates[i] = new double[nDates];
+        alpha_dates[i] = new double[nDates];
+        if (weighted) {
+            weight_dates[i] = new double[nDates];
+        }
+    }
+    
+    // Simulate full-resolution chunks and sample them at the dates
+    int chunk = std::min(nPaths, SIMULATION_CHUNK);
+    double** F_chunk = new double*[chunk];
+    double** alpha_chunk = new double*[chunk];
+    double** weight_chunk = weighted ? new double*[chunk] : 0;
+    for (int i = 0; i < chunk; i++) {
+        F_chunk[i] = new double[totalSteps + 1];
+        alpha_chunk[i] = new double[totalSteps + 1];
+        if (weighted) {
+            weight_chunk[i] = new double[totalSteps + 1];
+        }
+    }
+    if (verbose) {
+        std::cout << "Simulating " << nPaths << " paths (" << nDates << " dates, "
+                  << nLevels << " levels)..." << std::endl;
+    }
+    PhaseStats simulationStats;
+    bool cancelled = false;
+    {
+        LSM_PHASE(simulationTimer, simulationStats);
+        for (int first = 0; first < nPaths && !cancelled; first += chunk) {
+            int count = std::min(chunk, nPaths - first);
+            sim.simulatePaths(count, grid, F_chunk, alpha_chunk, first, weight_chunk);
+            for (int i = 0; i < count; i++) {
+                for (int k = 0; k < nDates; k++) {
+                    int step = grid.getExerciseStep(k);
+                    F_dates[first + i][k] = F_chunk[i][step];
+                    alpha_dates[first + i][k] = alpha_chunk[i][step];
+                    if (weighted) {
+                        weight_dates[first + i][k] = weight_chunk[i][step];
+                    }
+                }
+            }
+            if (control) {
+                control->pathsSimulated += count;
+                cancelled = control->isCancelled();
+            }
+        }
+    }
+    for (int i = 0; i < chunk; i++) {
+        delete[] F_chunk[i];
+        delete[] alpha_chunk[i];
+        if (weighted) {
+            delete[] weight_chunk[i];
+        }
+    }
+    delete[] F_chunk;
+    delete[] alpha_chunk;
+    delete[] weight_chunk;
+    
+    // Level l: every 2^(L-1-l)-th finest date, ending on each original date
+    double* pathValues = new double[static_cast<size_t>(nLevels) * nPaths];
+    levelPrices.assign(nLevels, 0.0);
+    for (int l = 0; l < nLevels && !cancelled; l++) {
+        int stride = 1 << (nLevels - 1 - l);
+        std::vector<double> dates;
+        std::vector<int> dateIndices;
+        for (int k = stride - 1; k < nDates; k += stride) {
+            dates.push_back(finest[k]);
+            dateIndices.push_back(k);
+        }
+        BermudanOption levelOption(option.getStrike(), dates, option.getOptionType());
+        std::vector<double> discounts(dates.size(), 1.0);
+        for (size_t m = 0; m + 1 < dates.size(); m++) {
+            discounts[m] = discountFactor(dates[m + 1] - dates[m]);
+        }
+        if (verbose) {
+            std::cout << "Level " << l << ": " << dates.size() << " exercise dates" << std::endl;
+        }
+        levelPrices[l] = backwardInduction(F_dates, alpha_dates, nPaths, &dateIndices[0],
+                                           &discounts[0], levelOption, weight_dates,
+                                           pathValues + static_cast<size_t>(l) * nPaths);
+        cancelled = levelPrices[l] < 0.0;
+    }
+    
+    // Extrapolated price; standard error of the same combination per path
+    double optionPrice = -1.0;
+    if (!cancelled) {
+        std::vector<double> weights = richardsonWeights(nLevels, nLevels - 1);
+        std::vector<double> lower = richardsonWeights(nLevels, nLevels - 2);
+        optionPrice = 0.0;
+        double lowerPrice = 0.0;
+        for (int l = 0; l < nLevels; l++) {
+            optionPrice += weights[l] * levelPrices[l];
+            lowerPrice += lower[l] * levelPrices[l];
+        }
+        extrapolationError = fabs(optionPrice - lowerPrice);
+        
+        double sum = 0.0;
+        double sumSquared = 0.0;
+        for (int i = 0; i < nPaths; i++) {
+            double combined = 0.0;
+            for (int l = 0; l < nLevels; l++) {
+                combined += weights[l] * pathValues[static_cast<size_t>(l) * nPaths + i];
+            }
+            sum += combined;
+            sumSquared += combined * combined;
+        }
+        double mean = sum / nPaths;
+        standardError = sqrt(std::max(0.0, sumSquared / nPaths - mean * mean) / nPaths);
+        recordSimulation(simulationStats, nPaths);
+    }
+    
+    // Clean up
+    delete[] pathValues;
+    for (int i = 0; i < nPaths; i++) {
+        delete[] F_dates[i];
+        delete[] alpha_dates[i];
+        if (weighted) {
+            delete[] weight_dates[i];
+        }
+    }
+    delete[] F_dates;
+    delete[] alpha_dates;
+    delete[] weight_dates;
+    
+    return optionPrice;
+}
@@ -4,9 +4,36 @@
 #include "SABRSimulator.h"
 #include "BermudanOption.h"
 #include "PolynomialRegression.h"
+#include "TimeGrid.h"
 #include "PricingResults.h"
+#include "PathFile.h"
+#include "Instrumentation.h"
+#include "VectorMath.h"
 #include <vector>
+#include <string>
 #include <cmath>
+#include <atomic>
+
+// Version tag of the pricing numerics (simulation scheme, regression, RNG)
+// Bump whenever a change alters prices for identical inputs: cached results
+// (PricingCache) carrying another tag are discarded.
+#ifndef PRICER_VERSION_TAG
+#define PRICER_VERSION_TAG "lsm-3"
+#endif
+
+// Progress and cooperative cancellation of a running pricing
+// Written by the pricing thread, read (and cancelled) from any other thread.
+// The pricer checks cancelRequested between simulation chunks and between
+// exercise dates, and then returns -1.
+struct PricingControl {
+    std::atomic<int> pathsSimulated;    // Paths simulated so far
+    std::atomic<int> datesProcessed;    // Exercise dates of the backward induction done
+    std::atomic<bool> cancelRequested;
+    
+    PricingControl() : pathsSimulated(0), datesProcessed(0), cancelRequested(false) {}
+    void cancel() { cancelRequested.store(true); }
+    bool isCancelled() const { return cancelRequested.load(); }
+};
 
 // Longstaff-Schwartz Monte Carlo pricer for Bermudan options
 class LSMPricer {
@@ -14,10 +41,46 @@ private:
     double discountRate;     // Risk-free rate r
     int polynomialDegree;    // Degree for regression (default 3)
     double standardError;    // Standard error of last pricing
+    bool verbose;            // Print progress messages to std::cout
+    std::vector<std::vector<double> > exercisePolicy;  // Regression coefficients per exercise date
+    PricingDiagnostics diagnostics;   // Phase timings and per-date statistics of last pricing
+    double lastConditionNumber;       // Condition number of the last regressionFit
+    int lastRegressionPoints;         // Points the last regressionFit used
+    int subsampleSize;                // Initial regression subsample (0: all ITM paths)
+    double subsampleTolerance;        // Relative change of the fit that stops growing it
+    bool boundaryDecision;            // Exercise by boundary in F (see setBoundaryDecision)
+    std::vector<double> exerciseBoundary;  // Critical F per exercise date of last pricing
+    PricingControl* control;          // Progress / cancellation hook (optional, not owned)
+    double maxTimeStep;               // Schedule grid step bound (0: uniform grid)
+    std::vector<double> levelPrices;  // Bermudan price per level of the last American-limit pricing
+    double extrapolationError;        // Error indicator of the last American-limit pricing
+    
+    // Backward induction given each exercise date's path column and the
+    // discount factor from each date to the next
+    // pathValues (optional): each path's discounted value, averaging to the price
+    double backwardInduction(const double* const* F_paths, const double* const* alpha_paths,
+                             int nPaths, const int* exerciseSteps, const double* discounts,
+                             BermudanOption& option, const double* const* weight_paths,
+                             double* pathValues = 0);
+    
+    // Boundary-based exercise decision at one date: finds the exercise
+    // region from the roots of payoff - continuation, partitions the ITM
+    // paths by it and updates the exercised range
+    void boundaryExerciseDate(const double* const* F_paths, const double* const* weight_paths,
+                              int nPaths, int step, double discountToNext,
+                              BermudanOption& option, double* V, int m);
+    
+    // Regression on a subsample grown until the fit is stable
+    int subsampledFit(PolynomialRegression& reg, const std::vector<double>& X,
+                      const std::vector<double>& Y, const std::vector<double>& W,
+                      std::vector<double>& coeffs);
+    
+    // Store simulation phase cost in diagnostics
+    void recordSimulation(const PhaseStats& stats, int nPaths);
     
     // Helper: discount factor from t to t+dt
     double discountFactor(double dt) {
-        return exp(-discountRate * dt);
+        return VectorMath::exp(-discountRate * dt);
     }
     
 public:
@@ -28,20 +91,169 @@ public:
     ~LSMPricer();
     
     // Main pricing function (SPEC COMPLIANT SIGNATURE)
+    // With importance sampling on in sim, the likelihood ratios are simulated
+    // too and used as in priceFromPaths
     double price(SABRSimulator& sim, BermudanOption& option, int nPaths);
     
+    // Backward induction on already simulated paths
+    // Paths hold totalSteps+1 points on a uniform grid over [0, T]; T must be
+    // at least the option's last exercise date. Lets several options
+    // (e.g. a strike ladder) be priced on one simulation.
+    // weight_paths: likelihood ratios from an importance-sampled simulation
+    // (SABRSimulator::setImportanceDrift). Path values are then carried in
+    // pricing-measure terms (V *= L_next / L_now between dates), regressions
+    // are weighted by L at the exercise date and the price averages L * V.
+    double priceFromPaths(const double* const* F_paths, const double* const* alpha_paths,
+                          int nPaths, int totalSteps, double T, BermudanOption& option,
+                          const double* const* weight_paths = 0);
+    
+    // Backward induction on paths simulated on grid (SABRSimulator::simulatePaths
+    // with a TimeGrid); every exercise date must be a grid point (-1 otherwise),
+    // e.g. a grid built from this option's schedule or from a superset of it
+    double priceFromPaths(const double* const* F_paths, const double* const* alpha_paths,
+                          int nPaths, const TimeGrid& grid, BermudanOption& option,
+                          const double* const* weight_paths = 0);
+    
+    // Price from a memory-mapped path file (zero copy)
+    // Uses the first nPaths paths (all if nPaths <= 0); returns -1 if the
+    // file's grid cannot hold the option's exercise dates
+    double priceFromFile(const MappedPaths& paths, BermudanOption& option, int nPaths = 0);
+    
+    // Out-of-core pricing for path counts larger than RAM
+    // Paths are simulated in chunks; only F at each exercise date is kept,
+    // spilled to one (unlinked) file per date in spillDirectory, along with
+    // the path values V. Backward induction streams the date files back in
+    // reverse date order: one pass accumulates the regression's normal
+    // equations, a second applies the exercise decision and rewrites V.
+    // The next chunk is prefetched asynchronously while the current one is
+    // processed. Memory stays within memoryBudget bytes (chunk buffers) plus
+    // O(dates) bookkeeping, whatever nPaths is. Gives the same price as
+    // price() for the same seed; exercise is decided per path whatever
+    // setBoundaryDecision(). Returns -1 if spill files cannot be created
+    // or sim uses importance sampling (not supported out of core).
+    double priceOutOfCore(SABRSimulator& sim, BermudanOption& option, int nPaths,
+                          size_t memoryBudget, const std::string& spillDirectory = "/tmp");
+    
+    // Recompute-instead-of-store pricing
+    // No paths are stored: the forward pass keeps only the current state of
+    // every path (F, alpha, RNG position), saving it at every
+    // checkpointInterval-th exercise date. The backward induction then
+    // regenerates F at each exercise date from the nearest checkpoint
+    // before it (or from t = 0). Memory is V plus 3 columns of nPaths for
+    // the current state and 3 per checkpoint, whatever the number of time
+    // steps; checkpointInterval <= 0 keeps no checkpoint (minimum memory,
+    // most recomputation), 1 checkpoints every date (no recomputation).
+    // Gives the same price as price() for the same seed; exercise is decided
+    // per path whatever setBoundaryDecision(). Returns -1 if sim uses
+    // importance sampling (not supported).
+    double priceRecompute(SABRSimulator& sim, BermudanOption& option, int nPaths,
+                          int checkpointInterval = 0);
+    
+    // American-limit price by Richardson extrapolation over nested schedules
+    // Level 0 is the option's schedule; each further level splits every
+    // period ([0, first date] included) in two, e.g. 4, 8, 16 dates. One
+    // simulation on a grid through the finest dates serves all levels: only
+    // F and alpha at those dates are kept, and each level's backward
+    // induction runs on its subset of them. With P_l the level prices and
+    // P(N) = P_inf + c_1 / N + c_2 / N^2 + ..., the Richardson table
+    // R_l,k = R_l,k-1 + (R_l,k-1 - R_l-1,k-1) / (2^k - 1) gives the limit
+    // R_L-1,L-1 (L = nLevels); as it is a fixed combination of the levels,
+    // getStandardError() is that of the per-path combination on the shared
+    // paths. getExtrapolationError() is |R_L-1,L-1 - R_L-1,L-2| (the finest
+    // Bermudan price for L = 2). Time steps: getMaxTimeStep() if set, else
+    // the step of price()'s uniform grid. Returns -1 if nLevels < 2 or the
+    // pricing is cancelled. Diagnostics and policy are the finest level's.
+    double priceAmericanLimit(SABRSimulator& sim, BermudanOption& option, int nPaths,
+                              int nLevels = 3);
+    
+    // Results of the last American-limit pricing
+    const std::vector<double>& getLevelPrices() const { return levelPrices; }
+    double getExtrapolationError() const { return extrapolationError; }
+    
+    // Number of simulation steps price() uses for this option on the
+    // uniform grid (25 per exercise period)
+    static int simulationSteps(const BermudanOption& option);
+    
+    // Time grid of price() (off by default)
+    // With maxDt > 0, price() simulates on TimeGrid::fromSchedule(option,
+    // maxDt): steps land exactly on every exercise date and each period
+    // gets ceil(length / maxDt) steps. 0 restores the uniform grid of
+    // simulationSteps() steps, where dates are rounded to the nearest step.
+    void setMaxTimeStep(double maxDt) { maxTimeStep = maxDt; }
+    double getMaxTimeStep() const { return maxTimeStep; }
+    
     // Regression fit - least squares on (X, Y) data
     std::vector<double> regressionFit(const std::vector<double>& X, const std::vector<double>& Y);
     
+    // Weighted least squares (W empty: unweighted)
+    std::vector<double> regressionFit(const std::vector<double>& X, const std::vector<double>& Y,
+                                      const std::vector<double>& W);
+    
     // Compute basis function values at given state
     std::vector<double> basisFunctions(double F, double alpha);
     
     // Get standard error from last pricing
     double getStandardError() const { return standardError; }
     
+    // Get exercise policy from last pricing: continuation-value regression
+    // coefficients for exercise dates 0..n-2 (empty where no path was ITM)
+    const std::vector<std::vector<double> >& getExercisePolicy() const { return exercisePolicy; }
+    
+    // Get exercise boundary of last pricing, for exercise dates 0..n-2:
+    // a call is exercised for F >= boundary, a put for F <= boundary
+    // (lowest/highest F of the exercise region); NaN where never exercised
+    const std::vector<double>& getExerciseBoundary() const { return exerciseBoundary; }
+    
+    // Exercise region in F where payoff(F) > continuation(F) for the fitted
+    // coefficients, searched between the strike and the farthest ITM state
+    // Fills [start, end] intervals (ascending); returns their count
+    static int exerciseRegion(const std::vector<double>& coeffs, const BermudanOption& option,
+                              double lo, double hi, std::vector<double>& intervals);
+    
+    // Get instrumentation of last pricing (empty with LSM_NO_INSTRUMENTATION)
+    const PricingDiagnostics& getDiagnostics() const { return diagnostics; }
+    
+    // Get parameters
+    double getDiscountRate() const { return discountRate; }
+    int getPolynomialDegree() const { return polynomialDegree; }
+    
     // Set parameters
     void setDiscountRate(double r) { discountRate = r; }
     void setPolynomialDegree(int deg) { polynomialDegree = deg; }
+    void setVerbose(bool v) { verbose = v; }
+    
+    // Boundary-based exercise decision (off by default)
+    // With F as the only regression state, exercising is a threshold rule
+    // on F: each date finds the exercise region once by root-finding the
+    // fitted continuation against the payoff, partitions the ITM paths by
+    // it and writes the payoff over the exercised index range, instead of
+    // evaluating payoff and polynomial per path. Same regression input as
+    // the per-path decision; prices agree up to paths lying within
+    // rounding of the boundary (test_lsm_pricer checks they are identical).
+    // Applies to price(), priceFromPaths(), priceFromFile() and
+    // priceAmericanLimit(); priceOutOfCore() and priceRecompute() always
+    // decide per path but report the same getExerciseBoundary().
+    void setBoundaryDecision(bool enabled) { boundaryDecision = enabled; }
+    
+    // Subsampled regression (off by default)
+    // With more than 2 * initialSize ITM paths, each date's regression
+    // starts on initialSize of them, evenly spread, and doubles the sample
+    // until the fitted continuation value moves by at most
+    // tolerance * RMS(continuation), RMS over the newly added points (or
+    // every path is in). The exercise decision is still applied to all paths.
+    // Points used per date: getDiagnostics().regressionPoints.
+    void setRegressionSubsampling(int initialSize, double tolerance = 0.01) {
+        subsampleSize = initialSize;
+        subsampleTolerance = tolerance;
+    }
+    int getSubsampleSize() const { return subsampleSize; }
+    double getSubsampleTolerance() const { return subsampleTolerance; }
+    
+    // Report progress to / take cancellation from control (0 to detach)
+    // price() then simulates in chunks of SIMULATION_CHUNK paths
+    void setControl(PricingControl* c) { control = c; }
+    static const int SIMULATION_CHUNK = 4096;
+    bool getBoundaryDecision() const { return boundaryDecision; }
 };
 
 #endif
@@ -0,0 +1,284 @@
+#include "ParameterSweep.h"
+#include "SABRSimulator.h"
+#include "LSMPricer.h"
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <algorithm>
+
+// Constructor
+ParameterSweep::ParameterSweep(const SweepScenario& base, const std::vector<double>& exerciseDates,
+                               OptionType type, double r, int polyDegree, int nPaths,
+                               unsigned int seed) {
+    this->base = base;
+    this->exerciseDates = exerciseDates;
+    this->optionType = type;
+    this->discountRate = r;
+    this->polynomialDegree = polyDegree;
+    this->nPaths = nPaths;
+    this->seed = seed;
+    this->nSimulations = 0;
+    this->batchSize = 4;
+    this->importanceSampling = false;
+}
+
+// Destructor
+ParameterSweep::~ParameterSweep() {
+    // Vectors handle their own cleanup
+}
+
+// Declare a grid
+void ParameterSweep::addGrid(const std::string& name, const std::vector<SweepAxis>& axes) {
+    gridNames.push_back(name);
+    gridAxes.push_back(axes);
+}
+
+// Read one parameter of a scenario
+double ParameterSweep::getParameter(const SweepScenario& s, SweepParameter p) {
+    switch (p) {
+        case SWEEP_F0:     return s.F0;
+        case SWEEP_ALPHA0: return s.alpha0;
+        case SWEEP_BETA:   return s.beta;
+        case SWEEP_NU:     return s.nu;
+        case SWEEP_RHO:    return s.rho;
+        case SWEEP_STRIKE: return s.strike;
+    }
+    return 0.0;
+}
+
+// Set one parameter of a scenario
+void ParameterSweep::setParameter(SweepScenario& s, SweepParameter p, double value) {
+    switch (p) {
+        case SWEEP_F0:     s.F0 = value; break;
+        case SWEEP_ALPHA0: s.alpha0 = value; break;
+        case SWEEP_BETA:   s.beta = value; break;
+        case SWEEP_NU:     s.nu = value; break;
+        case SWEEP_RHO:    s.rho = value; break;
+        case SWEEP_STRIKE: s.strike = value; break;
+    }
+}
+
+// Expand grids: odometer over the axes, last axis varying fastest
+std::vector<SweepResult> ParameterSweep::scenarios() const {
+    std::vector<SweepResult> out;
+    for (size_t g = 0; g < gridAxes.size(); g++) {
+        const std::vector<SweepAxis>& axes = gridAxes[g];
+        bool empty = false;
+        for (size_t a = 0; a < axes.size(); a++) {
+            if (axes[a].values.empty()) empty = true;
+        }
+        if (empty) continue;
+        
+        std::vector<size_t> idx(axes.size(), 0);
+        while (true) {
+            SweepResult r;
+            r.grid = gridNames[g];
+            r.scenario = base;
+            for (size_t a = 0; a < axes.size(); a++) {
+                setParameter(r.scenario, axes[a].parameter, axes[a].values[idx[a]]);
+            }
+            r.price = 0.0;
+            r.standardError = 0.0;
+            out.push_back(r);
+            
+            // Advance odometer
+            int a = static_cast<int>(axes.size()) - 1;
+            while (a >= 0 && ++idx[a] == axes[a].values.size()) {
+                idx[a] = 0;
+                a--;
+            }
+            if (a < 0) break;
+        }
+    }
+    return out;
+}
+
+// Price all scenarios
+// OTM scenarios share one importance-sampled simulation per model
+bool ParameterSweep::usesImportanceSampling(const SweepScenario& s) const {
+    if (!importanceSampling) {
+        return false;
+    }
+    return (optionType == CALL) ? (s.strike > s.F0) : (s.strike < s.F0);
+}
+
+std::vector<SweepResult> ParameterSweep::run(ThreadPool& pool) {
+    std::vector<SweepResult> results = scenarios();
+    if (results.empty()) {
+        nSimulations = 0;
+        return results;
+    }
+    
+    // Group scenarios by model parameters: one simulation per group, and
+    // one drifted simulation per model for its importance-sampled (OTM)
+    // scenarios
+    typedef std::vector<double> ModelKey;
+    std::map<ModelKey, std::vector<size_t> > groups;
+    std::map<ModelKey, std::vector<size_t> > sampledGroups;
+    for (size_t i = 0; i < results.size(); i++) {
+        const SweepScenario& s = results[i].scenario;
+        ModelKey key;
+        key.push_back(s.F0);
+        key.push_back(s.alpha0);
+        key.push_back(s.beta);
+        key.push_back(s.nu);
+        key.push_back(s.rho);
+        if (usesImportanceSampling(s)) {
+            sampledGroups[key].push_back(i);
+        } else {
+            groups[key].push_back(i);
+        }
+    }
+    nSimulations = static_cast<int>(groups.size() + sampledGroups.size());
+    
+    // Distinct models, batched so one pass of random draws drives several
+    std::vector<const std::vector<size_t>*> models;
+    std::map<ModelKey, std::vector<size_t> >::const_iterator it;
+    for (it = groups.begin(); it != groups.end(); ++it) {
+        models.push_back(&it->second);
+    }
+    
+    // Importance-sampled groups: drift toward the group's mean strike, then
+    // every strike of the group reuses the weighted paths
+    SweepResult* out = &results[0];
+    for (it = sampledGroups.begin(); it != sampledGroups.end(); ++it) {
+        const std::vector<size_t>* members = &it->second;
+        pool.submit([this, members, out]() {
+            const SweepScenario& s = out[(*members)[0]].scenario;
+            double meanStrike = 0.0;
+            for (size_t m = 0; m < members->size(); m++) {
+                meanStrike += out[(*members)[m]].scenario.strike;
+            }
+            meanStrike /= static_cast<double>(members->size());
+            
+            BermudanOption first(s.strike, exerciseDates, optionType);
+            int totalSteps = LSMPricer::simulationSteps(first);
+            double T = exerciseDates.back();
+            double** F_paths = new double*[nPaths];
+            double** alpha_paths = new double*[nPaths];
+            double** weight_paths = new double*[nPaths];
+            for (int i = 0; i < nPaths; i++) {
+                F_paths[i] = new double[totalSteps + 1];
+                alpha_paths[i] = new double[totalSteps + 1];
+                weight_paths[i] = new double[totalSteps + 1];
+            }
+            
+            SABRSimulator sim(s.F0, s.alpha0, s.beta, s.nu, s.rho, seed);
+            sim.setImportanceTarget(meanStrike, T);
+            sim.simulatePaths(nPaths, totalSteps, T, F_paths, alpha_paths, 0, weight_paths);
+            
+            LSMPricer pricer(discountRate, polynomialDegree);
+            pricer.setVerbose(false);
+            for (size_t m = 0; m < members->size(); m++) {
+                SweepResult& r = out[(*members)[m]];
+                BermudanOption opt(r.scenario.strike, exerciseDates, optionType);
+                r.price = pricer.priceFromPaths(F_paths, alpha_paths, nPaths, totalSteps, T,
+                                                opt, weight_paths);
+                r.standardError = pricer.getStandardError();
+            }
+            
+            for (int i = 0; i < nPaths; i++) {
+                delete[] F_paths[i];
+                delete[] alpha_paths[i];
+                delete[] weight_paths[i];
+            }
+            delete[] F_paths;
+            delete[] alpha_paths;
+            delete[] weight_paths;
+        });
+    }
+    
+    for (size_t b = 0; b < models.size(); b += batchSize) {
+        size_t nBatch = std::min(static_cast<size_t>(batchSize), models.size() - b);
+        std::vector<const std::vector<size_t>*> batch(models.begin() + b, models.begin() + b + nBatch);
+        pool.submit([this, batch, out]() {
+            int nScenarios = static_cast<int>(batch.size());
+            std::vector<SABRParameters> params(nScenarios);
+            for (int k = 0; k < nScenarios; k++) {
+                const SweepScenario& s = out[(*batch[k])[0]].scenario;
+                params[k].F0 = s.F0;
+                params[k].alpha0 = s.alpha0;
+                params[k].beta = s.beta;
+                params[k].nu = s.nu;
+                params[k].rho = s.rho;
+            }
+            
+            BermudanOption first(out[(*batch[0])[0]].scenario.strike, exerciseDates, optionType);
+            int totalSteps = LSMPricer::simulationSteps(first);
+            double T = exerciseDates.back();
+            double*** F_paths = new double**[nScenarios];
+            double*** alpha_paths = new double**[nScenarios];
+            for (int k = 0; k < nScenarios; k++) {
+                F_paths[k] = new double*[nPaths];
+                alpha_paths[k] = new double*[nPaths];
+                for (int i = 0; i < nPaths; i++) {
+                    F_paths[k][i] = new double[totalSteps + 1];
+                    alpha_paths[k][i] = new double[totalSteps + 1];
+                }
+            }
+            
+            // The batch simulator only contributes the shared seed
+            SABRSimulator sim(params[0].F0, params[0].alpha0, params[0].beta,
+                              params[0].nu, params[0].rho, seed);
+            sim.simulatePathsBatch(nScenarios, &params[0], nPaths, totalSteps, T,
+                                   F_paths, alpha_paths);
+            
+            // Every strike of a model reuses that model's paths
+            LSMPricer pricer(discountRate, polynomialDegree);
+            pricer.setVerbose(false);
+            for (int k = 0; k < nScenarios; k++) {
+                const std::vector<size_t>& members = *batch[k];
+                for (size_t m = 0; m < members.size(); m++) {
+                    SweepResult& r = out[members[m]];
+                    BermudanOption opt(r.scenario.strike, exerciseDates, optionType);
+                    r.price = pricer.priceFromPaths(F_paths[k], alpha_paths[k], nPaths,
+                                                    totalSteps, T, opt);
+                    r.standardError = pricer.getStandardError();
+                }
+            }
+            
+            for (int k = 0; k < nScenarios; k++) {
+                for (int i = 0; i < nPaths; i++) {
+                    delete[] F_paths[k][i];
+                    delete[] alpha_paths[k][i];
+                }
+                delete[] F_paths[k];
+                delete[] alpha_paths[k];
+            }
+            delete[] F_paths;
+            delete[] alpha_paths;
+        });
+    }
+    pool.wait();
+    
+    return results;
+}
+
+// Column name of a parameter
+const char* ParameterSweep::parameterName(SweepParameter p) {
+    switch (p) {
+        case SWEEP_F0:     return "F0";
+        case SWEEP_ALPHA0: return "alpha0";
+        case SWEEP_BETA:   return "beta";
+        case SWEEP_NU:     return "nu";
+        case SWEEP_RHO:    return "rho";
+        case SWEEP_STRIKE: return "strike";
+    }
+    return "";
+}
+
+// Save as CSV
+void ParameterSweep::saveToCSV(const std::vector<SweepResult>& results, const std::string& filename) {
+    std::ofstream file(filename);
+    file << "grid,F0,alpha0,beta,nu,rho,strike,price,std_error" << std::endl;
+    file << std::setprecision(10);
+    for (size_t i = 0; i < results.size(); i++) {
+        const SweepResult& r = results[i];
+        file << r.grid << ","
+             << r.scenario.F0 << "," << r.scenario.alpha0 << ","
+             << r.scenario.beta << "," << r.scenario.nu << ","
+             << r.scenario.rho << "," << r.scenario.strike << ","
+             << r.price << "," << r.standardError << std::endl;
+    }
+    file.close();
+}
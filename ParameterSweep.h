@@ -0,0 +1,117 @@
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include "BermudanOption.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+// Parameters that can be swept
+enum SweepParameter {
+    SWEEP_F0,
+    SWEEP_ALPHA0,
+    SWEEP_BETA,
+    SWEEP_NU,
+    SWEEP_RHO,
+    SWEEP_STRIKE
+};
+
+// One point of a sweep: SABR model parameters plus strike
+struct SweepScenario {
+    double F0;
+    double alpha0;
+    double beta;
+    double nu;
+    double rho;
+    double strike;
+};
+
+// One swept parameter and the values it takes
+struct SweepAxis {
+    SweepParameter parameter;
+    std::vector<double> values;
+};
+
+// Priced scenario
+struct SweepResult {
+    std::string grid;        // Name of the grid the scenario came from
+    SweepScenario scenario;
+    double price;
+    double standardError;
+};
+
+// Parameter-sweep engine for sensitivity analysis
+// Grids are declared as a base scenario plus axes (the cartesian product of
+// the axes is priced). All scenarios share one seed, so path i sees the same
+// Brownian increments in every scenario (common random numbers) and price
+// differences are smooth. Scenarios with identical model parameters are
+// priced on a single simulation (e.g. a strike ladder); distinct models are
+// simulated batchSize at a time with SABRSimulator::simulatePathsBatch (one
+// random draw drives the whole batch), one batch per ThreadPool task.
+// With importance sampling on, out-of-the-money scenarios (call K > F0,
+// put K < F0) of a model are instead priced on one simulation shared by
+// them, drifted toward their mean strike (SABRSimulator::setImportanceTarget)
+// and still on the shared seed. OTM strikes of a model stay coupled to each
+// other, but not to its ITM strikes: a price difference across K = F0
+// mixes two measures and carries the variance of both.
+//
+// Trade-off: a drift per strike would cut each OTM variance further but
+// decouple every OTM strike from its neighbours.
+class ParameterSweep {
+private:
+    SweepScenario base;
+    std::vector<double> exerciseDates;
+    OptionType optionType;
+    double discountRate;
+    int polynomialDegree;
+    int nPaths;
+    unsigned int seed;
+    
+    std::vector<std::string> gridNames;
+    std::vector<std::vector<SweepAxis> > gridAxes;
+    int nSimulations;        // Distinct simulations used by the last run
+    int batchSize;           // Models simulated together per task (default 4)
+    bool importanceSampling; // Importance-sample OTM scenarios (default off)
+    
+    // True if scenario s is priced on its own importance-sampled simulation
+    bool usesImportanceSampling(const SweepScenario& s) const;
+    
+public:
+    // Constructor
+    ParameterSweep(const SweepScenario& base, const std::vector<double>& exerciseDates,
+                   OptionType type, double r, int polyDegree, int nPaths, unsigned int seed);
+    
+    // Destructor
+    ~ParameterSweep();
+    
+    // Declare a grid: base scenario with the listed axes varied jointly
+    void addGrid(const std::string& name, const std::vector<SweepAxis>& axes);
+    
+    // Expand all grids into scenarios (grid order, last axis fastest)
+    std::vector<SweepResult> scenarios() const;
+    
+    // Price every scenario on the pool; results are in scenarios() order
+    std::vector<SweepResult> run(ThreadPool& pool);
+    
+    // Set number of models per batched simulation (1 = unbatched)
+    void setBatchSize(int n) { batchSize = std::max(n, 1); }
+    
+    // Price OTM scenarios with importance sampling (one drift per model)
+    void setImportanceSampling(bool enabled) { importanceSampling = enabled; }
+    
+    // Number of simulations performed by the last run()
+    int getNSimulations() const { return nSimulations; }
+    
+    // Write results as CSV (one row per scenario)
+    static void saveToCSV(const std::vector<SweepResult>& results, const std::string& filename);
+    
+    // Column name of a parameter
+    static const char* parameterName(SweepParameter p);
+    
+    // Read / write one parameter of a scenario
+    static double getParameter(const SweepScenario& s, SweepParameter p);
+    static void setParameter(SweepScenario& s, SweepParameter p, double value);
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "PathFile.h"
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char PATH_MAGIC[8] = {'S', 'A', 'B', 'R', 'P', 'A', 'T', 'H'};
+
+// Constructor
+MappedPaths::MappedPaths() {
+    fd = -1;
+    mapping = 0;
+    mappedSize = 0;
+    memset(&header, 0, sizeof(header));
+    F_rows = 0;
+    alpha_rows = 0;
+}
+
+// Destructor
+MappedPaths::~MappedPaths() {
+    close();
+}
+
+// Write padded header
+bool MappedPaths::writeHeader(std::ostream& out, const PathFileHeader& h) {
+    PathFileHeader copy = h;
+    memcpy(copy.magic, PATH_MAGIC, sizeof(PATH_MAGIC));
+    copy.version = PATH_FILE_VERSION;
+    copy.layout = PATH_LAYOUT_INTERLEAVED;
+    copy.headerSize = PATH_FILE_HEADER_SIZE;
+    
+    std::vector<char> block(PATH_FILE_HEADER_SIZE, 0);
+    memcpy(&block[0], &copy, sizeof(copy));
+    out.write(&block[0], block.size());
+    return static_cast<bool>(out);
+}
+
+// Map and validate
+bool MappedPaths::open(const std::string& filename) {
+    close();
+    
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < PATH_FILE_HEADER_SIZE) {
+        close();
+        return false;
+    }
+    mappedSize = static_cast<size_t>(st.st_size);
+    mapping = mmap(0, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        mapping = 0;
+        close();
+        return false;
+    }
+    
+    memcpy(&header, mapping, sizeof(header));
+    size_t row = static_cast<size_t>(header.nSteps) + 1;
+    size_t expected = static_cast<size_t>(PATH_FILE_HEADER_SIZE)
+                    + 2 * row * static_cast<size_t>(header.nPaths) * sizeof(double);
+    if (memcmp(header.magic, PATH_MAGIC, sizeof(PATH_MAGIC)) != 0
+        || header.version != PATH_FILE_VERSION
+        || header.layout != PATH_LAYOUT_INTERLEAVED
+        || header.headerSize != PATH_FILE_HEADER_SIZE
+        || header.nPaths <= 0 || header.nSteps <= 0
+        || mappedSize < expected) {
+        close();
+        return false;
+    }
+    
+    // Row pointers into the mapping
+    const double* data = reinterpret_cast<const double*>(
+        static_cast<const char*>(mapping) + PATH_FILE_HEADER_SIZE);
+    F_rows = new const double*[header.nPaths];
+    alpha_rows = new const double*[header.nPaths];
+    for (int i = 0; i < header.nPaths; i++) {
+        F_rows[i] = data + 2 * row * i;
+        alpha_rows[i] = data + 2 * row * i + row;
+    }
+    return true;
+}
+
+// Unmap
+void MappedPaths::close() {
+    delete[] F_rows;
+    delete[] alpha_rows;
+    F_rows = 0;
+    alpha_rows = 0;
+    if (mapping != 0) {
+        munmap(mapping, mappedSize);
+        mapping = 0;
+    }
+    mappedSize = 0;
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+// Model / seed / grid check
+bool MappedPaths::matches(const SABRParameters& params, unsigned int seed, int nSteps, double T) const {
+    return isOpen() && header.firstPath == 0 && header.seed == seed
+        && header.nSteps == nSteps && header.T == T
+        && header.F0 == params.F0 && header.alpha0 == params.alpha0
+        && header.beta == params.beta && header.nu == params.nu && header.rho == params.rho;
+}
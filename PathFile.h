@@ -0,0 +1,71 @@
+#ifndef PATHFILE_H
+#define PATHFILE_H
+
+#include "SABRSimulator.h"
+#include <string>
+#include <ostream>
+
+// Binary path file format (version 1)
+// [header, padded to PATH_FILE_HEADER_SIZE bytes][path 0][path 1]...
+// Layout PATH_LAYOUT_INTERLEAVED: each path record is its F row followed by
+// its alpha row, nSteps+1 doubles each, in native byte order. The padded
+// header keeps the data page-aligned so mapped rows can be used in place.
+const int PATH_FILE_VERSION = 1;
+const int PATH_FILE_HEADER_SIZE = 4096;
+const int PATH_LAYOUT_INTERLEAVED = 1;
+
+struct PathFileHeader {
+    char magic[8];           // "SABRPATH"
+    int version;             // PATH_FILE_VERSION
+    int layout;              // PATH_LAYOUT_INTERLEAVED
+    int headerSize;          // Bytes before the first path
+    int nPaths;
+    int nSteps;              // Steps per path (rows hold nSteps+1 points)
+    unsigned int seed;       // Path i = random substream (seed, firstPath + i)
+    int firstPath;
+    double T;                // Uniform grid over [0, T]
+    double F0, alpha0, beta, nu, rho;
+};
+
+// Read-only memory mapping of a path file
+// Exposes per-path row pointers straight into the mapping (no copy), so
+// several processes pricing from one file share the page cache.
+class MappedPaths {
+private:
+    int fd;
+    void* mapping;
+    size_t mappedSize;
+    PathFileHeader header;
+    const double** F_rows;
+    const double** alpha_rows;
+    
+public:
+    // Constructor
+    MappedPaths();
+    
+    // Destructor (unmaps)
+    ~MappedPaths();
+    
+    // Map a file; false if missing, truncated or of another version
+    bool open(const std::string& filename);
+    
+    // Unmap
+    void close();
+    
+    // Write a header padded to PATH_FILE_HEADER_SIZE (used by SABRSimulator::writePaths)
+    static bool writeHeader(std::ostream& out, const PathFileHeader& header);
+    
+    // True if the file holds paths of this model, seed and grid
+    bool matches(const SABRParameters& params, unsigned int seed, int nSteps, double T) const;
+    
+    // Getters
+    bool isOpen() const { return mapping != 0; }
+    const PathFileHeader& getHeader() const { return header; }
+    int getNPaths() const { return header.nPaths; }
+    int getNSteps() const { return header.nSteps; }
+    double getT() const { return header.T; }
+    const double* const* getFPaths() const { return F_rows; }
+    const double* const* getAlphaPaths() const { return alpha_rows; }
+};
+
+#endif
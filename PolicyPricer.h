@@ -0,0 +1,354 @@
+#ifndef POLICYPRICER_H
+#define POLICYPRICER_H
+
+#include "SABRSimulator.h"
+#include "PolynomialRegression.h"
+#include "VectorMath.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Policy-based Longstaff-Schwartz pricer
+//
+// Payoff, regression basis and exercise rule are template parameters, so
+// the per-date sweep over paths is one inlined, branch-free loop (selects
+// instead of if/else, no virtual calls, no per-path allocation) that the
+// compiler can vectorize. LSMPricer stays the runtime-configurable pricer;
+// PolicyPricer<VanillaCall> on the same paths gives the same price.
+//
+// A payoff policy is a copyable struct with
+//     double operator()(double F) const;
+// A basis policy provides
+//     static const int size;            number of basis functions
+//     static const bool usesAlpha;      whether alpha is read
+//     static double value(const double* coeffs, double F, double alpha);
+//     static void fit(const double* F, const double* alpha, const double* C,
+//                     int n, double* coeffs);
+// An exercise policy provides
+//     static const bool early;          false: never exercise before maturity
+//     static bool exercise(double payoff, double continuation);
+
+// ---------------------------------------------------------------------------
+// Payoffs
+// ---------------------------------------------------------------------------
+
+// max(F - K, 0)
+struct VanillaCall {
+    double strike;
+    explicit VanillaCall(double K) : strike(K) {}
+    double operator()(double F) const { return std::max(F - strike, 0.0); }
+};
+
+// max(K - F, 0)
+struct VanillaPut {
+    double strike;
+    explicit VanillaPut(double K) : strike(K) {}
+    double operator()(double F) const { return std::max(strike - F, 0.0); }
+};
+
+// cash if F > K, else 0
+struct DigitalCall {
+    double strike;
+    double cash;
+    DigitalCall(double K, double cash = 1.0) : strike(K), cash(cash) {}
+    double operator()(double F) const { return (F > strike) ? cash : 0.0; }
+};
+
+// cash if F < K, else 0
+struct DigitalPut {
+    double strike;
+    double cash;
+    DigitalPut(double K, double cash = 1.0) : strike(K), cash(cash) {}
+    double operator()(double F) const { return (F < strike) ? cash : 0.0; }
+};
+
+// min(max(F - K, 0), cap)
+struct CappedCall {
+    double strike;
+    double cap;
+    CappedCall(double K, double cap) : strike(K), cap(cap) {}
+    double operator()(double F) const { return std::min(std::max(F - strike, 0.0), cap); }
+};
+
+// Spread-to-strike: notional * max((F - K) / K - spread, 0)
+// (pays the relative move above the strike in excess of a spread)
+struct SpreadToStrikeCall {
+    double strike;
+    double spread;
+    double notional;
+    SpreadToStrikeCall(double K, double spread, double notional = 100.0)
+        : strike(K), spread(spread), notional(notional) {}
+    double operator()(double F) const {
+        return notional * std::max((F - strike) / strike - spread, 0.0);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Regression bases
+// ---------------------------------------------------------------------------
+
+// Least squares on any basis through its normal equations (size x size),
+// solved by Gaussian elimination with partial pivoting
+template <class Basis>
+inline void fitNormalEquations(const double* F, const double* alpha, const double* C,
+                               int n, double* coeffs) {
+    const int k = Basis::size;
+    double A[k][k];
+    double b[k];
+    double row[k];
+    for (int r = 0; r < k; r++) {
+        b[r] = 0.0;
+        for (int c = 0; c < k; c++) {
+            A[r][c] = 0.0;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        Basis::evaluate(F[i], Basis::usesAlpha ? alpha[i] : 0.0, row);
+        for (int r = 0; r < k; r++) {
+            for (int c = 0; c < k; c++) {
+                A[r][c] += row[r] * row[c];
+            }
+            b[r] += row[r] * C[i];
+        }
+    }
+
+    for (int p = 0; p < k; p++) {
+        int pivot = p;
+        for (int r = p + 1; r < k; r++) {
+            if (std::fabs(A[r][p]) > std::fabs(A[pivot][p])) pivot = r;
+        }
+        for (int c = 0; c < k; c++) std::swap(A[p][c], A[pivot][c]);
+        std::swap(b[p], b[pivot]);
+        if (A[p][p] == 0.0) continue;
+        for (int r = p + 1; r < k; r++) {
+            double factor = A[r][p] / A[p][p];
+            for (int c = p; c < k; c++) A[r][c] -= factor * A[p][c];
+            b[r] -= factor * b[p];
+        }
+    }
+    for (int p = k - 1; p >= 0; p--) {
+        double sum = b[p];
+        for (int c = p + 1; c < k; c++) sum -= A[p][c] * coeffs[c];
+        coeffs[p] = (A[p][p] != 0.0) ? sum / A[p][p] : 0.0;
+    }
+}
+
+// Terms J..Degree of sum_j coeffs[j] F^j, unrolled at compile time
+// (a runtime loop here would keep the exercise sweep from vectorizing)
+template <int J, int Degree, bool Done = (J > Degree)>
+struct MonomialTerms {
+    static double add(const double* coeffs, double F, double basis, double result) {
+        basis *= F;
+        return MonomialTerms<J + 1, Degree>::add(coeffs, F, basis, result + coeffs[J] * basis);
+    }
+};
+
+template <int J, int Degree>
+struct MonomialTerms<J, Degree, true> {
+    static double add(const double*, double, double, double result) { return result; }
+};
+
+// [1, F, F^2, ..., F^Degree], fitted with PolynomialRegression
+// (same basis and arithmetic as LSMPricer)
+template <int Degree>
+struct MonomialBasis {
+    static const int size = Degree + 1;
+    static const bool usesAlpha = false;
+
+    static double value(const double* coeffs, double F, double /*alpha*/) {
+        return MonomialTerms<1, Degree>::add(coeffs, F, 1.0, coeffs[0]);
+    }
+
+    static void fit(const double* F, const double* /*alpha*/, const double* C,
+                    int n, double* coeffs) {
+        PolynomialRegression reg(Degree);
+        reg.reset();
+        reg.addPoints(F, C, n);
+        reg.solve();
+        for (int j = 0; j <= Degree; j++) {
+            coeffs[j] = reg.getCoefficient(j);
+        }
+    }
+};
+
+// [1, F, F^2, alpha, alpha F, alpha^2]: uses the SABR volatility state too
+struct StochasticVolBasis {
+    static const int size = 6;
+    static const bool usesAlpha = true;
+
+    static void evaluate(double F, double alpha, double* row) {
+        row[0] = 1.0;
+        row[1] = F;
+        row[2] = F * F;
+        row[3] = alpha;
+        row[4] = alpha * F;
+        row[5] = alpha * alpha;
+    }
+
+    static double value(const double* coeffs, double F, double alpha) {
+        return coeffs[0] + F * (coeffs[1] + coeffs[2] * F)
+             + alpha * (coeffs[3] + coeffs[4] * F + coeffs[5] * alpha);
+    }
+
+    static void fit(const double* F, const double* alpha, const double* C,
+                    int n, double* coeffs) {
+        fitNormalEquations<StochasticVolBasis>(F, alpha, C, n, coeffs);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Exercise rules
+// ---------------------------------------------------------------------------
+
+// Longstaff-Schwartz: exercise when the payoff beats the regressed continuation
+struct OptimalExercise {
+    static const bool early = true;
+    static bool exercise(double payoff, double continuation) { return payoff > continuation; }
+};
+
+// Never exercise early: prices the European option on the same paths
+// (a lower bound for the Bermudan, handy as a check or control variate)
+struct NoEarlyExercise {
+    static const bool early = false;
+    static bool exercise(double, double) { return false; }
+};
+
+// ---------------------------------------------------------------------------
+// Pricer
+// ---------------------------------------------------------------------------
+
+template <class Payoff, class Basis = MonomialBasis<3>, class Exercise = OptimalExercise>
+class PolicyPricer {
+private:
+    Payoff payoff;
+    std::vector<double> exerciseDates;
+    double discountRate;
+    double standardError;
+    std::vector<std::vector<double> > exercisePolicy;  // Coefficients per exercise date
+
+public:
+    // Constructor
+    PolicyPricer(const Payoff& payoff, const std::vector<double>& dates, double r = 0.05)
+        : payoff(payoff), exerciseDates(dates), discountRate(r), standardError(0.0) {}
+
+    // Simulate on LSMPricer's grid (25 steps per exercise period) and price
+    double price(SABRSimulator& sim, int nPaths) {
+        int nDates = static_cast<int>(exerciseDates.size());
+        int totalSteps = (nDates - 1) * 25;
+        double T = exerciseDates.back();
+
+        double** F_paths = new double*[nPaths];
+        double** alpha_paths = new double*[nPaths];
+        for (int i = 0; i < nPaths; i++) {
+            F_paths[i] = new double[totalSteps + 1];
+            alpha_paths[i] = new double[totalSteps + 1];
+        }
+        sim.simulatePaths(nPaths, totalSteps, T, F_paths, alpha_paths);
+        double result = priceFromPaths(F_paths, alpha_paths, nPaths, totalSteps, T);
+        for (int i = 0; i < nPaths; i++) {
+            delete[] F_paths[i];
+            delete[] alpha_paths[i];
+        }
+        delete[] F_paths;
+        delete[] alpha_paths;
+        return result;
+    }
+
+    // Backward induction on already simulated paths (same layout and grid
+    // rules as LSMPricer::priceFromPaths)
+    double priceFromPaths(const double* const* F_paths, const double* const* alpha_paths,
+                          int nPaths, int totalSteps, double T) {
+        int nDates = static_cast<int>(exerciseDates.size());
+        double dt = T / static_cast<double>(totalSteps);
+        std::vector<int> steps(nDates);
+        for (int m = 0; m < nDates; m++) {
+            steps[m] = static_cast<int>(exerciseDates[m] / dt + 0.5);
+        }
+        exercisePolicy.assign(nDates - 1, std::vector<double>());
+
+        // Contiguous per-date columns so the sweeps run on flat arrays
+        std::vector<double> V(nPaths), Fm(nPaths), am(Basis::usesAlpha ? nPaths : 0);
+        std::vector<double> F_itm(nPaths), a_itm(Basis::usesAlpha ? nPaths : 0), C_itm(nPaths);
+        double coeffs[Basis::size];
+        const Payoff pay = payoff;
+
+        int last = steps[nDates - 1];
+        for (int i = 0; i < nPaths; i++) {
+            V[i] = pay(F_paths[i][last]);
+        }
+
+        for (int m = nDates - 2; m >= 0; m--) {
+            int step = steps[m];
+            double discountToNext = VectorMath::exp(-discountRate * (steps[m + 1] - step) * dt);
+            double* v = &V[0];
+
+            if (!Exercise::early) {
+                for (int i = 0; i < nPaths; i++) {
+                    v[i] *= discountToNext;
+                }
+                continue;
+            }
+
+            // Gather the date's states
+            for (int i = 0; i < nPaths; i++) {
+                Fm[i] = F_paths[i][step];
+            }
+            if (Basis::usesAlpha) {
+                for (int i = 0; i < nPaths; i++) {
+                    am[i] = alpha_paths[i][step];
+                }
+            }
+            const double* f = &Fm[0];
+            const double* a = Basis::usesAlpha ? &am[0] : f;
+
+            // Branch-free compaction of in-the-money paths
+            int nItm = 0;
+            for (int i = 0; i < nPaths; i++) {
+                F_itm[nItm] = f[i];
+                if (Basis::usesAlpha) a_itm[nItm] = a[i];
+                C_itm[nItm] = v[i] * discountToNext;
+                nItm += (pay(f[i]) > 0.0);
+            }
+            if (nItm == 0) {
+                for (int i = 0; i < nPaths; i++) {
+                    v[i] *= discountToNext;
+                }
+                continue;
+            }
+
+            Basis::fit(&F_itm[0], Basis::usesAlpha ? &a_itm[0] : &F_itm[0], &C_itm[0], nItm, coeffs);
+            exercisePolicy[m].assign(coeffs, coeffs + Basis::size);
+
+            // Exercise sweep: selects only, inlined payoff and basis
+            for (int i = 0; i < nPaths; i++) {
+                double now = pay(f[i]);
+                double continuation = Basis::value(coeffs, f[i], Basis::usesAlpha ? a[i] : 0.0);
+                double held = v[i] * discountToNext;
+                double chosen = Exercise::exercise(now, continuation) ? now : held;
+                v[i] = (now > 0.0) ? chosen : held;
+            }
+        }
+
+        double discountToZero = VectorMath::exp(-discountRate * exerciseDates[0]);
+        double sum = 0.0;
+        double sumSquared = 0.0;
+        for (int i = 0; i < nPaths; i++) {
+            double discounted = V[i] * discountToZero;
+            sum += discounted;
+            sumSquared += discounted * discounted;
+        }
+        double optionPrice = sum / static_cast<double>(nPaths);
+        double variance = (sumSquared / nPaths) - (optionPrice * optionPrice);
+        standardError = std::sqrt(variance / nPaths);
+        return optionPrice;
+    }
+
+    // Getters
+    double getStandardError() const { return standardError; }
+    const std::vector<std::vector<double> >& getExercisePolicy() const { return exercisePolicy; }
+    const Payoff& getPayoff() const { return payoff; }
+    const std::vector<double>& getExerciseDates() const { return exerciseDates; }
+    double getDiscountRate() const { return discountRate; }
+};
+
+#endif
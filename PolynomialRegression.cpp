@@ -9,11 +9,22 @@ PolynomialRegression::PolynomialRegression(int degree) {
     for (int i = 0; i <= degree; i++) {
         coefficients[i] = 0.0;
     }
+    XTX = new double*[degree + 1];
+    for (int i = 0; i <= degree; i++) {
+        XTX[i] = new double[degree + 1];
+    }
+    XTC = new double[degree + 1];
+    reset();
 }
 
 // Destructor
 PolynomialRegression::~PolynomialRegression() {
     delete[] coefficients;
+    for (int i = 0; i <= degree; i++) {
+        delete[] XTX[i];
+    }
+    delete[] XTX;
+    delete[] XTC;
 }
 
 // Compute basis functions: [1, F, F^2, ..., F^degree]
@@ -88,51 +99,112 @@ void PolynomialRegression::gaussianElimination(double** A, double* b, double* x,
 
 // Fit polynomial using least squares
 void PolynomialRegression::fit(double* F_values, double* C_values, int nPoints) {
-    int p = degree + 1;  // Number of coefficients
-    
-    // Build design matrix X: X[i][j] = F_i^j
-    double** X = new double*[nPoints];
-    for (int i = 0; i < nPoints; i++) {
-        X[i] = new double[p];
-        computeBasis(F_values[i], X[i]);
-    }
-    
-    // Compute X^T X (p x p matrix)
-    double** XTX = new double*[p];
+    reset();
+    addPoints(F_values, C_values, nPoints);
+    solve();
+}
+
+// Clear accumulated normal equations
+void PolynomialRegression::reset() {
+    int p = degree + 1;
     for (int i = 0; i < p; i++) {
-        XTX[i] = new double[p];
         for (int j = 0; j < p; j++) {
             XTX[i][j] = 0.0;
-            for (int k = 0; k < nPoints; k++) {
-                XTX[i][j] += X[k][i] * X[k][j];
+        }
+        XTC[i] = 0.0;
+    }
+    nAccumulated = 0;
+}
+
+// Accumulate X^T X and X^T C (X[k][i] = F_k^i)
+void PolynomialRegression::addPoints(const double* F_values, const double* C_values, int nPoints) {
+    int p = degree + 1;
+    double* basis = new double[p];
+    for (int k = 0; k < nPoints; k++) {
+        computeBasis(F_values[k], basis);
+        for (int i = 0; i < p; i++) {
+            for (int j = 0; j < p; j++) {
+                XTX[i][j] += basis[i] * basis[j];
             }
+            XTC[i] += basis[i] * C_values[k];
         }
     }
-    
-    // Compute X^T C (p x 1 vector)
-    double* XTC = new double[p];
-    for (int i = 0; i < p; i++) {
-        XTC[i] = 0.0;
-        for (int k = 0; k < nPoints; k++) {
-            XTC[i] += X[k][i] * C_values[k];
+    nAccumulated += nPoints;
+    delete[] basis;
+}
+
+// Accumulate X^T W X and X^T W C
+void PolynomialRegression::addWeightedPoints(const double* F_values, const double* C_values,
+                                             const double* weights, int nPoints) {
+    int p = degree + 1;
+    double* basis = new double[p];
+    for (int k = 0; k < nPoints; k++) {
+        computeBasis(F_values[k], basis);
+        for (int i = 0; i < p; i++) {
+            double wb = weights[k] * basis[i];
+            for (int j = 0; j < p; j++) {
+                XTX[i][j] += wb * basis[j];
+            }
+            XTC[i] += wb * C_values[k];
         }
     }
-    
-    // Solve normal equations: XTX * a = XTC
-    gaussianElimination(XTX, XTC, coefficients, p);
-    
-    // Clean up
-    for (int i = 0; i < nPoints; i++) {
-        delete[] X[i];
+    nAccumulated += nPoints;
+    delete[] basis;
+}
+
+// Copy out the accumulated normal equations
+void PolynomialRegression::getNormalEquations(double* xtx, double* xtc) const {
+    int p = degree + 1;
+    for (int i = 0; i < p; i++) {
+        for (int j = 0; j < p; j++) {
+            xtx[i * p + j] = XTX[i][j];
+        }
+        xtc[i] = XTC[i];
     }
-    delete[] X;
-    
+}
+
+// Merge normal equations accumulated elsewhere
+void PolynomialRegression::addNormalEquations(const double* xtx, const double* xtc, long long nPoints) {
+    int p = degree + 1;
     for (int i = 0; i < p; i++) {
-        delete[] XTX[i];
+        for (int j = 0; j < p; j++) {
+            XTX[i][j] += xtx[i * p + j];
+        }
+        XTC[i] += xtc[i];
     }
-    delete[] XTX;
-    
-    delete[] XTC;
+    nAccumulated += nPoints;
+}
+
+// Solve normal equations: XTX * a = XTC
+void PolynomialRegression::solve() {
+    gaussianElimination(XTX, XTC, coefficients, degree + 1);
+}
+
+// cond_1(X^T X) = ||A||_1 * ||A^{-1}||_1, inverse column by column
+double PolynomialRegression::conditionNumber() {
+    int p = degree + 1;
+    double* e = new double[p];
+    double* column = new double[p];
+    double normA = 0.0;
+    double normInv = 0.0;
+    for (int j = 0; j < p; j++) {
+        double colSumA = 0.0;
+        for (int i = 0; i < p; i++) {
+            colSumA += fabs(XTX[i][j]);
+            e[i] = (i == j) ? 1.0 : 0.0;
+        }
+        normA = std::max(normA, colSumA);
+        
+        gaussianElimination(XTX, e, column, p);
+        double colSumInv = 0.0;
+        for (int i = 0; i < p; i++) {
+            colSumInv += fabs(column[i]);
+        }
+        normInv = std::max(normInv, colSumInv);
+    }
+    delete[] e;
+    delete[] column;
+    return normA * normInv;
 }
 
 // Predict value at F
@@ -10,6 +10,9 @@ class PolynomialRegression {
 private:
     int degree;              // Polynomial degree (e.g., 3)
     double* coefficients;    // Coefficients a0, a1, ..., a_degree
+    double** XTX;            // Accumulated normal matrix X^T X
+    double* XTC;             // Accumulated right-hand side X^T C
+    long long nAccumulated;  // Points added since last reset
     
     // Helper: compute basis functions [1, F, F^2, ..., F^degree]
     void computeBasis(double F, double* basis);
@@ -33,6 +36,28 @@ public:
     // nPoints = number of data points
     void fit(double* F_values, double* C_values, int nPoints);
     
+    // Incremental fit: reset, add points in any number of batches, solve
+    // Only the (degree+1)^2 normal equations are kept, so data can be
+    // streamed (out-of-core) and gives the same result as one fit() call
+    void reset();
+    void addPoints(const double* F_values, const double* C_values, int nPoints);
+    
+    // Weighted least squares: accumulates X^T W X and X^T W C
+    // (e.g. likelihood-ratio weights under importance sampling)
+    void addWeightedPoints(const double* F_values, const double* C_values,
+                           const double* weights, int nPoints);
+    void solve();
+    long long getNAccumulated() const { return nAccumulated; }
+    
+    // Sufficient statistics: X^T X ((degree+1)^2, row-major) and X^T C
+    // Normal equations of disjoint point sets add up, so separately
+    // accumulated shards merge into the fit of their union
+    void getNormalEquations(double* xtx, double* xtc) const;
+    void addNormalEquations(const double* xtx, const double* xtc, long long nPoints);
+    
+    // 1-norm condition number of the accumulated X^T X (diagnostics)
+    double conditionNumber();
+    
     // Predict continuation value at given F
     double predict(double F);
     
@@ -0,0 +1,387 @@
+#include "PriceSurface.h"
+#include <cmath>
+#include <fstream>
+#include <cstring>
+
+const double PI = 3.14159265358979323846;
+
+// File header tag and format version
+static const char SURFACE_MAGIC[8] = {'S', 'A', 'B', 'R', 'C', 'H', 'E', 'B'};
+static const int SURFACE_VERSION = 1;
+
+// Default constructor
+PriceSurface::PriceSurface() {
+    base.F0 = base.alpha0 = base.beta = base.nu = base.rho = base.strike = 0.0;
+    optionType = CALL;
+    discountRate = 0.0;
+    polynomialDegree = 3;
+    nPaths = 0;
+    seed = 0;
+    truncationError = 0.0;
+    maxStandardError = 0.0;
+    built = false;
+}
+
+// Constructor
+PriceSurface::PriceSurface(const SweepScenario& base, const std::vector<double>& exerciseDates,
+                           OptionType type, double r, int polyDegree, int nPaths,
+                           unsigned int seed) {
+    this->base = base;
+    this->exerciseDates = exerciseDates;
+    this->optionType = type;
+    this->discountRate = r;
+    this->polynomialDegree = polyDegree;
+    this->nPaths = nPaths;
+    this->seed = seed;
+    this->truncationError = 0.0;
+    this->maxStandardError = 0.0;
+    this->built = false;
+}
+
+// Destructor
+PriceSurface::~PriceSurface() {
+    // Vectors handle their own cleanup
+}
+
+// Usable axis domain: finite with lo < hi (lo == hi divides by zero in evaluate)
+static bool validDomain(double lo, double hi) {
+    return std::isfinite(lo) && std::isfinite(hi) && lo < hi;
+}
+
+// Add an axis
+bool PriceSurface::addAxis(SweepParameter parameter, double lo, double hi, int nNodes) {
+    if (parameter < SWEEP_F0 || parameter > SWEEP_STRIKE || !validDomain(lo, hi) || nNodes < 1) {
+        return false;
+    }
+    SurfaceAxis axis;
+    axis.parameter = parameter;
+    axis.lo = lo;
+    axis.hi = hi;
+    axis.nNodes = nNodes;
+    axes.push_back(axis);
+    built = false;
+    return true;
+}
+
+// Build: price at Chebyshev nodes, then transform each axis to coefficients
+void PriceSurface::build(ThreadPool& pool) {
+    // Chebyshev nodes of the first kind, mapped to [lo, hi]
+    std::vector<SweepAxis> grid(axes.size());
+    for (size_t a = 0; a < axes.size(); a++) {
+        grid[a].parameter = axes[a].parameter;
+        for (int k = 0; k < axes[a].nNodes; k++) {
+            double x = cos(PI * (k + 0.5) / axes[a].nNodes);
+            grid[a].values.push_back(axes[a].lo + 0.5 * (x + 1.0) * (axes[a].hi - axes[a].lo));
+        }
+    }
+    
+    ParameterSweep sweep(base, exerciseDates, optionType, discountRate, polynomialDegree,
+                         nPaths, seed);
+    sweep.addGrid("surface", grid);
+    std::vector<SweepResult> results = sweep.run(pool);
+    
+    coefficients.resize(results.size());
+    maxStandardError = 0.0;
+    for (size_t i = 0; i < results.size(); i++) {
+        coefficients[i] = results[i].price;
+        maxStandardError = std::max(maxStandardError, results[i].standardError);
+    }
+    
+    // Discrete Chebyshev transform along each axis in turn:
+    // c_j = (2 - [j == 0]) / n * sum_k f(x_k) cos(pi j (k + 0.5) / n)
+    size_t outer = 1;
+    for (size_t a = 0; a < axes.size(); a++) {
+        size_t n = static_cast<size_t>(axes[a].nNodes);
+        size_t inner = coefficients.size() / (outer * n);
+        std::vector<double> line(n);
+        for (size_t o = 0; o < outer; o++) {
+            for (size_t in = 0; in < inner; in++) {
+                double* f = &coefficients[(o * n) * inner + in];
+                for (size_t k = 0; k < n; k++) line[k] = f[k * inner];
+                for (size_t j = 0; j < n; j++) {
+                    double sum = 0.0;
+                    for (size_t k = 0; k < n; k++) {
+                        sum += line[k] * cos(PI * j * (k + 0.5) / n);
+                    }
+                    f[j * inner] = (j == 0 ? 1.0 : 2.0) * sum / n;
+                }
+            }
+        }
+        outer *= n;
+    }
+    
+    // Truncation estimate: magnitude of the last coefficient slice per axis
+    truncationError = 0.0;
+    outer = 1;
+    for (size_t a = 0; a < axes.size(); a++) {
+        size_t n = static_cast<size_t>(axes[a].nNodes);
+        size_t inner = coefficients.size() / (outer * n);
+        double slice = 0.0;
+        for (size_t o = 0; o < outer; o++) {
+            for (size_t in = 0; in < inner; in++) {
+                slice += fabs(coefficients[(o * n + n - 1) * inner + in]);
+            }
+        }
+        truncationError += slice;
+        outer *= n;
+    }
+    
+    built = true;
+}
+
+// Evaluate the tensor series by contracting one axis at a time (last first)
+double PriceSurface::evaluate(const SweepScenario& s, int derivativeAxis) const {
+    if (!built || coefficients.empty()) {
+        return 0.0;
+    }
+    
+    std::vector<double> work(coefficients);
+    size_t size = work.size();
+    std::vector<double> T;
+    
+    for (int a = static_cast<int>(axes.size()) - 1; a >= 0; a--) {
+        const SurfaceAxis& axis = axes[a];
+        size_t n = static_cast<size_t>(axis.nNodes);
+        double width = axis.hi - axis.lo;
+        double x = 2.0 * (ParameterSweep::getParameter(s, axis.parameter) - axis.lo) / width - 1.0;
+        
+        // T_j(x), or dT_j/dv = j U_{j-1}(x) * 2 / width on the derivative axis
+        T.assign(n, 0.0);
+        if (a == derivativeAxis) {
+            double Um2 = 0.0, Um1 = 1.0;   // U_{-1}, U_0
+            for (size_t j = 1; j < n; j++) {
+                T[j] = j * Um1 * 2.0 / width;
+                double U = 2.0 * x * Um1 - Um2;
+                Um2 = Um1;
+                Um1 = U;
+            }
+        } else {
+            T[0] = 1.0;
+            if (n > 1) T[1] = x;
+            for (size_t j = 2; j < n; j++) T[j] = 2.0 * x * T[j - 1] - T[j - 2];
+        }
+        
+        size_t outer = size / n;
+        for (size_t o = 0; o < outer; o++) {
+            double sum = 0.0;
+            const double* c = &work[o * n];
+            for (size_t j = 0; j < n; j++) sum += c[j] * T[j];
+            work[o] = sum;
+        }
+        size = outer;
+    }
+    return work[0];
+}
+
+// Interpolated price
+double PriceSurface::price(const SweepScenario& s) const {
+    return evaluate(s, -1);
+}
+
+// Interpolated delta
+double PriceSurface::delta(const SweepScenario& s) const {
+    for (size_t a = 0; a < axes.size(); a++) {
+        if (axes[a].parameter == SWEEP_F0) {
+            return evaluate(s, static_cast<int>(a));
+        }
+    }
+    return 0.0;
+}
+
+// Domain / fixed-parameter check
+bool PriceSurface::covers(const SweepScenario& s) const {
+    SweepParameter all[] = {SWEEP_F0, SWEEP_ALPHA0, SWEEP_BETA, SWEEP_NU, SWEEP_RHO, SWEEP_STRIKE};
+    for (int p = 0; p < 6; p++) {
+        double v = ParameterSweep::getParameter(s, all[p]);
+        bool isAxis = false;
+        for (size_t a = 0; a < axes.size(); a++) {
+            if (axes[a].parameter == all[p]) {
+                isAxis = true;
+                if (v < axes[a].lo || v > axes[a].hi) return false;
+            }
+        }
+        if (!isAxis && v != ParameterSweep::getParameter(base, all[p])) return false;
+    }
+    return true;
+}
+
+// Rebuild only when needed, moving only what drifted
+bool PriceSurface::rebuildIfDrifted(const SweepScenario& current, ThreadPool& pool) {
+    if (built && covers(current)) {
+        return false;
+    }
+    for (size_t a = 0; a < axes.size(); a++) {
+        double v = ParameterSweep::getParameter(current, axes[a].parameter);
+        if (v < axes[a].lo || v > axes[a].hi) {
+            double halfWidth = 0.5 * (axes[a].hi - axes[a].lo);
+            axes[a].lo = v - halfWidth;
+            axes[a].hi = v + halfWidth;
+        }
+    }
+    
+    // Fixed parameters follow current; axis parameters keep the old base
+    SweepScenario newBase = current;
+    for (size_t a = 0; a < axes.size(); a++) {
+        ParameterSweep::setParameter(newBase, axes[a].parameter,
+                                     ParameterSweep::getParameter(base, axes[a].parameter));
+    }
+    base = newBase;
+    build(pool);
+    return true;
+}
+
+// Scenario fields written one by one in declaration order (not the raw
+// struct, whose layout is the compiler's)
+static void writeScenario(std::ofstream& file, const SweepScenario& s) {
+    const double fields[6] = {s.F0, s.alpha0, s.beta, s.nu, s.rho, s.strike};
+    file.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+}
+
+static void readScenario(std::ifstream& file, SweepScenario& s) {
+    double fields[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    file.read(reinterpret_cast<char*>(fields), sizeof(fields));
+    s.F0 = fields[0];
+    s.alpha0 = fields[1];
+    s.beta = fields[2];
+    s.nu = fields[3];
+    s.rho = fields[4];
+    s.strike = fields[5];
+}
+
+// Save to binary file
+// Layout: magic[8], version, base scenario (F0, alpha0, beta, nu, rho,
+// strike), option type, r, degree, nPaths,
+// seed, nDates, dates, nAxes, axes (parameter, lo, hi, nNodes), error
+// estimates, nCoefficients, coefficients
+bool PriceSurface::save(const std::string& filename) const {
+    std::ofstream file(filename.c_str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    int type = static_cast<int>(optionType);
+    int nDates = static_cast<int>(exerciseDates.size());
+    int nAxes = static_cast<int>(axes.size());
+    long long nCoeffs = static_cast<long long>(coefficients.size());
+    
+    file.write(SURFACE_MAGIC, sizeof(SURFACE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&SURFACE_VERSION), sizeof(int));
+    writeScenario(file, base);
+    file.write(reinterpret_cast<const char*>(&type), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&discountRate), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&polynomialDegree), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&nPaths), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&seed), sizeof(unsigned int));
+    file.write(reinterpret_cast<const char*>(&nDates), sizeof(int));
+    if (nDates > 0) {
+        file.write(reinterpret_cast<const char*>(&exerciseDates[0]), nDates * sizeof(double));
+    }
+    file.write(reinterpret_cast<const char*>(&nAxes), sizeof(int));
+    for (int a = 0; a < nAxes; a++) {
+        int parameter = static_cast<int>(axes[a].parameter);
+        file.write(reinterpret_cast<const char*>(&parameter), sizeof(int));
+        file.write(reinterpret_cast<const char*>(&axes[a].lo), sizeof(double));
+        file.write(reinterpret_cast<const char*>(&axes[a].hi), sizeof(double));
+        file.write(reinterpret_cast<const char*>(&axes[a].nNodes), sizeof(int));
+    }
+    file.write(reinterpret_cast<const char*>(&truncationError), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&maxStandardError), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&nCoeffs), sizeof(long long));
+    if (nCoeffs > 0) {
+        file.write(reinterpret_cast<const char*>(&coefficients[0]), nCoeffs * sizeof(double));
+    }
+    return static_cast<bool>(file);
+}
+
+// Load from binary file
+// Every count is checked against the bytes left in the file before it is
+// used, and the surface is only replaced once the whole file is valid
+bool PriceSurface::load(const std::string& filename) {
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    long long fileSize = static_cast<long long>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    
+    char magic[8];
+    int version = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(int));
+    if (!file || memcmp(magic, SURFACE_MAGIC, sizeof(magic)) != 0 || version != SURFACE_VERSION) {
+        return false;
+    }
+    
+    SweepScenario fileBase;
+    int type = 0, degree = 0, paths = 0, nDates = 0, nAxes = 0;
+    unsigned int fileSeed = 0;
+    double r = 0.0;
+    readScenario(file, fileBase);
+    file.read(reinterpret_cast<char*>(&type), sizeof(int));
+    file.read(reinterpret_cast<char*>(&r), sizeof(double));
+    file.read(reinterpret_cast<char*>(&degree), sizeof(int));
+    file.read(reinterpret_cast<char*>(&paths), sizeof(int));
+    file.read(reinterpret_cast<char*>(&fileSeed), sizeof(unsigned int));
+    file.read(reinterpret_cast<char*>(&nDates), sizeof(int));
+    if (!file || (type != CALL && type != PUT) || nDates < 0
+        || nDates > (fileSize - file.tellg()) / static_cast<long long>(sizeof(double))) {
+        return false;
+    }
+    std::vector<double> dates(nDates);
+    if (nDates > 0) {
+        file.read(reinterpret_cast<char*>(&dates[0]), nDates * sizeof(double));
+    }
+    
+    // Axes: parameter, lo, hi, nNodes
+    const long long axisBytes = 2 * sizeof(int) + 2 * sizeof(double);
+    file.read(reinterpret_cast<char*>(&nAxes), sizeof(int));
+    if (!file || nAxes < 0 || nAxes > (fileSize - file.tellg()) / axisBytes) {
+        return false;
+    }
+    std::vector<SurfaceAxis> fileAxes(nAxes);
+    long long expected = 1;
+    long long maxCoeffs = fileSize / static_cast<long long>(sizeof(double));
+    for (int a = 0; a < nAxes; a++) {
+        int parameter = 0;
+        file.read(reinterpret_cast<char*>(&parameter), sizeof(int));
+        file.read(reinterpret_cast<char*>(&fileAxes[a].lo), sizeof(double));
+        file.read(reinterpret_cast<char*>(&fileAxes[a].hi), sizeof(double));
+        file.read(reinterpret_cast<char*>(&fileAxes[a].nNodes), sizeof(int));
+        if (!file || parameter < SWEEP_F0 || parameter > SWEEP_STRIKE
+            || !validDomain(fileAxes[a].lo, fileAxes[a].hi) || fileAxes[a].nNodes < 1 || fileAxes[a].nNodes > maxCoeffs / expected) {
+            return false;
+        }
+        fileAxes[a].parameter = static_cast<SweepParameter>(parameter);
+        expected *= fileAxes[a].nNodes;
+    }
+    
+    // Coefficients: exactly the tensor size, ending the file
+    double truncation = 0.0, maxError = 0.0;
+    long long nCoeffs = 0;
+    file.read(reinterpret_cast<char*>(&truncation), sizeof(double));
+    file.read(reinterpret_cast<char*>(&maxError), sizeof(double));
+    file.read(reinterpret_cast<char*>(&nCoeffs), sizeof(long long));
+    if (!file || nCoeffs != expected
+        || nCoeffs * static_cast<long long>(sizeof(double)) != fileSize - file.tellg()) {
+        return false;
+    }
+    std::vector<double> coeffs(static_cast<size_t>(nCoeffs));
+    file.read(reinterpret_cast<char*>(&coeffs[0]), nCoeffs * sizeof(double));
+    if (!file) {
+        return false;
+    }
+    
+    base = fileBase;
+    exerciseDates.swap(dates);
+    optionType = static_cast<OptionType>(type);
+    discountRate = r;
+    polynomialDegree = degree;
+    nPaths = paths;
+    seed = fileSeed;
+    axes.swap(fileAxes);
+    truncationError = truncation;
+    maxStandardError = maxError;
+    coefficients.swap(coeffs);
+    built = true;
+    return true;
+}
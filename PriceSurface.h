@@ -0,0 +1,96 @@
+#ifndef PRICESURFACE_H
+#define PRICESURFACE_H
+
+#include "ParameterSweep.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <string>
+
+// One dimension of the surface: parameter, domain [lo, hi] and node count
+struct SurfaceAxis {
+    SweepParameter parameter;
+    double lo;
+    double hi;
+    int nNodes;
+};
+
+// Chebyshev proxy of the LSM Bermudan price for real-time quoting
+// build() prices the option at the tensor grid of Chebyshev nodes with the
+// normal simulator/pricer (through ParameterSweep: common random numbers,
+// one simulation per model shared by all strike nodes) and stores the
+// tensor Chebyshev coefficients. price()/delta() then evaluate the series
+// in microseconds. Parameters that are not axes are fixed at the base
+// scenario. Coefficients and settings round-trip through a compact binary
+// file (save/load).
+class PriceSurface {
+private:
+    SweepScenario base;
+    std::vector<double> exerciseDates;
+    OptionType optionType;
+    double discountRate;
+    int polynomialDegree;
+    int nPaths;
+    unsigned int seed;
+    
+    std::vector<SurfaceAxis> axes;
+    std::vector<double> coefficients;   // Tensor coefficients, axis 0 slowest
+    double truncationError;             // Sum over axes of the last coefficient slice
+    double maxStandardError;            // Largest MC standard error at the nodes
+    bool built;
+    
+    // Evaluate the series; derivativeAxis >= 0 differentiates along that axis
+    double evaluate(const SweepScenario& s, int derivativeAxis) const;
+    
+public:
+    // Constructor (empty surface, e.g. before load())
+    PriceSurface();
+    
+    // Constructor with pricing settings
+    PriceSurface(const SweepScenario& base, const std::vector<double>& exerciseDates,
+                 OptionType type, double r, int polyDegree, int nPaths, unsigned int seed);
+    
+    // Destructor
+    ~PriceSurface();
+    
+    // Add an interpolation dimension (F0, K, alpha0, nu, rho, ...)
+    // Returns false (axis not added) unless lo < hi, both finite, and nNodes >= 1
+    bool addAxis(SweepParameter parameter, double lo, double hi, int nNodes);
+    
+    // Price all nodes and compute the coefficients
+    void build(ThreadPool& pool);
+    
+    // Interpolated price; parameters that are not axes are ignored
+    // Points outside an axis's [lo, hi] are extrapolated by the series
+    // without any warning, and its error bound does not hold there: check
+    // covers() first (or use rebuildIfDrifted)
+    double price(const SweepScenario& s) const;
+    
+    // Interpolated dPrice/dF0 (0 if F0 is not an axis; extrapolated like price())
+    double delta(const SweepScenario& s) const;
+    
+    // Error bound estimate: Chebyshev truncation (size of the highest-order
+    // coefficients) plus twice the largest node standard error
+    double getErrorBound() const { return truncationError + 2.0 * maxStandardError; }
+    double getTruncationError() const { return truncationError; }
+    double getMaxStandardError() const { return maxStandardError; }
+    
+    // True if s is inside the domain and matches the fixed (non-axis) parameters
+    bool covers(const SweepScenario& s) const;
+    
+    // Selective rebuild: does nothing while covers(current) holds; otherwise
+    // re-centres only the axes current has drifted out of (same width), moves
+    // fixed parameters to current and rebuilds. Returns true if rebuilt.
+    bool rebuildIfDrifted(const SweepScenario& current, ThreadPool& pool);
+    
+    // Binary file I/O (returns false on failure; a failed load() leaves the
+    // surface unchanged)
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+    
+    // Getters
+    bool isBuilt() const { return built; }
+    int getNNodes() const { return static_cast<int>(coefficients.size()); }
+    const SweepScenario& getBase() const { return base; }
+};
+
+#endif
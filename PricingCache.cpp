@@ -0,0 +1,309 @@
+#include "PricingCache.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <sys/stat.h>
+
+// File header tag for disk entries
+static const char CACHE_MAGIC[8] = {'S', 'A', 'B', 'R', 'C', 'A', 'C', 'H'};
+
+// Key equality (exact, field by field)
+bool PricingKey::operator==(const PricingKey& other) const {
+    return F0 == other.F0 && alpha0 == other.alpha0 && beta == other.beta
+        && nu == other.nu && rho == other.rho && strike == other.strike
+        && type == other.type && dates == other.dates && r == other.r
+        && polyDegree == other.polyDegree && nPaths == other.nPaths
+        && nSteps == other.nSteps && seed == other.seed;
+}
+
+// Constructor
+PricingCache::PricingCache(size_t capacity, const std::string& directory) {
+    this->capacity = capacity;
+    this->directory = directory;
+    this->hits = 0;
+    this->misses = 0;
+    if (!directory.empty()) {
+        mkdir(directory.c_str(), 0755);   // Fails harmlessly if it exists
+    }
+}
+
+// Destructor
+PricingCache::~PricingCache() {
+    // Containers handle their own cleanup
+}
+
+// Build key
+bool PricingCache::makeKey(const SABRSimulator& sim, const BermudanOption& option,
+                           const LSMPricer& pricer, int nPaths, PricingKey& key) {
+    if (!sim.isSeeded() || sim.isImportanceSampling() || pricer.getMaxTimeStep() > 0.0
+        || pricer.getSubsampleSize() > 0) {
+        return false;
+    }
+    key.F0 = sim.getF0();
+    key.alpha0 = sim.getAlpha0();
+    key.beta = sim.getBeta();
+    key.nu = sim.getNu();
+    key.rho = sim.getRho();
+    key.strike = option.getStrike();
+    key.type = static_cast<int>(option.getOptionType());
+    key.dates = option.getExerciseDates();
+    key.r = pricer.getDiscountRate();
+    key.polyDegree = pricer.getPolynomialDegree();
+    key.nPaths = nPaths;
+    key.nSteps = LSMPricer::simulationSteps(option);
+    key.seed = sim.getSeed();
+    return true;
+}
+
+// FNV-1a over raw bytes
+static void fnv(unsigned long long& h, const void* data, size_t n) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 0x100000001B3ULL;
+    }
+}
+
+// Content hash
+unsigned long long PricingCache::hashKey(const PricingKey& key) {
+    unsigned long long h = 0xCBF29CE484222325ULL;
+    const char* tag = PRICER_VERSION_TAG;
+    fnv(h, tag, strlen(tag));
+    fnv(h, &key.F0, sizeof(double));
+    fnv(h, &key.alpha0, sizeof(double));
+    fnv(h, &key.beta, sizeof(double));
+    fnv(h, &key.nu, sizeof(double));
+    fnv(h, &key.rho, sizeof(double));
+    fnv(h, &key.strike, sizeof(double));
+    fnv(h, &key.type, sizeof(int));
+    for (size_t i = 0; i < key.dates.size(); i++) {
+        fnv(h, &key.dates[i], sizeof(double));
+    }
+    fnv(h, &key.r, sizeof(double));
+    fnv(h, &key.polyDegree, sizeof(int));
+    fnv(h, &key.nPaths, sizeof(int));
+    fnv(h, &key.nSteps, sizeof(int));
+    fnv(h, &key.seed, sizeof(unsigned int));
+    return h;
+}
+
+// Insert at LRU front, evicting the least recently used
+void PricingCache::insertLocked(unsigned long long hash, const PricingKey& key, const CacheEntry& entry) {
+    std::vector<std::list<Item>::iterator>& bucket = index[hash];
+    for (size_t i = 0; i < bucket.size(); i++) {
+        if (bucket[i]->first == key) {
+            bucket[i]->second = entry;
+            lru.splice(lru.begin(), lru, bucket[i]);
+            return;
+        }
+    }
+    lru.push_front(Item(key, entry));
+    bucket.push_back(lru.begin());
+    
+    while (lru.size() > capacity && !lru.empty()) {
+        std::list<Item>::iterator victim = --lru.end();
+        unsigned long long victimHash = hashKey(victim->first);
+        std::vector<std::list<Item>::iterator>& vb = index[victimHash];
+        for (size_t i = 0; i < vb.size(); i++) {
+            if (vb[i] == victim) {
+                vb.erase(vb.begin() + i);
+                break;
+            }
+        }
+        if (vb.empty()) {
+            index.erase(victimHash);
+        }
+        lru.erase(victim);
+    }
+}
+
+// Memory, then disk
+bool PricingCache::lookup(const PricingKey& key, CacheEntry& entry) {
+    unsigned long long hash = hashKey(key);
+    std::unique_lock<std::mutex> lock(mtx);
+    
+    std::unordered_map<unsigned long long, std::vector<std::list<Item>::iterator> >::iterator it = index.find(hash);
+    if (it != index.end()) {
+        for (size_t i = 0; i < it->second.size(); i++) {
+            if (it->second[i]->first == key) {
+                lru.splice(lru.begin(), lru, it->second[i]);
+                entry = it->second[i]->second;
+                hits++;
+                return true;
+            }
+        }
+    }
+    
+    if (!directory.empty() && loadFromDisk(hash, key, entry)) {
+        insertLocked(hash, key, entry);
+        hits++;
+        return true;
+    }
+    misses++;
+    return false;
+}
+
+// Usable result: finite, non-negative price and standard error (not the -1
+// of a cancelled or failed pricing, not NaN)
+bool PricingCache::isValidEntry(const CacheEntry& entry) {
+    return std::isfinite(entry.price) && entry.price >= 0.0
+        && std::isfinite(entry.standardError) && entry.standardError >= 0.0;
+}
+
+// Store in memory and on disk
+bool PricingCache::store(const PricingKey& key, const CacheEntry& entry) {
+    if (!isValidEntry(entry)) {
+        return false;
+    }
+    unsigned long long hash = hashKey(key);
+    std::unique_lock<std::mutex> lock(mtx);
+    insertLocked(hash, key, entry);
+    if (!directory.empty()) {
+        saveToDisk(hash, key, entry);
+    }
+    return true;
+}
+
+// Read-through pricing
+double PricingCache::price(LSMPricer& pricer, SABRSimulator& sim, BermudanOption& option,
+                           int nPaths, CacheEntry* entry) {
+    PricingKey key;
+    CacheEntry result;
+    bool cacheable = makeKey(sim, option, pricer, nPaths, key);
+    if (cacheable && lookup(key, result)) {
+        if (entry) *entry = result;
+        return result.price;
+    }
+    
+    result.price = pricer.price(sim, option, nPaths);
+    result.standardError = pricer.getStandardError();
+    result.exercisePolicy = pricer.getExercisePolicy();
+    // A cancelled pricing returns -1: store() keeps completed results only
+    if (cacheable) {
+        store(key, result);
+    }
+    if (entry) *entry = result;
+    return result.price;
+}
+
+// Drop memory tier
+void PricingCache::clear() {
+    std::unique_lock<std::mutex> lock(mtx);
+    lru.clear();
+    index.clear();
+}
+
+// Disk file of a hash
+std::string PricingCache::diskPath(unsigned long long hash) const {
+    std::ostringstream oss;
+    oss << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".cache";
+    return oss.str();
+}
+
+// Serialise a key (shared by save and load comparison)
+static void writeKey(std::ostream& out, const PricingKey& key) {
+    int nDates = static_cast<int>(key.dates.size());
+    out.write(reinterpret_cast<const char*>(&key.F0), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&key.alpha0), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&key.beta), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&key.nu), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&key.rho), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&key.strike), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&key.type), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&nDates), sizeof(int));
+    for (int i = 0; i < nDates; i++) {
+        out.write(reinterpret_cast<const char*>(&key.dates[i]), sizeof(double));
+    }
+    out.write(reinterpret_cast<const char*>(&key.r), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&key.polyDegree), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&key.nPaths), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&key.nSteps), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&key.seed), sizeof(unsigned int));
+}
+
+// Disk entry layout: magic, tag length, tag, serialised key, price,
+// standard error, nDates, then (nCoeffs, coeffs) per exercise date
+void PricingCache::saveToDisk(unsigned long long hash, const PricingKey& key, const CacheEntry& entry) const {
+    std::string path = diskPath(hash);
+    std::string tmp = path + ".tmp";
+    std::ofstream file(tmp.c_str(), std::ios::binary);
+    if (!file) {
+        return;
+    }
+    const char* tag = PRICER_VERSION_TAG;
+    int tagLength = static_cast<int>(strlen(tag));
+    file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&tagLength), sizeof(int));
+    file.write(tag, tagLength);
+    writeKey(file, key);
+    file.write(reinterpret_cast<const char*>(&entry.price), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&entry.standardError), sizeof(double));
+    int nPolicy = static_cast<int>(entry.exercisePolicy.size());
+    file.write(reinterpret_cast<const char*>(&nPolicy), sizeof(int));
+    for (int m = 0; m < nPolicy; m++) {
+        int n = static_cast<int>(entry.exercisePolicy[m].size());
+        file.write(reinterpret_cast<const char*>(&n), sizeof(int));
+        if (n > 0) {
+            file.write(reinterpret_cast<const char*>(&entry.exercisePolicy[m][0]), n * sizeof(double));
+        }
+    }
+    file.close();
+    if (file) {
+        rename(tmp.c_str(), path.c_str());   // Readers never see partial files
+    } else {
+        remove(tmp.c_str());
+    }
+}
+
+// Load and validate a disk entry (tag and full key must match)
+bool PricingCache::loadFromDisk(unsigned long long hash, const PricingKey& key, CacheEntry& entry) const {
+    std::ifstream file(diskPath(hash).c_str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    char magic[8];
+    int tagLength = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&tagLength), sizeof(int));
+    if (!file || memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 || tagLength < 0 || tagLength > 256) {
+        return false;
+    }
+    std::string tag(tagLength, '\0');
+    file.read(&tag[0], tagLength);
+    if (!file || tag != PRICER_VERSION_TAG) {
+        return false;   // Written by another code version
+    }
+    
+    std::ostringstream expected;
+    writeKey(expected, key);
+    std::string keyBytes = expected.str();
+    std::string stored(keyBytes.size(), '\0');
+    file.read(&stored[0], stored.size());
+    if (!file || stored != keyBytes) {
+        return false;   // Hash collision
+    }
+    
+    int nPolicy = 0;
+    file.read(reinterpret_cast<char*>(&entry.price), sizeof(double));
+    file.read(reinterpret_cast<char*>(&entry.standardError), sizeof(double));
+    file.read(reinterpret_cast<char*>(&nPolicy), sizeof(int));
+    if (!file || !isValidEntry(entry) || nPolicy < 0
+        || nPolicy > static_cast<int>(key.dates.size())) {
+        return false;   // Invalid result or corrupt file
+    }
+    entry.exercisePolicy.assign(nPolicy, std::vector<double>());
+    for (int m = 0; m < nPolicy; m++) {
+        int n = 0;
+        file.read(reinterpret_cast<char*>(&n), sizeof(int));
+        if (!file || n < 0 || n > key.polyDegree + 1) {
+            return false;
+        }
+        entry.exercisePolicy[m].resize(n);
+        if (n > 0) {
+            file.read(reinterpret_cast<char*>(&entry.exercisePolicy[m][0]), n * sizeof(double));
+        }
+    }
+    return static_cast<bool>(file);
+}
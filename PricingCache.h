@@ -0,0 +1,103 @@
+#ifndef PRICINGCACHE_H
+#define PRICINGCACHE_H
+
+#include "SABRSimulator.h"
+#include "BermudanOption.h"
+#include "LSMPricer.h"
+#include <vector>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+
+// Everything that determines an LSM price
+struct PricingKey {
+    double F0, alpha0, beta, nu, rho;
+    double strike;
+    int type;
+    std::vector<double> dates;
+    double r;
+    int polyDegree;
+    int nPaths;
+    int nSteps;
+    unsigned int seed;
+    
+    bool operator==(const PricingKey& other) const;
+};
+
+// Cached pricing result
+struct CacheEntry {
+    double price;
+    double standardError;
+    std::vector<std::vector<double> > exercisePolicy;   // As LSMPricer::getExercisePolicy()
+};
+
+// Memoizing result cache in front of LSMPricer
+// Keys are content hashes (FNV-1a) of every pricing input plus the
+// PRICER_VERSION_TAG, so a new tag never matches old entries. Entries live
+// in an in-memory LRU; with a directory set, they are also written to disk
+// (one file per key, tagged) and disk hits are promoted to memory. Only
+// simulators with an explicit seed are cached: time-seeded prices are not
+// reproducible.
+class PricingCache {
+private:
+    typedef std::pair<PricingKey, CacheEntry> Item;
+    
+    size_t capacity;                 // Max in-memory entries
+    std::string directory;           // Disk tier ("" = memory only)
+    std::list<Item> lru;             // Most recently used first
+    std::unordered_map<unsigned long long, std::vector<std::list<Item>::iterator> > index;
+    std::mutex mtx;
+    long long hits;
+    long long misses;
+    
+    // Disk tier
+    std::string diskPath(unsigned long long hash) const;
+    bool loadFromDisk(unsigned long long hash, const PricingKey& key, CacheEntry& entry) const;
+    void saveToDisk(unsigned long long hash, const PricingKey& key, const CacheEntry& entry) const;
+    
+    // Insert into memory tier (caller holds mtx)
+    void insertLocked(unsigned long long hash, const PricingKey& key, const CacheEntry& entry);
+    
+public:
+    // Constructor: capacity entries in memory, optional disk directory
+    PricingCache(size_t capacity = 1024, const std::string& directory = "");
+    
+    // Destructor
+    ~PricingCache();
+    
+    // Build the key of a pricing (false if the simulator is not seeded,
+    // uses importance sampling or the pricer uses a schedule time grid or
+    // subsampled regression)
+    static bool makeKey(const SABRSimulator& sim, const BermudanOption& option,
+                        const LSMPricer& pricer, int nPaths, PricingKey& key);
+    
+    // Content hash of a key, including PRICER_VERSION_TAG
+    static unsigned long long hashKey(const PricingKey& key);
+    
+    // Look up / store by key
+    // store() rejects invalid entries (returns false, nothing cached)
+    bool lookup(const PricingKey& key, CacheEntry& entry);
+    bool store(const PricingKey& key, const CacheEntry& entry);
+    
+    // Finite, non-negative price and standard error; disk entries that
+    // fail this are ignored too
+    static bool isValidEntry(const CacheEntry& entry);
+    
+    // Read-through pricing: returns the cached price on a hit, otherwise
+    // prices and stores the result if it is valid (a pricing cancelled
+    // through LSMPricer::setControl is not). entry (optional) receives the
+    // full result, including standard error and exercise policy.
+    double price(LSMPricer& pricer, SABRSimulator& sim, BermudanOption& option, int nPaths,
+                 CacheEntry* entry = 0);
+    
+    // Statistics
+    long long getHits() const { return hits; }
+    long long getMisses() const { return misses; }
+    size_t size() const { return lru.size(); }
+    
+    // Drop all in-memory entries (disk files are kept)
+    void clear();
+};
+
+#endif
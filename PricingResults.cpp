@@ -1,4 +1,5 @@
 #include "PricingResults.h"
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -8,6 +9,7 @@
 PricingResults::PricingResults() {
     optionPrice = 0.0;
     standardError = 0.0;
+    hasDiagnostics = false;
 }
 
 // Destructor
@@ -36,6 +38,12 @@ void PricingResults::setExerciseBoundary(const std::vector<double>& boundary) {
     exerciseBoundary = boundary;
 }
 
+// Set instrumentation
+void PricingResults::setDiagnostics(const PricingDiagnostics& diag) {
+    diagnostics = diag;
+    hasDiagnostics = true;
+}
+
 // Display results to console
 void PricingResults::display() const {
     std::cout << std::fixed << std::setprecision(4);
@@ -58,6 +66,44 @@ void PricingResults::display() const {
                      << convergenceErrors[i] << std::endl;
         }
     }
+    
+    if (!exerciseBoundary.empty()) {
+        std::cout << "\nExercise Boundary (critical F per exercise date):" << std::endl;
+        for (size_t m = 0; m < exerciseBoundary.size(); m++) {
+            std::cout << "Date " << m << ":\t";
+            if (std::isnan(exerciseBoundary[m])) {
+                std::cout << "never exercised" << std::endl;
+            } else {
+                std::cout << exerciseBoundary[m] << std::endl;
+            }
+        }
+    }
+    
+    if (hasDiagnostics) {
+        const PhaseStats* phases[] = {&diagnostics.simulation, &diagnostics.itmScan,
+                                      &diagnostics.regression, &diagnostics.exerciseDecision,
+                                      &diagnostics.reduction};
+        const char* names[] = {"Simulation", "ITM scan", "Regression", "Exercise", "Reduction"};
+        std::cout << "\nPhase Timings:" << std::endl;
+        std::cout << "Phase\t\tWall (ms)\tCPU (ms)\tAllocs" << std::endl;
+        for (int k = 0; k < 5; k++) {
+            std::cout << names[k] << "\t"
+                      << 1e3 * phases[k]->wallSeconds << "\t\t"
+                      << 1e3 * phases[k]->cpuSeconds << "\t\t"
+                      << phases[k]->allocations << std::endl;
+        }
+        std::cout << "Paths/sec: " << std::setprecision(0) << diagnostics.pathsPerSecond
+                  << std::setprecision(4) << std::endl;
+        if (!diagnostics.nItm.empty()) {
+            std::cout << "Date\tITM fraction\tFit points\tCondition" << std::endl;
+            for (size_t m = 0; m < diagnostics.nItm.size(); m++) {
+                std::cout << m << "\t" << diagnostics.itmFraction[m] << "\t\t"
+                          << diagnostics.regressionPoints[m] << "\t\t"
+                          << std::scientific << diagnostics.conditionNumber[m]
+                          << std::fixed << std::endl;
+            }
+        }
+    }
     std::cout << "========================================" << std::endl;
 }
 
@@ -89,3 +135,80 @@ std::string PricingResults::getSummary() const {
     oss << "Price: " << optionPrice << ", StdErr: " << standardError;
     return oss.str();
 }
+
+// JSON helpers
+static void jsonArray(std::ostringstream& oss, const std::vector<double>& v) {
+    oss << "[";
+    for (size_t i = 0; i < v.size(); i++) {
+        oss << (i ? ", " : "");
+        if (std::isfinite(v[i])) {
+            oss << v[i];
+        } else {
+            oss << "null";
+        }
+    }
+    oss << "]";
+}
+
+static void jsonPhase(std::ostringstream& oss, const char* name, const PhaseStats& p) {
+    oss << "    \"" << name << "\": {\"wall_s\": " << p.wallSeconds
+        << ", \"cpu_s\": " << p.cpuSeconds << ", \"calls\": " << p.calls
+        << ", \"allocations\": " << p.allocations << "}";
+}
+
+// JSON dump
+std::string PricingResults::toJSON() const {
+    std::ostringstream oss;
+    oss << std::setprecision(10);
+    oss << "{" << std::endl;
+    oss << "  \"price\": " << optionPrice << "," << std::endl;
+    oss << "  \"standard_error\": " << standardError << "," << std::endl;
+    
+    std::vector<double> nPathsD(convergenceNPaths.begin(), convergenceNPaths.end());
+    oss << "  \"convergence\": {\"n_paths\": ";
+    jsonArray(oss, nPathsD);
+    oss << ", \"prices\": ";
+    jsonArray(oss, convergencePrices);
+    oss << ", \"std_errors\": ";
+    jsonArray(oss, convergenceErrors);
+    oss << "}," << std::endl;
+    oss << "  \"exercise_boundary\": ";
+    jsonArray(oss, exerciseBoundary);
+    
+    if (hasDiagnostics) {
+        oss << "," << std::endl << "  \"diagnostics\": {" << std::endl;
+        oss << "    \"n_paths\": " << diagnostics.nPaths << "," << std::endl;
+        oss << "    \"paths_per_second\": " << diagnostics.pathsPerSecond << "," << std::endl;
+        jsonPhase(oss, "simulation", diagnostics.simulation);
+        oss << "," << std::endl;
+        jsonPhase(oss, "itm_scan", diagnostics.itmScan);
+        oss << "," << std::endl;
+        jsonPhase(oss, "regression", diagnostics.regression);
+        oss << "," << std::endl;
+        jsonPhase(oss, "exercise_decision", diagnostics.exerciseDecision);
+        oss << "," << std::endl;
+        jsonPhase(oss, "reduction", diagnostics.reduction);
+        oss << "," << std::endl;
+        std::vector<double> nItmD(diagnostics.nItm.begin(), diagnostics.nItm.end());
+        oss << "    \"n_itm\": ";
+        jsonArray(oss, nItmD);
+        oss << "," << std::endl << "    \"itm_fraction\": ";
+        jsonArray(oss, diagnostics.itmFraction);
+        oss << "," << std::endl << "    \"condition_number\": ";
+        jsonArray(oss, diagnostics.conditionNumber);
+        std::vector<double> pointsD(diagnostics.regressionPoints.begin(),
+                                    diagnostics.regressionPoints.end());
+        oss << "," << std::endl << "    \"regression_points\": ";
+        jsonArray(oss, pointsD);
+        oss << std::endl << "  }";
+    }
+    oss << std::endl << "}" << std::endl;
+    return oss.str();
+}
+
+// Save JSON
+void PricingResults::saveToJSON(const std::string& filename) const {
+    std::ofstream file(filename);
+    file << toJSON();
+    file.close();
+}
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include "Instrumentation.h"
 
 // Storage for pricing results and diagnostics
 class PricingResults {
@@ -13,6 +14,8 @@ private:
     std::vector<double> convergenceErrors;     // Std errors at different N
     std::vector<int> convergenceNPaths;        // N values tested
     std::vector<double> exerciseBoundary;      // Exercise boundary (optional)
+    PricingDiagnostics diagnostics;            // Instrumentation (optional)
+    bool hasDiagnostics;
     
 public:
     // Constructor
@@ -31,17 +34,25 @@ public:
     // Set exercise boundary
     void setExerciseBoundary(const std::vector<double>& boundary);
     
+    // Set instrumentation (e.g. LSMPricer::getDiagnostics())
+    void setDiagnostics(const PricingDiagnostics& diag);
+    
     // Getters
     double getPrice() const { return optionPrice; }
     double getStandardError() const { return standardError; }
     std::vector<double> getConvergencePrices() const { return convergencePrices; }
     std::vector<double> getConvergenceErrors() const { return convergenceErrors; }
     std::vector<int> getConvergenceNPaths() const { return convergenceNPaths; }
+    const PricingDiagnostics& getDiagnostics() const { return diagnostics; }
     
     // Output methods
     void display() const;
     void saveToFile(const std::string& filename) const;
     std::string getSummary() const;
+    
+    // JSON dump of all results and diagnostics (for regression tracking)
+    std::string toJSON() const;
+    void saveToJSON(const std::string& filename) const;
 };
 
 #endif
@@ -0,0 +1,672 @@
+#include "PricingService.h"
+#include "SABRSimulator.h"
+#include "LSMPricer.h"
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <condition_variable>
+#include <exception>
+#include <unistd.h>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Latency samples kept for percentiles
+const size_t MAX_LATENCY_SAMPLES = 100000;
+
+// Longest unterminated request line buffered by serve()
+const size_t MAX_REQUEST_LINE = 65536;
+
+// Request size limits: paths, and F plus alpha doubles of the simulation
+// (2 GiB), so one request cannot exhaust the service's memory
+const long long MAX_REQUEST_PATHS = 10000000;
+const long long MAX_REQUEST_DOUBLES = 1LL << 28;
+const int MAX_REQUEST_DEGREE = 10;
+
+// Largest workspace kept warm between requests (doubles, 256 MiB)
+const size_t MAX_WARM_DOUBLES = static_cast<size_t>(1) << 25;
+
+// Constructor
+PricingService::PricingService(int nThreads, size_t cacheCapacity, const std::string& cacheDirectory)
+    : pool(nThreads), cache(cacheCapacity, cacheDirectory) {
+    startTime = std::chrono::steady_clock::now();
+    nRequests = 0;
+    nBatches = 0;
+    nSimulations = 0;
+    latencyNext = 0;
+    nConnections = 0;
+}
+
+// Destructor
+PricingService::~PricingService() {
+    for (size_t i = 0; i < freeWorkspaces.size(); i++) {
+        freeWorkspace(freeWorkspaces[i]);
+    }
+    for (size_t i = 0; i < pathFiles.size(); i++) {
+        delete pathFiles[i];
+    }
+}
+
+// Map a path file
+bool PricingService::addPathFile(const std::string& filename) {
+    MappedPaths* paths = new MappedPaths();
+    if (!paths->open(filename)) {
+        delete paths;
+        return false;
+    }
+    pathFiles.push_back(paths);
+    return true;
+}
+
+// Whole-string integer in [lo, hi]; false on junk, overflow or out of range
+// (checked on the long long before any narrowing cast)
+static bool parseInteger(const char* v, long long lo, long long hi, long long& out) {
+    char* end = 0;
+    errno = 0;
+    long long x = strtoll(v, &end, 10);
+    if (end == v || *end != '\0' || errno == ERANGE || x < lo || x > hi) {
+        return false;
+    }
+    out = x;
+    return true;
+}
+
+// Parse "key=value key=value ..."
+bool PricingService::parseRequest(const std::string& line, PricingRequest& req, std::string& error) {
+    // Baseline defaults (main.cpp)
+    req.id = "?";
+    req.F0 = 100.0;
+    req.alpha0 = 0.20;
+    req.beta = 0.5;
+    req.nu = 0.4;
+    req.rho = -0.3;
+    req.strike = 100.0;
+    req.type = CALL;
+    req.dates.clear();
+    req.r = 0.05;
+    req.nPaths = 10000;
+    req.seed = 12345;
+    req.polyDegree = 3;
+    
+    std::istringstream in(line);
+    std::string token;
+    while (in >> token) {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos) {
+            error = "expected key=value, got '" + token + "'";
+            return false;
+        }
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+        const char* v = value.c_str();
+        
+        if (key == "id") req.id = value;
+        else if (key == "F0") req.F0 = atof(v);
+        else if (key == "alpha0") req.alpha0 = atof(v);
+        else if (key == "beta") req.beta = atof(v);
+        else if (key == "nu") req.nu = atof(v);
+        else if (key == "rho") req.rho = atof(v);
+        else if (key == "K") req.strike = atof(v);
+        else if (key == "r") req.r = atof(v);
+        else if (key == "paths" || key == "seed" || key == "degree") {
+            long long x = 0;
+            if (key == "paths" && !parseInteger(v, 1, MAX_REQUEST_PATHS, x)) {
+                error = "paths must be in [1, 10000000]";
+                return false;
+            }
+            if (key == "seed" && !parseInteger(v, 0, UINT_MAX, x)) {
+                error = "seed must be in [0, 4294967295]";
+                return false;
+            }
+            if (key == "degree" && !parseInteger(v, 0, MAX_REQUEST_DEGREE, x)) {
+                error = "degree must be in [0, 10]";
+                return false;
+            }
+            if (key == "paths") req.nPaths = static_cast<int>(x);
+            else if (key == "seed") req.seed = static_cast<unsigned int>(x);
+            else req.polyDegree = static_cast<int>(x);
+        } else if (key == "type") {
+            if (value == "call") req.type = CALL;
+            else if (value == "put") req.type = PUT;
+            else {
+                error = "type must be call or put";
+                return false;
+            }
+        } else if (key == "dates") {
+            std::istringstream list(value);
+            std::string d;
+            while (std::getline(list, d, ',')) {
+                req.dates.push_back(atof(d.c_str()));
+            }
+        } else {
+            error = "unknown key '" + key + "'";
+            return false;
+        }
+    }
+    
+    if (req.dates.empty()) {
+        req.dates.push_back(0.25);
+        req.dates.push_back(0.5);
+        req.dates.push_back(0.75);
+        req.dates.push_back(1.0);
+    }
+    for (size_t i = 0; i < req.dates.size(); i++) {
+        if (!std::isfinite(req.dates[i]) || req.dates[i] <= 0.0
+            || (i > 0 && req.dates[i] <= req.dates[i - 1])) {
+            error = "dates must be positive and increasing";
+            return false;
+        }
+    }
+    if (req.dates.size() < 2) {
+        error = "need at least two exercise dates";
+        return false;
+    }
+    // Model and contract parameters (NaN fails every comparison)
+    if (!std::isfinite(req.F0) || !(req.F0 > 0.0)
+        || !std::isfinite(req.alpha0) || !(req.alpha0 > 0.0)) {
+        error = "F0 and alpha0 must be positive";
+        return false;
+    }
+    if (!(req.beta >= 0.0 && req.beta <= 1.0)) {
+        error = "beta must be in [0, 1]";
+        return false;
+    }
+    if (!std::isfinite(req.nu) || !(req.nu >= 0.0)) {
+        error = "nu must be non-negative";
+        return false;
+    }
+    if (!(req.rho > -1.0 && req.rho < 1.0)) {
+        error = "rho must be in (-1, 1)";
+        return false;
+    }
+    if (!std::isfinite(req.strike) || !(req.strike > 0.0)) {
+        error = "K must be positive";
+        return false;
+    }
+    if (!std::isfinite(req.r)) {
+        error = "r must be finite";
+        return false;
+    }
+    
+    // Simulation size
+    BermudanOption opt(req.strike, req.dates, req.type);
+    long long doubles = 2LL * req.nPaths * (LSMPricer::simulationSteps(opt) + 1LL);
+    if (doubles > MAX_REQUEST_DOUBLES) {
+        error = "too many paths x steps for one request";
+        return false;
+    }
+    return true;
+}
+
+// Cache key of a request
+PricingKey PricingService::requestKey(const PricingRequest& req) {
+    PricingKey key;
+    key.F0 = req.F0;
+    key.alpha0 = req.alpha0;
+    key.beta = req.beta;
+    key.nu = req.nu;
+    key.rho = req.rho;
+    key.strike = req.strike;
+    key.type = static_cast<int>(req.type);
+    key.dates = req.dates;
+    key.r = req.r;
+    key.polyDegree = req.polyDegree;
+    key.nPaths = req.nPaths;
+    BermudanOption opt(req.strike, req.dates, req.type);
+    key.nSteps = LSMPricer::simulationSteps(opt);
+    key.seed = req.seed;
+    return key;
+}
+
+// Response line of a priced request
+static std::string formatResponse(const std::string& id, const CacheEntry& entry, bool cached) {
+    std::ostringstream oss;
+    oss << std::setprecision(10) << "id=" << id << " price=" << entry.price
+        << " stderr=" << entry.standardError;
+    if (cached) {
+        oss << " cached=1";
+    }
+    return oss.str();
+}
+
+// Get a workspace with room for nPaths x (nSteps+1), reusing warm buffers
+PathWorkspace* PricingService::acquireWorkspace(int nPaths, int nSteps) {
+    PathWorkspace* ws = 0;
+    {
+        std::unique_lock<std::mutex> lock(workspaceMutex);
+        if (!freeWorkspaces.empty()) {
+            ws = freeWorkspaces.back();
+            freeWorkspaces.pop_back();
+        }
+    }
+    if (ws == 0) {
+        ws = new PathWorkspace();
+        ws->F_paths = 0;
+        ws->alpha_paths = 0;
+        ws->block = 0;
+        ws->blockCapacity = 0;
+        ws->rowCapacity = 0;
+    }
+    
+    // Grow each buffer to this request only (never to the larger of two
+    // requests' path and step counts)
+    size_t row = static_cast<size_t>(nSteps) + 1;
+    size_t needed = 2 * static_cast<size_t>(nPaths) * row;
+    try {
+        if (needed > ws->blockCapacity) {
+            delete[] ws->block;
+            ws->block = 0;
+            ws->blockCapacity = 0;
+            ws->block = new double[needed];
+            ws->blockCapacity = needed;
+        }
+        if (nPaths > ws->rowCapacity) {
+            delete[] ws->F_paths;
+            delete[] ws->alpha_paths;
+            ws->F_paths = 0;
+            ws->alpha_paths = 0;
+            ws->rowCapacity = 0;
+            ws->F_paths = new double*[nPaths];
+            ws->alpha_paths = new double*[nPaths];
+            ws->rowCapacity = nPaths;
+        }
+    } catch (...) {
+        // Drop the workspace (fields are nulled before each allocation);
+        // the next request starts a fresh one
+        freeWorkspace(ws);
+        throw;
+    }
+    for (int i = 0; i < nPaths; i++) {
+        ws->F_paths[i] = ws->block + (2 * static_cast<size_t>(i)) * row;
+        ws->alpha_paths[i] = ws->block + (2 * static_cast<size_t>(i) + 1) * row;
+    }
+    return ws;
+}
+
+// Return a workspace to the warm pool (oversized ones are freed)
+void PricingService::releaseWorkspace(PathWorkspace* ws) {
+    if (ws->blockCapacity > MAX_WARM_DOUBLES) {
+        freeWorkspace(ws);
+        return;
+    }
+    std::unique_lock<std::mutex> lock(workspaceMutex);
+    freeWorkspaces.push_back(ws);
+}
+
+// Free a workspace and its buffers
+void PricingService::freeWorkspace(PathWorkspace* ws) {
+    delete[] ws->F_paths;
+    delete[] ws->alpha_paths;
+    delete[] ws->block;
+    delete ws;
+}
+
+// Workspace held by one group task, returned to the pool on every exit
+class WorkspaceLease {
+private:
+    std::function<void(PathWorkspace*)> release;
+    PathWorkspace* ws;
+    
+public:
+    // Constructor
+    WorkspaceLease(const std::function<void(PathWorkspace*)>& release)
+        : release(release), ws(0) {}
+    
+    // Destructor
+    ~WorkspaceLease() {
+        if (ws != 0) {
+            release(ws);
+        }
+    }
+    
+    void hold(PathWorkspace* workspace) { ws = workspace; }
+    PathWorkspace* get() const { return ws; }
+};
+
+// Record latency sample
+void PricingService::recordLatency(double micros) {
+    std::unique_lock<std::mutex> lock(statsMutex);
+    nRequests++;
+    if (latencies.size() < MAX_LATENCY_SAMPLES) {
+        latencies.push_back(micros);
+    } else {
+        latencies[latencyNext] = micros;
+        latencyNext = (latencyNext + 1) % MAX_LATENCY_SAMPLES;
+    }
+}
+
+// Price one group of compatible requests on a shared simulation
+void PricingService::priceGroup(const std::vector<size_t>& members, const PricingRequest* req,
+                                CacheEntry* out) {
+    const PricingRequest& first = req[members[0]];
+    BermudanOption firstOpt(first.strike, first.dates, first.type);
+    int totalSteps = LSMPricer::simulationSteps(firstOpt);
+    double T = first.dates.back();
+    
+    // Mapped path file if one matches, else simulate into a warm workspace
+    SABRParameters params;
+    params.F0 = first.F0;
+    params.alpha0 = first.alpha0;
+    params.beta = first.beta;
+    params.nu = first.nu;
+    params.rho = first.rho;
+    const MappedPaths* mapped = 0;
+    for (size_t f = 0; f < pathFiles.size() && mapped == 0; f++) {
+        if (pathFiles[f]->matches(params, first.seed, totalSteps, T)
+            && pathFiles[f]->getNPaths() >= first.nPaths) {
+            mapped = pathFiles[f];
+        }
+    }
+    
+    WorkspaceLease lease([this](PathWorkspace* ws) { releaseWorkspace(ws); });
+    const double* const* F_paths;
+    const double* const* alpha_paths;
+    if (mapped != 0) {
+        F_paths = mapped->getFPaths();
+        alpha_paths = mapped->getAlphaPaths();
+    } else {
+        lease.hold(acquireWorkspace(first.nPaths, totalSteps));
+        PathWorkspace* ws = lease.get();
+        SABRSimulator sim(params, first.seed);
+        sim.simulatePaths(first.nPaths, totalSteps, T, ws->F_paths, ws->alpha_paths);
+        {
+            std::unique_lock<std::mutex> lock(statsMutex);
+            nSimulations++;
+        }
+        F_paths = ws->F_paths;
+        alpha_paths = ws->alpha_paths;
+    }
+    
+    LSMPricer pricer;
+    pricer.setVerbose(false);
+    for (size_t k = 0; k < members.size(); k++) {
+        const PricingRequest& q = req[members[k]];
+        BermudanOption opt(q.strike, q.dates, q.type);
+        pricer.setDiscountRate(q.r);
+        pricer.setPolynomialDegree(q.polyDegree);
+        CacheEntry& entry = out[members[k]];
+        entry.price = pricer.priceFromPaths(F_paths, alpha_paths, q.nPaths,
+                                            totalSteps, T, opt);
+        entry.standardError = pricer.getStandardError();
+        entry.exercisePolicy = pricer.getExercisePolicy();
+    }
+}
+
+// Price a batch
+std::vector<std::string> PricingService::processBatch(const std::vector<std::string>& lines) {
+    std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now();
+    std::vector<std::string> responses(lines.size());
+    std::vector<PricingRequest> requests(lines.size());
+    
+    // Parse and group compatible requests: same model, seed, paths and time grid
+    typedef std::vector<double> GroupKey;
+    std::map<GroupKey, std::vector<size_t> > groups;
+    std::vector<size_t> priced;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (lines[i] == "stats") {
+            responses[i] = statsLine();
+            continue;
+        }
+        std::string error;
+        if (!parseRequest(lines[i], requests[i], error)) {
+            responses[i] = "id=" + requests[i].id + " error=" + error;
+            continue;
+        }
+        const PricingRequest& q = requests[i];
+        CacheEntry hit;
+        if (cache.lookup(requestKey(q), hit)) {
+            responses[i] = formatResponse(q.id, hit, true);
+            priced.push_back(i);
+            continue;
+        }
+        BermudanOption opt(q.strike, q.dates, q.type);
+        GroupKey key;
+        key.push_back(q.F0);
+        key.push_back(q.alpha0);
+        key.push_back(q.beta);
+        key.push_back(q.nu);
+        key.push_back(q.rho);
+        key.push_back(q.nPaths);
+        key.push_back(q.seed);
+        key.push_back(q.dates.back());
+        key.push_back(LSMPricer::simulationSteps(opt));
+        groups[key].push_back(i);
+        priced.push_back(i);
+    }
+    std::vector<CacheEntry> entries(lines.size());
+    std::vector<std::string> errors(lines.size());   // Non-empty: pricing failed
+    
+    std::map<GroupKey, std::vector<size_t> >::const_iterator it;
+    PricingRequest* req = requests.empty() ? 0 : &requests[0];
+    CacheEntry* out = entries.empty() ? 0 : &entries[0];
+    std::string* failed = errors.empty() ? 0 : &errors[0];
+    
+    // Completion of this batch's groups only (batches of other connections
+    // share the pool)
+    std::mutex doneMutex;
+    std::condition_variable allGroupsDone;
+    size_t remaining = groups.size();
+    for (it = groups.begin(); it != groups.end(); ++it) {
+        const std::vector<size_t>* members = &it->second;
+        pool.submit([this, members, req, out, failed, &doneMutex, &allGroupsDone, &remaining]() {
+            // A failing group (e.g. out of memory) answers its members with
+            // an error; the exception must not reach the pool and end the service
+            try {
+                priceGroup(*members, req, out);
+            } catch (const std::exception& e) {
+                for (size_t k = 0; k < members->size(); k++) {
+                    failed[(*members)[k]] = std::string("pricing failed (") + e.what() + ")";
+                }
+            } catch (...) {
+                for (size_t k = 0; k < members->size(); k++) {
+                    failed[(*members)[k]] = "pricing failed";
+                }
+            }
+            // Notify under the lock: the batch returns (and destroys the
+            // condition variable) as soon as it sees remaining == 0
+            std::unique_lock<std::mutex> lock(doneMutex);
+            remaining--;
+            allGroupsDone.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        allGroupsDone.wait(lock, [&remaining]() { return remaining == 0; });
+    }
+    
+    for (it = groups.begin(); it != groups.end(); ++it) {
+        for (size_t k = 0; k < it->second.size(); k++) {
+            size_t i = it->second[k];
+            if (!errors[i].empty()) {
+                responses[i] = "id=" + requests[i].id + " error=" + errors[i];
+                continue;
+            }
+            cache.store(requestKey(requests[i]), entries[i]);
+            responses[i] = formatResponse(requests[i].id, entries[i], false);
+        }
+    }
+    
+    double micros = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - received).count();
+    for (size_t k = 0; k < priced.size(); k++) {
+        recordLatency(micros);
+    }
+    {
+        std::unique_lock<std::mutex> lock(statsMutex);
+        nBatches++;
+    }
+    return responses;
+}
+
+// Write all bytes
+static bool writeAll(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Serve a byte stream: each read() that completes lines forms one batch
+void PricingService::serve(int inFd, int outFd) {
+    std::string pending;
+    char buffer[65536];
+    bool discarding = false;   // Skipping the rest of an over-long line
+    
+    while (true) {
+        ssize_t n = read(inFd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+        pending.append(buffer, static_cast<size_t>(n));
+        if (discarding) {
+            size_t nl = pending.find('\n');
+            if (nl == std::string::npos) {
+                pending.clear();
+                continue;
+            }
+            pending.erase(0, nl + 1);
+            discarding = false;
+        }
+        
+        std::vector<std::string> lines;
+        size_t start = 0, nl;
+        while ((nl = pending.find('\n', start)) != std::string::npos) {
+            std::string line = pending.substr(start, nl - start);
+            if (!line.empty() && line[line.size() - 1] == '\r') {
+                line.erase(line.size() - 1);
+            }
+            if (!line.empty()) {
+                lines.push_back(line);
+            }
+            start = nl + 1;
+        }
+        pending.erase(0, start);
+        
+        // An unterminated line may not grow without bound: answer it with
+        // an error and drop input up to its newline
+        std::string overflow;
+        if (pending.size() > MAX_REQUEST_LINE) {
+            pending.clear();
+            discarding = true;
+            overflow = "id=? error=request line longer than 65536 bytes\n";
+        }
+        if (lines.empty() && overflow.empty()) {
+            continue;
+        }
+        
+        std::vector<std::string> responses;
+        if (!lines.empty()) {
+            responses = processBatch(lines);
+        }
+        std::string reply;
+        for (size_t i = 0; i < responses.size(); i++) {
+            reply += responses[i];
+            reply += '\n';
+        }
+        reply += overflow;
+        if (!writeAll(outFd, reply)) {
+            break;
+        }
+    }
+    
+    // Unterminated last line
+    if (!pending.empty()) {
+        std::vector<std::string> last(1, pending);
+        std::vector<std::string> responses = processBatch(last);
+        writeAll(outFd, responses[0] + "\n");
+    }
+}
+
+// Unix domain socket server
+int PricingService::serveSocket(const std::string& path) {
+    // A client that disconnects before its reply fails the write (ending
+    // its connection) instead of raising SIGPIPE for the whole process
+    signal(SIGPIPE, SIG_IGN);
+    
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        return 1;
+    }
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        close(listenFd);
+        return 1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+        || listen(listenFd, 16) != 0) {
+        close(listenFd);
+        return 1;
+    }
+    
+    // One thread per connection; every connection's batches go to the
+    // shared pool and cache, so an idle client does not hold up others
+    while (true) {
+        int conn = accept(listenFd, 0, 0);
+        if (conn < 0) {
+            break;
+        }
+        {
+            std::unique_lock<std::mutex> lock(connectionMutex);
+            nConnections++;
+        }
+        std::thread([this, conn]() {
+            serve(conn, conn);
+            close(conn);
+            std::unique_lock<std::mutex> lock(connectionMutex);
+            nConnections--;
+            connectionsClosed.notify_all();
+        }).detach();
+    }
+    {
+        std::unique_lock<std::mutex> lock(connectionMutex);
+        connectionsClosed.wait(lock, [this]() { return nConnections == 0; });
+    }
+    close(listenFd);
+    unlink(path.c_str());
+    return 0;
+}
+
+// Metrics
+std::string PricingService::statsLine() {
+    std::unique_lock<std::mutex> lock(statsMutex);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::vector<double> sorted(latencies);
+    std::sort(sorted.begin(), sorted.end());
+    
+    double p50 = 0.0, p90 = 0.0, p99 = 0.0, maxLatency = 0.0;
+    if (!sorted.empty()) {
+        size_t n = sorted.size();
+        p50 = sorted[std::min(n - 1, n * 50 / 100)];
+        p90 = sorted[std::min(n - 1, n * 90 / 100)];
+        p99 = sorted[std::min(n - 1, n * 99 / 100)];
+        maxLatency = sorted[n - 1];
+    }
+    
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "stats requests=" << nRequests << " batches=" << nBatches
+        << " simulations=" << nSimulations
+        << " cache_hits=" << cache.getHits() << " cache_misses=" << cache.getMisses()
+        << " uptime_s=" << seconds
+        << " throughput_rps=" << (seconds > 0.0 ? nRequests / seconds : 0.0)
+        << " p50_us=" << p50 << " p90_us=" << p90 << " p99_us=" << p99
+        << " max_us=" << maxLatency;
+    return oss.str();
+}
@@ -0,0 +1,132 @@
+#ifndef PRICINGSERVICE_H
+#define PRICINGSERVICE_H
+
+#include "BermudanOption.h"
+#include "ThreadPool.h"
+#include "PricingCache.h"
+#include "PathFile.h"
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+// One pricing request
+// Wire format: one line of space-separated key=value pairs, e.g.
+//   id=7 F0=100 alpha0=0.2 beta=0.5 nu=0.4 rho=-0.3 K=100 type=call
+//   dates=0.25,0.5,0.75,1 r=0.05 paths=10000 seed=12345 degree=3
+// Omitted keys take the baseline values of main.cpp. The line "stats"
+// returns service metrics instead of a price.
+struct PricingRequest {
+    std::string id;
+    double F0, alpha0, beta, nu, rho;
+    double strike;
+    OptionType type;
+    std::vector<double> dates;
+    double r;
+    int nPaths;
+    unsigned int seed;
+    int polyDegree;
+};
+
+// Reusable path buffers (one contiguous block, row pointers into it)
+// The block and the row pointer arrays are sized independently; the rows
+// are re-sliced for every request's nPaths x (nSteps+1)
+struct PathWorkspace {
+    double** F_paths;
+    double** alpha_paths;
+    double* block;
+    size_t blockCapacity;   // Doubles in block
+    int rowCapacity;        // Entries in F_paths and alpha_paths
+};
+
+// Long-lived batch pricing service
+// Keeps the thread pool and path workspaces alive across requests. Every
+// chunk of input that arrives together is one batch; within a batch,
+// requests with the same model, seed, path count and time grid (e.g. a
+// strike ladder or different dates on one underlying) share a single
+// simulation. Requests already in the PricingCache are answered without
+// pricing. Throughput, latency percentiles and cache hits are reported by
+// "stats".
+class PricingService {
+private:
+    ThreadPool pool;
+    PricingCache cache;
+    std::vector<PathWorkspace*> freeWorkspaces;   // Warm buffers not in use
+    std::mutex workspaceMutex;
+    std::vector<MappedPaths*> pathFiles;          // Pre-simulated path sets
+    
+    // Open socket connections (serveSocket)
+    std::mutex connectionMutex;
+    std::condition_variable connectionsClosed;
+    int nConnections;
+    
+    // Metrics
+    std::mutex statsMutex;
+    std::chrono::steady_clock::time_point startTime;
+    long long nRequests;
+    long long nBatches;
+    long long nSimulations;
+    std::vector<double> latencies;    // Last latencies in microseconds (ring)
+    size_t latencyNext;
+    
+    // Workspace pool: a workspace grows to the request it serves (at most
+    // the 2^28 doubles parseRequest allows); on release, one holding more
+    // than MAX_WARM_DOUBLES is freed instead of kept warm
+    PathWorkspace* acquireWorkspace(int nPaths, int nSteps);
+    void releaseWorkspace(PathWorkspace* ws);
+    static void freeWorkspace(PathWorkspace* ws);
+    
+    // Price one group of compatible requests (indices into req) on a shared
+    // simulation, filling out; throws on failure (e.g. std::bad_alloc)
+    void priceGroup(const std::vector<size_t>& members, const PricingRequest* req,
+                    CacheEntry* out);
+    
+    // Record one completed request
+    void recordLatency(double micros);
+    
+public:
+    // Constructor: nThreads <= 0 uses the hardware concurrency; results are
+    // cached in memory (cacheCapacity entries) and in cacheDirectory if set
+    PricingService(int nThreads = 0, size_t cacheCapacity = 1024,
+                   const std::string& cacheDirectory = "");
+    
+    // Destructor
+    ~PricingService();
+    
+    // Map a pre-simulated path file; groups whose model, seed and grid match
+    // it (and need at most its path count) are priced from the mapping
+    // instead of simulating. Returns false if the file cannot be mapped.
+    bool addPathFile(const std::string& filename);
+    
+    // Parse a request line; false (with error set) if malformed or out of
+    // range: F0, alpha0, K > 0, nu >= 0, beta in [0, 1], |rho| < 1, all
+    // finite; paths in [1, 10^7], degree in [0, 10] and seed in [0, 2^32)
+    // as whole decimal integers; at most 2^28 doubles of simulated paths
+    // (2 GiB)
+    static bool parseRequest(const std::string& line, PricingRequest& req, std::string& error);
+    
+    // Cache key of a request
+    static PricingKey requestKey(const PricingRequest& req);
+    
+    // Price a batch of request lines; one response line per input line
+    // Response: "id=<id> price=<p> stderr=<e>" (plus " cached=1" on a cache
+    // hit) or "id=<id> error=<msg>". Safe to call from several threads at once
+    std::vector<std::string> processBatch(const std::vector<std::string>& lines);
+    
+    // Serve newline-delimited requests from inFd, writing responses to outFd,
+    // until end of input; a line longer than 64 KiB is answered with an
+    // error and skipped
+    void serve(int inFd, int outFd);
+    
+    // Listen on a Unix domain socket and serve each connection on its own
+    // thread; all connections share the pool, workspaces and cache, and
+    // processBatch waits only for its own groups. Returns non-zero if the
+    // socket cannot be set up
+    int serveSocket(const std::string& path);
+    
+    // Metrics line: requests, batches, simulations, throughput and latency percentiles
+    std::string statsLine();
+};
+
+#endif
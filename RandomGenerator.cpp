@@ -1,21 +1,32 @@
 #include "RandomGenerator.h"
+#include "VectorMath.h"
+#include <algorithm>
 
 const double PI = 3.14159265358979323846;
 
+// SplitMix64 constants
+const unsigned long long GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+
+// SplitMix64 finalizer: bijective 64-bit mix
+static unsigned long long mix64(unsigned long long z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// 53 random bits to [0, 1)
+static double toUniform(unsigned long long bits) {
+    return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
 // Default constructor: seed with current time
 RandomGenerator::RandomGenerator() {
-    seed = static_cast<unsigned int>(time(0));
-    srand(seed);
-    hasSpare = false;
-    spare = 0.0;
+    setStream(static_cast<unsigned int>(time(0)), 0);
 }
 
 // Constructor with custom seed
 RandomGenerator::RandomGenerator(unsigned int customSeed) {
-    seed = customSeed;
-    srand(seed);
-    hasSpare = false;
-    spare = 0.0;
+    setStream(customSeed, 0);
 }
 
 // Destructor
@@ -23,9 +34,24 @@ RandomGenerator::~RandomGenerator() {
     // Nothing to clean up
 }
 
-// Generate uniform random number in [0, 1]
+// Position the generator at the start of substream streamId
+// Distinct (seed, streamId) pairs start at unrelated points of the 2^64 cycle
+void RandomGenerator::setStream(unsigned int customSeed, unsigned long long streamId) {
+    seed = customSeed;
+    state = mix64(mix64(static_cast<unsigned long long>(customSeed) + GOLDEN_GAMMA) ^ streamId);
+    hasSpare = false;
+    spare = 0.0;
+}
+
+// SplitMix64 step
+unsigned long long RandomGenerator::nextBits() {
+    state += GOLDEN_GAMMA;
+    return mix64(state);
+}
+
+// Generate uniform random number in [0, 1) with 53 random bits
 double RandomGenerator::generateUniform() {
-    return static_cast<double>(rand()) / static_cast<double>(RAND_MAX);
+    return toUniform(nextBits());
 }
 
 // Box-Muller transform to generate standard normal
@@ -47,11 +73,13 @@ double RandomGenerator::generateNormal() {
     u2 = generateUniform();
     
     // Box-Muller transformation
-    double r = sqrt(-2.0 * log(u1));
+    double r = VectorMath::sqrt(-2.0 * VectorMath::log(u1));
     double theta = 2.0 * PI * u2;
+    double sinTheta, cosTheta;
+    VectorMath::sincos(theta, sinTheta, cosTheta);
     
-    spare = r * sin(theta);
-    return r * cos(theta);
+    spare = r * sinTheta;
+    return r * cosTheta;
 }
 
 // Generate correlated pair (Z1, Z2) with correlation rho
@@ -62,3 +90,37 @@ void RandomGenerator::generateCorrelatedNormals(double rho, double& Z1, double&
     
     Z2 = rho * Z1 + sqrt(1.0 - rho * rho) * Z3;
 }
+
+// Box-Muller across streams, 256 at a time: uniforms per stream, then
+// log, sqrt and sincos over the whole chunk
+void RandomGenerator::generateNormalPairs(unsigned long long* positions, int n,
+                                          double* Z1, double* Z3) {
+    const int chunk = 256;
+    double u1[chunk];
+    double theta[chunk];
+    double r[chunk];
+    
+    for (int start = 0; start < n; start += chunk) {
+        int m = std::min(chunk, n - start);
+        for (int k = 0; k < m; k++) {
+            unsigned long long& state = positions[start + k];
+            do {
+                state += GOLDEN_GAMMA;
+                u1[k] = toUniform(mix64(state));
+            } while (u1[k] == 0.0);
+            state += GOLDEN_GAMMA;
+            theta[k] = 2.0 * PI * toUniform(mix64(state));
+        }
+        
+        VectorMath::log(u1, r, m);
+        for (int k = 0; k < m; k++) {
+            r[k] = -2.0 * r[k];
+        }
+        VectorMath::sqrt(r, r, m);
+        VectorMath::sincos(theta, Z3 + start, Z1 + start, m);
+        for (int k = 0; k < m; k++) {
+            Z1[start + k] = r[k] * Z1[start + k];
+            Z3[start + k] = r[k] * Z3[start + k];
+        }
+    }
+}
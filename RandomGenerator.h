@@ -7,12 +7,22 @@
 
 // Random number generator for Monte Carlo simulation
 // Implements Box-Muller algorithm for normal random variables
+// (log, sqrt and sincos from VectorMath)
+//
+// Uniforms come from a SplitMix64 counter owned by each instance (no global
+// rand() state), so generators are independent across threads and a stream
+// can be re-positioned with setStream(seed, streamId): the same (seed, id)
+// pair always replays the same sequence (common random numbers).
 class RandomGenerator {
 private:
     unsigned int seed;
+    unsigned long long state;  // SplitMix64 counter
     bool hasSpare;         // For Box-Muller optimization
     double spare;          // Cached normal random variable
     
+    // Advance the counter and return the next 64-bit output
+    unsigned long long nextBits();
+    
 public:
     // Constructor: initializes with time-based seed
     RandomGenerator();
@@ -23,7 +33,21 @@ public:
     // Destructor
     ~RandomGenerator();
     
-    // Generate uniform random number in [0, 1]
+    // Restart on substream streamId of the given seed
+    // (e.g. one substream per Monte Carlo path)
+    void setStream(unsigned int customSeed, unsigned long long streamId);
+    
+    // Get seed used for the current stream
+    unsigned int getSeed() const { return seed; }
+    
+    // Position in the stream, valid between pairs of normals (after an
+    // even number of generateNormal calls, e.g. between simulation steps):
+    // restoring it resumes the sequence exactly, so a path can be
+    // regenerated from a saved position instead of being stored
+    unsigned long long getPosition() const { return state; }
+    void setPosition(unsigned long long position) { state = position; hasSpare = false; }
+    
+    // Generate uniform random number in [0, 1)
     double generateUniform();
     
     // Generate standard normal random variable (mean=0, std=1)
@@ -34,6 +58,12 @@ public:
     // Z2 = rho * Z1 + sqrt(1-rho^2) * Z3
     // where Z1, Z3 are independent standard normals
     void generateCorrelatedNormals(double rho, double& Z1, double& Z2);
+    
+    // One Box-Muller pair from each of n streams at once
+    // positions[i] (getPosition of stream i, between pairs) advances by one
+    // pair; Z1[i], Z3[i] are the two normals generateNormal returns from
+    // there, bit for bit. The transcendentals run on the vector kernels.
+    static void generateNormalPairs(unsigned long long* positions, int n, double* Z1, double* Z3);
 };
 
 #endif
@@ -0,0 +1,237 @@
+#include "SABRCalibrator.h"
+#include <cmath>
+#include <algorithm>
+
+// Constructor
+SABRCalibrator::SABRCalibrator(double beta, int maxIterations, double tolerance) {
+    this->beta = beta;
+    this->maxIterations = maxIterations;
+    this->tolerance = tolerance;
+}
+
+// Destructor
+SABRCalibrator::~SABRCalibrator() {
+    // Nothing to clean up
+}
+
+// Hagan et al. lognormal implied vol:
+// sigma = A * q(z) * B with
+//   A = alpha / ((FK)^((1-b)/2) * (1 + (1-b)^2/24 L^2 + (1-b)^4/1920 L^4)),  L = ln(F/K)
+//   z = nu/alpha * (FK)^((1-b)/2) * L,  q = z / x(z),
+//   x = ln((sqrt(1 - 2 rho z + z^2) + z - rho) / (1 - rho))
+//   B = 1 + T * ((1-b)^2/24 alpha^2/(FK)^(1-b) + rho b nu alpha/(4 (FK)^((1-b)/2)) + (2-3rho^2)/24 nu^2)
+double SABRCalibrator::impliedVol(double F, double K, double T, double alpha, double beta,
+                                  double rho, double nu, double* gradient) {
+    double omb = 1.0 - beta;
+    double L = log(F / K);
+    double FKpow = pow(F * K, 0.5 * omb);      // (FK)^((1-b)/2)
+    double L2 = L * L;
+    double D = FKpow * (1.0 + omb * omb / 24.0 * L2 + omb * omb * omb * omb / 1920.0 * L2 * L2);
+    double A = alpha / D;
+    
+    // q(z) = z / x(z) and its partials (series expansion near z = 0)
+    double zPerNu = FKpow * L / alpha;         // z / nu
+    double z = nu * zPerNu;
+    double q, dq_dz, dq_drho;
+    if (fabs(z) < 1e-7) {
+        q = 1.0 - 0.5 * rho * z;
+        dq_dz = -0.5 * rho;
+        dq_drho = -0.5 * z;
+    } else {
+        double s = sqrt(1.0 - 2.0 * rho * z + z * z);
+        double x = log((s + z - rho) / (1.0 - rho));
+        q = z / x;
+        double dx_dz = 1.0 / s;
+        double dx_drho = (-z / s - 1.0) / (s + z - rho) + 1.0 / (1.0 - rho);
+        dq_dz = (x - z * dx_dz) / (x * x);
+        dq_drho = -z * dx_drho / (x * x);
+    }
+    
+    double b1 = omb * omb / 24.0 / (FKpow * FKpow);
+    double b2 = beta / (4.0 * FKpow);
+    double b3 = (2.0 - 3.0 * rho * rho) / 24.0;
+    double B = 1.0 + T * (b1 * alpha * alpha + b2 * rho * nu * alpha + b3 * nu * nu);
+    
+    if (gradient != 0) {
+        double dB_dalpha = T * (2.0 * b1 * alpha + b2 * rho * nu);
+        double dB_drho = T * (b2 * nu * alpha - 0.25 * rho * nu * nu);
+        double dB_dnu = T * (b2 * rho * alpha + 2.0 * b3 * nu);
+        double dz_dalpha = -z / alpha;
+        
+        gradient[0] = q * B / D + A * dq_dz * dz_dalpha * B + A * q * dB_dalpha;
+        gradient[1] = A * dq_drho * B + A * q * dB_drho;
+        gradient[2] = A * dq_dz * zPerNu * B + A * q * dB_dnu;
+    }
+    
+    return A * q * B;
+}
+
+// Solve 3x3 system M x = b (Gaussian elimination with partial pivoting)
+static bool solve3(double M[3][3], double b[3], double x[3]) {
+    int perm[3] = {0, 1, 2};
+    for (int k = 0; k < 3; k++) {
+        int maxRow = k;
+        for (int i = k + 1; i < 3; i++) {
+            if (fabs(M[perm[i]][k]) > fabs(M[perm[maxRow]][k])) maxRow = i;
+        }
+        std::swap(perm[k], perm[maxRow]);
+        double pivot = M[perm[k]][k];
+        if (fabs(pivot) < 1e-300) return false;
+        for (int i = k + 1; i < 3; i++) {
+            double factor = M[perm[i]][k] / pivot;
+            for (int j = k; j < 3; j++) M[perm[i]][j] -= factor * M[perm[k]][j];
+            b[perm[i]] -= factor * b[perm[k]];
+        }
+    }
+    for (int i = 2; i >= 0; i--) {
+        x[i] = b[perm[i]];
+        for (int j = i + 1; j < 3; j++) x[i] -= M[perm[i]][j] * x[j];
+        x[i] /= M[perm[i]][i];
+    }
+    return true;
+}
+
+// Weighted residuals r_i = w_i (sigma_model - sigma_market) and, if J != 0,
+// Jacobian rows w.r.t. the unconstrained parameters u = (ln alpha, atanh rho, ln nu)
+static double residuals(const SABRSmile& smile, double beta, const double u[3],
+                        std::vector<double>& r, std::vector<double>* J) {
+    double alpha = exp(u[0]);
+    double rho = tanh(u[1]);
+    double nu = exp(u[2]);
+    double chain[3] = {alpha, 1.0 - rho * rho, nu};
+    
+    size_t n = smile.strikes.size();
+    double sse = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double w = smile.weights.empty() ? 1.0 : smile.weights[i];
+        double g[3];
+        double vol = SABRCalibrator::impliedVol(smile.F0, smile.strikes[i], smile.T,
+                                                alpha, beta, rho, nu, J ? g : 0);
+        r[i] = w * (vol - smile.vols[i]);
+        sse += r[i] * r[i];
+        if (J) {
+            for (int k = 0; k < 3; k++) (*J)[3 * i + k] = w * g[k] * chain[k];
+        }
+    }
+    return sse;
+}
+
+// Levenberg-Marquardt fit of one smile
+SABRCalibrationResult SABRCalibrator::calibrate(const SABRSmile& smile) const {
+    size_t n = smile.strikes.size();
+    
+    // Initial guess: alpha from the vol nearest the money, rho = 0, nu = 0.5
+    size_t atm = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (fabs(smile.strikes[i] - smile.F0) < fabs(smile.strikes[atm] - smile.F0)) atm = i;
+    }
+    double atmVol = (n > 0) ? smile.vols[atm] : 0.2;
+    double u[3] = {log(atmVol * pow(smile.F0, 1.0 - beta)), 0.0, log(0.5)};
+    
+    std::vector<double> r(n), rTrial(n), J(3 * n);
+    double sse = residuals(smile, beta, u, r, &J);
+    double lambda = 1e-3;
+    int iter = 0;
+    bool converged = false;
+    
+    while (iter < maxIterations && n > 0) {
+        iter++;
+        
+        // Normal equations: (J^T J + lambda diag(J^T J)) delta = -J^T r
+        double JTJ[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+        double JTr[3] = {0, 0, 0};
+        for (size_t i = 0; i < n; i++) {
+            const double* row = &J[3 * i];
+            for (int a = 0; a < 3; a++) {
+                JTr[a] += row[a] * r[i];
+                for (int b = 0; b <= a; b++) JTJ[a][b] += row[a] * row[b];
+            }
+        }
+        for (int a = 0; a < 3; a++) {
+            for (int b = a + 1; b < 3; b++) JTJ[a][b] = JTJ[b][a];
+        }
+        double gradNorm = fabs(JTr[0]) + fabs(JTr[1]) + fabs(JTr[2]);
+        if (gradNorm < tolerance) {
+            converged = true;
+            break;
+        }
+        
+        bool accepted = false;
+        while (!accepted && lambda < 1e12) {
+            double M[3][3];
+            double rhs[3];
+            for (int a = 0; a < 3; a++) {
+                for (int b = 0; b < 3; b++) M[a][b] = JTJ[a][b];
+                M[a][a] += lambda * std::max(JTJ[a][a], 1e-12);
+                rhs[a] = -JTr[a];
+            }
+            double delta[3];
+            if (!solve3(M, rhs, delta)) {
+                lambda *= 10.0;
+                continue;
+            }
+            
+            double uTrial[3] = {u[0] + delta[0], u[1] + delta[1], u[2] + delta[2]};
+            double sseTrial = residuals(smile, beta, uTrial, rTrial, 0);
+            if (sseTrial < sse && sseTrial == sseTrial) {
+                double stepSize = fabs(delta[0]) + fabs(delta[1]) + fabs(delta[2]);
+                bool small = (sse - sseTrial) <= tolerance * sse || stepSize < tolerance;
+                u[0] = uTrial[0];
+                u[1] = uTrial[1];
+                u[2] = uTrial[2];
+                sse = residuals(smile, beta, u, r, &J);
+                lambda = std::max(lambda * 0.1, 1e-12);
+                accepted = true;
+                if (small) converged = true;
+            } else {
+                lambda *= 10.0;
+            }
+        }
+        if (!accepted || converged) {
+            // No downhill step left: at a (local) minimum
+            converged = true;
+            break;
+        }
+    }
+    
+    SABRCalibrationResult result;
+    result.parameters.F0 = smile.F0;
+    result.parameters.alpha0 = exp(u[0]);
+    result.parameters.beta = beta;
+    result.parameters.nu = exp(u[2]);
+    result.parameters.rho = tanh(u[1]);
+    double wSum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double w = smile.weights.empty() ? 1.0 : smile.weights[i];
+        wSum += w * w;
+    }
+    result.rmse = (wSum > 0.0) ? sqrt(sse / wSum) : 0.0;
+    result.iterations = iter;
+    result.converged = converged;
+    return result;
+}
+
+// Parallel batch calibration: smiles are split into chunks, one task each
+std::vector<SABRCalibrationResult> SABRCalibrator::calibrateBatch(const std::vector<SABRSmile>& smiles,
+                                                                  ThreadPool& pool) const {
+    std::vector<SABRCalibrationResult> results(smiles.size());
+    if (smiles.empty()) {
+        return results;
+    }
+    
+    size_t chunk = std::max(static_cast<size_t>(1),
+                            smiles.size() / (4 * static_cast<size_t>(pool.getNThreads())));
+    const SABRSmile* in = &smiles[0];
+    SABRCalibrationResult* out = &results[0];
+    for (size_t begin = 0; begin < smiles.size(); begin += chunk) {
+        size_t end = std::min(begin + chunk, smiles.size());
+        pool.submit([this, in, out, begin, end]() {
+            for (size_t i = begin; i < end; i++) {
+                out[i] = calibrate(in[i]);
+            }
+        });
+    }
+    pool.wait();
+    
+    return results;
+}
@@ -0,0 +1,60 @@
+#ifndef SABRCALIBRATOR_H
+#define SABRCALIBRATOR_H
+
+#include "SABRSimulator.h"
+#include "ThreadPool.h"
+#include <vector>
+
+// Market smile for one expiry: Black (lognormal) implied vols by strike
+struct SABRSmile {
+    double F0;                    // Forward
+    double T;                     // Expiry
+    std::vector<double> strikes;
+    std::vector<double> vols;     // Black implied vols
+    std::vector<double> weights;  // Optional (empty = all 1)
+};
+
+// Calibration output
+struct SABRCalibrationResult {
+    SABRParameters parameters;    // F0, alpha0, beta, nu, rho (ready for SABRSimulator)
+    double rmse;                  // Weighted RMS vol error
+    int iterations;
+    bool converged;
+};
+
+// SABR calibrator: fits (alpha, rho, nu) for a fixed beta to a smile
+// Model vols use Hagan et al. (2002) closed-form lognormal implied vol;
+// the fit is Levenberg-Marquardt with analytic Jacobian. Parameters are
+// optimised through alpha = e^a, rho = tanh(p), nu = e^n, so every
+// iterate stays admissible without clamping.
+class SABRCalibrator {
+private:
+    double beta;          // Fixed backbone parameter
+    int maxIterations;    // LM iteration cap
+    double tolerance;     // Stop when relative SSE decrease / step < tolerance
+    
+public:
+    // Constructor
+    SABRCalibrator(double beta, int maxIterations = 100, double tolerance = 1e-12);
+    
+    // Destructor
+    ~SABRCalibrator();
+    
+    // Hagan implied Black vol
+    // If gradient != 0 it receives d(vol)/d(alpha, rho, nu)
+    static double impliedVol(double F, double K, double T, double alpha, double beta,
+                             double rho, double nu, double* gradient = 0);
+    
+    // Calibrate one smile
+    SABRCalibrationResult calibrate(const SABRSmile& smile) const;
+    
+    // Calibrate many smiles (e.g. one per expiry) in parallel on the pool
+    // Results are in the same order as smiles
+    std::vector<SABRCalibrationResult> calibrateBatch(const std::vector<SABRSmile>& smiles,
+                                                      ThreadPool& pool) const;
+    
+    // Getters
+    double getBeta() const { return beta; }
+};
+
+#endif
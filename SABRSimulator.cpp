@@ -1,5 +1,8 @@
 #include "SABRSimulator.h"
+#include "PathFile.h"
+#include "VectorMath.h"
 #include <algorithm>
+#include <fstream>
 
 // Constructor
 SABRSimulator::SABRSimulator(double F0, double alpha0, double beta, double nu, double rho) {
@@ -9,6 +12,36 @@ SABRSimulator::SABRSimulator(double F0, double alpha0, double beta, double nu, d
     this->nu = nu;
     this->rho = rho;
     this->rng = new RandomGenerator();
+    this->seed = rng->getSeed();
+    this->seeded = false;
+    this->importanceDrift = 0.0;
+}
+
+// Constructor with fixed seed
+SABRSimulator::SABRSimulator(double F0, double alpha0, double beta, double nu, double rho,
+                             unsigned int seed) {
+    this->F0 = F0;
+    this->alpha0 = alpha0;
+    this->beta = beta;
+    this->nu = nu;
+    this->rho = rho;
+    this->seed = seed;
+    this->seeded = true;
+    this->importanceDrift = 0.0;
+    this->rng = new RandomGenerator(seed);
+}
+
+// Constructor from a parameter set
+SABRSimulator::SABRSimulator(const SABRParameters& params, unsigned int seed) {
+    this->F0 = params.F0;
+    this->alpha0 = params.alpha0;
+    this->beta = params.beta;
+    this->nu = params.nu;
+    this->rho = params.rho;
+    this->seed = seed;
+    this->seeded = true;
+    this->importanceDrift = 0.0;
+    this->rng = new RandomGenerator(seed);
 }
 
 // Destructor
@@ -17,19 +50,35 @@ SABRSimulator::~SABRSimulator() {
 }
 
 // Simulate single path using Euler-Maruyama discretization
-void SABRSimulator::simulatePath(int nSteps, double T, double* F_path, double* alpha_path) {
+void SABRSimulator::simulatePath(int nSteps, double T, double* F_path, double* alpha_path,
+                                 double* weight_path) {
     double dt = T / static_cast<double>(nSteps);
     double sqrt_dt = sqrt(dt);
+    double shift = importanceDrift * sqrt_dt;   // Drift per step in units of sqrt(dt)
+    double logWeight = 0.0;
     
     // Initialize
     F_path[0] = F0;
     alpha_path[0] = alpha0;
+    if (weight_path) {
+        weight_path[0] = 1.0;
+    }
     
     // Euler-Maruyama scheme
     for (int i = 0; i < nSteps; i++) {
         double Z1, Z2;
         rng->generateCorrelatedNormals(rho, Z1, Z2);
         
+        // Measure change: shift the draws, accumulate log dQ/dQ~
+        if (importanceDrift != 0.0) {
+            logWeight -= shift * Z1 + 0.5 * shift * shift;
+            Z1 += shift;
+            Z2 += rho * shift;
+        }
+        if (weight_path) {
+            weight_path[i + 1] = VectorMath::exp(logWeight);
+        }
+        
         double F_current = F_path[i];
         double alpha_current = alpha_path[i];
         
@@ -37,7 +86,7 @@ void SABRSimulator::simulatePath(int nSteps, double T, double* F_path, double* a
         // F_{n+1} = F_n + alpha_n * F_n^beta * sqrt(dt) * Z1
         // alpha_{n+1} = alpha_n + nu * alpha_n * sqrt(dt) * Z2
         
-        double F_next = F_current + alpha_current * pow(F_current, beta) * sqrt_dt * Z1;
+        double F_next = F_current + alpha_current * VectorMath::pow(F_current, beta) * sqrt_dt * Z1;
         double alpha_next = alpha_current + nu * alpha_current * sqrt_dt * Z2;
         
         // Ensure positivity (truncate at small positive value)
@@ -49,10 +98,275 @@ void SABRSimulator::simulatePath(int nSteps, double T, double* F_path, double* a
     }
 }
 
-// Simulate multiple paths
+// Simulate multiple paths, one random substream per path index
 void SABRSimulator::simulatePaths(int nPaths, int nSteps, double T, 
-                                 double** F_paths, double** alpha_paths) {
+                                 double** F_paths, double** alpha_paths, int firstPath,
+                                 double** weight_paths) {
+    double dt = T / static_cast<double>(nSteps);
+    std::vector<double> sqrtDt(nSteps, sqrt(dt));
+    simulatePathsLockstep(nPaths, sqrtDt, F_paths, alpha_paths, firstPath, weight_paths);
+}
+
+// Euler step of n paths, PATH_BLOCK at a time
+void SABRSimulator::stepPaths(int n, double sqrt_dt, double* F, double* alpha,
+                              unsigned long long* rngStates, double* logWeight) {
+    double Z1[PATH_BLOCK];
+    double Z3[PATH_BLOCK];
+    double F_beta[PATH_BLOCK];
+    double rhoBar = sqrt(1.0 - rho * rho);
+    double shift = importanceDrift * sqrt_dt;
+    bool drift = logWeight && importanceDrift != 0.0;
+    
+    for (int start = 0; start < n; start += PATH_BLOCK) {
+        int m = std::min(PATH_BLOCK, n - start);
+        RandomGenerator::generateNormalPairs(rngStates + start, m, Z1, Z3);
+        VectorMath::pow(F + start, beta, F_beta, m);
+        
+        for (int k = 0; k < m; k++) {
+            // Same expressions as generateCorrelatedNormals and simulatePath
+            double Z1k = Z1[k];
+            double Z2k = rho * Z1k + rhoBar * Z3[k];
+            if (drift) {
+                logWeight[start + k] -= shift * Z1k + 0.5 * shift * shift;
+                Z1k += shift;
+                Z2k += rho * shift;
+            }
+            double F_current = F[start + k];
+            double alpha_current = alpha[start + k];
+            double F_next = F_current + alpha_current * F_beta[k] * sqrt_dt * Z1k;
+            double alpha_next = alpha_current + nu * alpha_current * sqrt_dt * Z2k;
+            F[start + k] = std::max(F_next, 0.001);
+            alpha[start + k] = std::max(alpha_next, 0.001);
+        }
+    }
+}
+
+// Blocks of paths from their stream starts, storing every step
+void SABRSimulator::simulatePathsLockstep(int nPaths, const std::vector<double>& sqrtDt,
+                                          double** F_paths, double** alpha_paths, int firstPath,
+                                          double** weight_paths) {
+    int nSteps = static_cast<int>(sqrtDt.size());
+    double F[PATH_BLOCK];
+    double alpha[PATH_BLOCK];
+    double logWeight[PATH_BLOCK];
+    double weight[PATH_BLOCK];
+    unsigned long long states[PATH_BLOCK];
+    
+    for (int start = 0; start < nPaths; start += PATH_BLOCK) {
+        int m = std::min(PATH_BLOCK, nPaths - start);
+        startPaths(m, F, alpha, states, firstPath + start);
+        for (int k = 0; k < m; k++) {
+            logWeight[k] = 0.0;
+            F_paths[start + k][0] = F[k];
+            alpha_paths[start + k][0] = alpha[k];
+            if (weight_paths) {
+                weight_paths[start + k][0] = 1.0;
+            }
+        }
+        
+        for (int j = 0; j < nSteps; j++) {
+            stepPaths(m, sqrtDt[j], F, alpha, states, logWeight);
+            for (int k = 0; k < m; k++) {
+                F_paths[start + k][j + 1] = F[k];
+                alpha_paths[start + k][j + 1] = alpha[k];
+            }
+            if (weight_paths) {
+                VectorMath::exp(logWeight, weight, m);
+                for (int k = 0; k < m; k++) {
+                    weight_paths[start + k][j + 1] = weight[k];
+                }
+            }
+        }
+    }
+}
+
+// Euler-Maruyama on a time grid: step j uses dt_j = t_{j+1} - t_j
+void SABRSimulator::simulatePath(const TimeGrid& grid, double* F_path, double* alpha_path,
+                                 double* weight_path) {
+    int nSteps = grid.getNSteps();
+    double logWeight = 0.0;
+    
+    F_path[0] = F0;
+    alpha_path[0] = alpha0;
+    if (weight_path) {
+        weight_path[0] = 1.0;
+    }
+    
+    for (int i = 0; i < nSteps; i++) {
+        double sqrt_dt = sqrt(grid.getDt(i));
+        double Z1, Z2;
+        rng->generateCorrelatedNormals(rho, Z1, Z2);
+        
+        if (importanceDrift != 0.0) {
+            double shift = importanceDrift * sqrt_dt;
+            logWeight -= shift * Z1 + 0.5 * shift * shift;
+            Z1 += shift;
+            Z2 += rho * shift;
+        }
+        if (weight_path) {
+            weight_path[i + 1] = VectorMath::exp(logWeight);
+        }
+        
+        double F_current = F_path[i];
+        double alpha_current = alpha_path[i];
+        double F_next = F_current + alpha_current * VectorMath::pow(F_current, beta) * sqrt_dt * Z1;
+        double alpha_next = alpha_current + nu * alpha_current * sqrt_dt * Z2;
+        F_path[i + 1] = std::max(F_next, 0.001);
+        alpha_path[i + 1] = std::max(alpha_next, 0.001);
+    }
+}
+
+// Multiple paths on a time grid, one random substream per path index
+void SABRSimulator::simulatePaths(int nPaths, const TimeGrid& grid,
+                                  double** F_paths, double** alpha_paths, int firstPath,
+                                  double** weight_paths) {
+    std::vector<double> sqrtDt(grid.getNSteps());
+    for (int j = 0; j < grid.getNSteps(); j++) {
+        sqrtDt[j] = sqrt(grid.getDt(j));
+    }
+    simulatePathsLockstep(nPaths, sqrtDt, F_paths, alpha_paths, firstPath, weight_paths);
+}
+
+// Initial states of paths firstPath.. (stream start, F0, alpha0)
+void SABRSimulator::startPaths(int nPaths, double* F, double* alpha, unsigned long long* rngStates,
+                               int firstPath) {
     for (int i = 0; i < nPaths; i++) {
-        simulatePath(nSteps, T, F_paths[i], alpha_paths[i]);
+        rng->setStream(seed, static_cast<unsigned long long>(firstPath + i));
+        F[i] = F0;
+        alpha[i] = alpha0;
+        rngStates[i] = rng->getPosition();
     }
 }
+
+// Resume paths from their saved states
+void SABRSimulator::advancePaths(int nPaths, int fromStep, int toStep, int nSteps, double T,
+                                 double* F, double* alpha, unsigned long long* rngStates) {
+    double dt = T / static_cast<double>(nSteps);
+    double sqrt_dt = sqrt(dt);
+    
+    // All steps of one block before the next (states stay in cache)
+    for (int start = 0; start < nPaths; start += PATH_BLOCK) {
+        int m = std::min(PATH_BLOCK, nPaths - start);
+        for (int j = fromStep; j < toStep; j++) {
+            stepPaths(m, sqrt_dt, F + start, alpha + start, rngStates + start, 0);
+        }
+    }
+}
+
+// Drift that centres F_T on K (first-order expansion of the dynamics)
+void SABRSimulator::setImportanceTarget(double K, double T) {
+    double localVol = alpha0 * pow(F0, beta);
+    importanceDrift = (T > 0.0 && localVol > 0.0) ? (K - F0) / (localVol * T) : 0.0;
+}
+
+// Scenario-batched simulation sharing one random draw per step
+void SABRSimulator::simulatePathsBatch(int nScenarios, const SABRParameters* scenarios,
+                                       int nPaths, int nSteps, double T,
+                                       double*** F_paths, double*** alpha_paths, int firstPath) {
+    double dt = T / static_cast<double>(nSteps);
+    double sqrt_dt = sqrt(dt);
+    
+    // Structure-of-arrays scenario state: lane s = scenario s
+    double* F = new double[nScenarios];
+    double* alpha = new double[nScenarios];
+    double* beta_s = new double[nScenarios];
+    double* nu_s = new double[nScenarios];
+    double* rho_s = new double[nScenarios];
+    double* rhoBar = new double[nScenarios];   // sqrt(1 - rho^2)
+    double* F_beta = new double[nScenarios];
+    for (int s = 0; s < nScenarios; s++) {
+        beta_s[s] = scenarios[s].beta;
+        nu_s[s] = scenarios[s].nu;
+        rho_s[s] = scenarios[s].rho;
+        rhoBar[s] = sqrt(1.0 - scenarios[s].rho * scenarios[s].rho);
+    }
+    
+    for (int i = 0; i < nPaths; i++) {
+        rng->setStream(seed, static_cast<unsigned long long>(firstPath + i));
+        
+        for (int s = 0; s < nScenarios; s++) {
+            F[s] = scenarios[s].F0;
+            alpha[s] = scenarios[s].alpha0;
+            F_paths[s][i][0] = F[s];
+            alpha_paths[s][i][0] = alpha[s];
+        }
+        
+        for (int j = 0; j < nSteps; j++) {
+            // Same draws as generateCorrelatedNormals: Z1 then Z3
+            double Z1 = rng->generateNormal();
+            double Z3 = rng->generateNormal();
+            
+            VectorMath::pow(F, beta_s, F_beta, nScenarios);
+            for (int s = 0; s < nScenarios; s++) {
+                double Z2 = rho_s[s] * Z1 + rhoBar[s] * Z3;
+                // Same expressions as simulatePath (bitwise-identical results)
+                double F_next = F[s] + alpha[s] * F_beta[s] * sqrt_dt * Z1;
+                double alpha_next = alpha[s] + nu_s[s] * alpha[s] * sqrt_dt * Z2;
+                F[s] = std::max(F_next, 0.001);
+                alpha[s] = std::max(alpha_next, 0.001);
+            }
+            
+            for (int s = 0; s < nScenarios; s++) {
+                F_paths[s][i][j + 1] = F[s];
+                alpha_paths[s][i][j + 1] = alpha[s];
+            }
+        }
+    }
+    
+    delete[] F;
+    delete[] alpha;
+    delete[] beta_s;
+    delete[] nu_s;
+    delete[] rho_s;
+    delete[] rhoBar;
+    delete[] F_beta;
+}
+
+// Simulate and write a path file, 1024 paths at a time
+bool SABRSimulator::writePaths(const std::string& filename, int nPaths, int nSteps, double T,
+                               int firstPath) {
+    if (importanceDrift != 0.0) {
+        return false;
+    }
+    std::ofstream file(filename.c_str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    
+    PathFileHeader header;
+    header.nPaths = nPaths;
+    header.nSteps = nSteps;
+    header.seed = seed;
+    header.firstPath = firstPath;
+    header.T = T;
+    header.F0 = F0;
+    header.alpha0 = alpha0;
+    header.beta = beta;
+    header.nu = nu;
+    header.rho = rho;
+    if (!MappedPaths::writeHeader(file, header)) {
+        return false;
+    }
+    
+    const int chunk = 1024;
+    size_t row = static_cast<size_t>(nSteps) + 1;
+    double* block = new double[2 * row * chunk];
+    double** F_rows = new double*[chunk];
+    double** alpha_rows = new double*[chunk];
+    for (int i = 0; i < chunk; i++) {
+        F_rows[i] = block + 2 * row * i;
+        alpha_rows[i] = block + 2 * row * i + row;
+    }
+    
+    for (int start = 0; start < nPaths && file; start += chunk) {
+        int n = std::min(chunk, nPaths - start);
+        simulatePaths(n, nSteps, T, F_rows, alpha_rows, firstPath + start);
+        file.write(reinterpret_cast<const char*>(block), 2 * row * n * sizeof(double));
+    }
+    bool ok = static_cast<bool>(file);
+    
+    delete[] block;
+    delete[] F_rows;
+    delete[] alpha_rows;
+    return ok;
+}
@@ -2,38 +2,143 @@
 #define SABRSIMULATOR_H
 
 #include "RandomGenerator.h"
+#include "TimeGrid.h"
 #include <cmath>
+#include <string>
+#include <vector>
 
 // SABR Model: Stochastic Alpha Beta Rho
 // dF_t = alpha_t * F_t^beta * dW1
 // dalpha_t = nu * alpha_t * dW2
 // where dW1 and dW2 have correlation rho
 
+// One set of SABR parameters (used by the scenario-batched simulation)
+struct SABRParameters {
+    double F0;
+    double alpha0;
+    double beta;
+    double nu;
+    double rho;
+};
+
 class SABRSimulator {
+public:
+    // Paths advanced together by simulatePaths / advancePaths
+    static const int PATH_BLOCK = 128;
+    
 private:
     double F0;        // Initial forward rate
     double alpha0;    // Initial volatility
     double beta;      // Backbone parameter [0, 1]
     double nu;        // Vol-of-vol (volatility of volatility)
     double rho;       // Correlation between Brownian motions
+    unsigned int seed;     // Seed of the per-path random streams
+    bool seeded;           // True if seed was chosen by the caller (reproducible)
+    double importanceDrift;  // Drift mu added to dW1 (0 = plain Monte Carlo)
     RandomGenerator* rng;  // Pointer to random generator
     
+    // One Euler step of n paths in lockstep from states (F, alpha,
+    // rngStates); with logWeight, also the importance drift and the log
+    // likelihood ratio. Same arithmetic as simulatePath, with the normals,
+    // F^beta and exp on the vector kernels (VectorMath).
+    void stepPaths(int n, double sqrt_dt, double* F, double* alpha,
+                   unsigned long long* rngStates, double* logWeight);
+    
+    // simulatePaths with sqrt(dt_j) per step
+    void simulatePathsLockstep(int nPaths, const std::vector<double>& sqrtDt,
+                               double** F_paths, double** alpha_paths, int firstPath,
+                               double** weight_paths);
+    
 public:
-    // Constructor
+    // Constructor (time-based seed)
     SABRSimulator(double F0, double alpha0, double beta, double nu, double rho);
     
+    // Constructor with fixed seed (reproducible paths)
+    SABRSimulator(double F0, double alpha0, double beta, double nu, double rho,
+                  unsigned int seed);
+    
+    // Constructor from a parameter set (e.g. a calibration result)
+    SABRSimulator(const SABRParameters& params, unsigned int seed);
+    
     // Destructor
     ~SABRSimulator();
     
     // Simulate single path from 0 to T with nSteps
     // Stores results in arrays F_path and alpha_path (must be pre-allocated)
-    void simulatePath(int nSteps, double T, double* F_path, double* alpha_path);
+    // If weight_path is given, weight_path[j] receives the likelihood ratio
+    // dQ/dQ~ up to step j (all 1 without importance sampling)
+    void simulatePath(int nSteps, double T, double* F_path, double* alpha_path,
+                      double* weight_path = 0);
     
     // Simulate multiple paths
     // F_paths[i][j] = forward rate of path i at step j
     // alpha_paths[i][j] = volatility of path i at step j
+    // weight_paths[i][j] = likelihood ratio of path i at step j (optional)
+    // Path i is driven by random substream (seed, firstPath + i), so two
+    // simulators with the same seed share their Brownian increments
+    // (common random numbers) whatever their SABR parameters.
+    // Paths are advanced PATH_BLOCK at a time in lockstep, each step's
+    // transcendentals vectorized across the block; every path is bit for
+    // bit what simulatePath gives on its substream.
     void simulatePaths(int nPaths, int nSteps, double T, 
-                      double** F_paths, double** alpha_paths);
+                      double** F_paths, double** alpha_paths, int firstPath = 0,
+                      double** weight_paths = 0);
+    
+    // Resumable simulation (recompute instead of store)
+    // The state of path i at a step is (F[i], alpha[i], rngStates[i]).
+    // startPaths sets paths firstPath.. at t = 0; advancePaths moves them
+    // from step fromStep to toStep of the nSteps-step grid over [0, T],
+    // giving bit for bit the values simulatePaths stores at toStep. No
+    // importance-sampling drift is applied.
+    void startPaths(int nPaths, double* F, double* alpha, unsigned long long* rngStates,
+                    int firstPath = 0);
+    void advancePaths(int nPaths, int fromStep, int toStep, int nSteps, double T,
+                      double* F, double* alpha, unsigned long long* rngStates);
+    
+    // Simulate on a non-uniform time grid (e.g. TimeGrid::fromSchedule)
+    // Rows hold grid.getNSteps()+1 points, point j at grid.getTime(j); same
+    // random substreams as on the uniform grid
+    void simulatePath(const TimeGrid& grid, double* F_path, double* alpha_path,
+                      double* weight_path = 0);
+    void simulatePaths(int nPaths, const TimeGrid& grid,
+                       double** F_paths, double** alpha_paths, int firstPath = 0,
+                       double** weight_paths = 0);
+    
+    // Importance sampling (measure change on the forward's driver)
+    // Paths are sampled under Q~, where dW1 = dW~ + mu dt (and dW2, built
+    // from dW1, picks up rho * mu dt); the likelihood ratio
+    // dQ/dQ~ = exp(-mu W~_t - mu^2 t / 2) is reported through weight_paths.
+    // Weighted estimators then stay unbiased under the pricing measure while
+    // many more paths reach an out-of-the-money strike. Only simulatePath(s)
+    // apply the drift: the batch simulation and path files do not.
+    void setImportanceDrift(double mu) { importanceDrift = mu; }
+    double getImportanceDrift() const { return importanceDrift; }
+    bool isImportanceSampling() const { return importanceDrift != 0.0; }
+    
+    // Set the drift that moves the forward to the strike K at time T (to
+    // first order: F0 + alpha0 F0^beta mu T = K)
+    void setImportanceTarget(double K, double T);
+    
+    // Scenario-batched simulation
+    // Simulates nPaths paths for each of nScenarios parameter sets in one pass:
+    // every path draws its normals once and advances all scenarios with them
+    // (scenario is the innermost loop, over contiguous state arrays).
+    // F_paths[s][i][j] / alpha_paths[s][i][j] = scenario s, path i, step j.
+    // Scenario s reproduces exactly what simulatePaths gives a simulator with
+    // parameters scenarios[s] and this simulator's seed.
+    void simulatePathsBatch(int nScenarios, const SABRParameters* scenarios,
+                            int nPaths, int nSteps, double T,
+                            double*** F_paths, double*** alpha_paths, int firstPath = 0);
+    
+    // Simulate nPaths paths and write them to a binary path file (PathFile.h)
+    // Paths are simulated and written in chunks, so memory stays bounded
+    // Returns false on I/O failure, or with importance sampling on (path
+    // files carry no weights)
+    bool writePaths(const std::string& filename, int nPaths, int nSteps, double T,
+                    int firstPath = 0);
+    
+    // Reseed the path streams
+    void setSeed(unsigned int newSeed) { seed = newSeed; seeded = true; }
     
     // Get parameters
     double getF0() const { return F0; }
@@ -41,6 +146,8 @@ public:
     double getBeta() const { return beta; }
     double getNu() const { return nu; }
     double getRho() const { return rho; }
+    unsigned int getSeed() const { return seed; }
+    bool isSeeded() const { return seeded; }
 };
 
 #endif
@@ -0,0 +1,405 @@
+#include "ShardedPricer.h"
+#include "LSMPricer.h"
+#include "PolynomialRegression.h"
+#include "VectorMath.h"
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+// Constructor
+LSMShard::LSMShard(const SABRParameters& params, unsigned int seed, const BermudanOption& option,
+                   int firstPath, int nPaths, double r, int polyDegree)
+    : params(params), option(option) {
+    this->seed = seed;
+    this->firstPath = firstPath;
+    this->nPaths = nPaths;
+    this->discountRate = r;
+    this->polynomialDegree = polyDegree;
+    this->nExerciseDates = option.getNExerciseDates();
+
+    // Same grid as LSMPricer::price
+    int totalSteps = LSMPricer::simulationSteps(option);
+    dt = option.getExerciseDate(nExerciseDates - 1) / static_cast<double>(totalSteps);
+    exerciseSteps.resize(nExerciseDates);
+    for (int m = 0; m < nExerciseDates; m++) {
+        exerciseSteps[m] = static_cast<int>(option.getExerciseDate(m) / dt + 0.5);
+    }
+    F_dates = new double[static_cast<size_t>(std::max(nExerciseDates - 1, 1)) * nPaths];
+    V = new double[nPaths];
+}
+
+// Destructor
+LSMShard::~LSMShard() {
+    delete[] F_dates;
+    delete[] V;
+}
+
+// Simulate in chunks, keeping only the exercise-date states
+void LSMShard::simulate() {
+    int totalSteps = LSMPricer::simulationSteps(option);
+    double T = option.getExerciseDate(nExerciseDates - 1);
+    size_t row = static_cast<size_t>(totalSteps) + 1;
+    int chunk = std::min(nPaths, static_cast<int>(LSMPricer::SIMULATION_CHUNK));
+    if (chunk <= 0) {
+        return;
+    }
+
+    double* block = new double[2 * row * chunk];
+    double** F_rows = new double*[chunk];
+    double** alpha_rows = new double*[chunk];
+    for (int i = 0; i < chunk; i++) {
+        F_rows[i] = block + 2 * row * i;
+        alpha_rows[i] = block + 2 * row * i + row;
+    }
+
+    SABRSimulator sim(params, seed);
+    int lastStep = exerciseSteps[nExerciseDates - 1];
+    for (int start = 0; start < nPaths; start += chunk) {
+        int n = std::min(chunk, nPaths - start);
+        sim.simulatePaths(n, totalSteps, T, F_rows, alpha_rows, firstPath + start);
+        for (int m = 0; m < nExerciseDates - 1; m++) {
+            double* column = F_dates + static_cast<size_t>(m) * nPaths + start;
+            for (int i = 0; i < n; i++) column[i] = F_rows[i][exerciseSteps[m]];
+        }
+        for (int i = 0; i < n; i++) {
+            V[start + i] = option.payoff(F_rows[i][lastStep]);
+        }
+    }
+
+    delete[] block;
+    delete[] F_rows;
+    delete[] alpha_rows;
+}
+
+// Normal equations of the ITM paths at date m, in path order
+void LSMShard::accumulate(int m, double* statistics) {
+    int p = polynomialDegree + 1;
+    double discountToNext = VectorMath::exp(-discountRate * (exerciseSteps[m + 1] - exerciseSteps[m]) * dt);
+    const double* F = F_dates + static_cast<size_t>(m) * nPaths;
+
+    std::vector<double> F_itm, C_itm;
+    for (int i = 0; i < nPaths; i++) {
+        if (option.payoff(F[i]) > 0.0) {
+            F_itm.push_back(F[i]);
+            C_itm.push_back(V[i] * discountToNext);
+        }
+    }
+
+    PolynomialRegression reg(polynomialDegree);
+    if (!F_itm.empty()) {
+        reg.addPoints(&F_itm[0], &C_itm[0], static_cast<int>(F_itm.size()));
+    }
+    reg.getNormalEquations(statistics, statistics + p * p);
+    statistics[p * p + p] = static_cast<double>(F_itm.size());
+}
+
+// Exercise decision at date m
+void LSMShard::applyExercise(int m, const double* coeffs, bool anyItm) {
+    double discountToNext = VectorMath::exp(-discountRate * (exerciseSteps[m + 1] - exerciseSteps[m]) * dt);
+    const double* F = F_dates + static_cast<size_t>(m) * nPaths;
+
+    for (int i = 0; i < nPaths; i++) {
+        double immediatePayoff = option.payoff(F[i]);
+        if (anyItm && immediatePayoff > 0.0) {
+            double continuationValue = 0.0;
+            double basis = 1.0;
+            for (int j = 0; j <= polynomialDegree; j++) {
+                continuationValue += coeffs[j] * basis;
+                basis *= F[i];
+            }
+            V[i] = (immediatePayoff > continuationValue) ? immediatePayoff : V[i] * discountToNext;
+        } else {
+            V[i] *= discountToNext;
+        }
+    }
+}
+
+// Discount to t=0 and reduce
+void LSMShard::reduce(double* sums) {
+    double discountToZero = VectorMath::exp(-discountRate * option.getExerciseDate(0));
+    double sum = 0.0;
+    double sumSquared = 0.0;
+    for (int i = 0; i < nPaths; i++) {
+        double discounted = V[i] * discountToZero;
+        sum += discounted;
+        sumSquared += discounted * discounted;
+    }
+    sums[0] = sum;
+    sums[1] = sumSquared;
+}
+
+// One protocol step
+bool LSMShard::step(const double* command, double* reply) {
+    int m = static_cast<int>(command[0]);
+    if (m < nExerciseDates - 1) {
+        applyExercise(m, command + 2, command[1] != 0.0);
+    }
+    if (m > 0) {
+        accumulate(m - 1, reply);
+        return false;
+    }
+    reduce(reply);
+    return true;
+}
+
+// Read exactly n doubles
+static bool readDoubles(int fd, double* data, int n) {
+    char* p = reinterpret_cast<char*>(data);
+    size_t bytes = static_cast<size_t>(n) * sizeof(double);
+    while (bytes > 0) {
+        ssize_t got = read(fd, p, bytes);
+        if (got <= 0) return false;
+        p += got;
+        bytes -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// Write exactly n doubles (no SIGPIPE on sockets whose peer is gone)
+static bool writeDoubles(int fd, const double* data, int n, bool isSocket) {
+    const char* p = reinterpret_cast<const char*>(data);
+    size_t bytes = static_cast<size_t>(n) * sizeof(double);
+    while (bytes > 0) {
+        ssize_t put = isSocket ? send(fd, p, bytes, MSG_NOSIGNAL) : write(fd, p, bytes);
+        if (put <= 0) return false;
+        p += put;
+        bytes -= static_cast<size_t>(put);
+    }
+    return true;
+}
+
+// Worker loop
+bool LSMShard::serve(int fd) {
+    simulate();
+    std::vector<double> command(commandSize(polynomialDegree));
+    std::vector<double> reply(replySize(polynomialDegree));
+
+    // First command is for maturity: no decision, statistics of the last date
+    bool done = false;
+    while (!done) {
+        if (!readDoubles(fd, &command[0], static_cast<int>(command.size()))) {
+            return false;
+        }
+        done = step(&command[0], &reply[0]);
+        if (!writeDoubles(fd, &reply[0], static_cast<int>(reply.size()), false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Constructor
+ShardedPricer::ShardedPricer(double r, int polyDegree, int nShards) {
+    this->discountRate = r;
+    this->polynomialDegree = polyDegree;
+    if (nShards <= 0) {
+        nShards = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    this->nShards = std::max(nShards, 1);
+    this->standardError = 0.0;
+    this->bytesExchanged = 0;
+}
+
+// Destructor
+ShardedPricer::~ShardedPricer() {
+    // Nothing to clean up
+}
+
+// Contiguous, balanced path ranges
+void ShardedPricer::shardRange(int k, int nShards, int nPaths, int& first, int& count) {
+    first = static_cast<int>(static_cast<long long>(k) * nPaths / nShards);
+    int end = static_cast<int>(static_cast<long long>(k + 1) * nPaths / nShards);
+    count = end - first;
+}
+
+// Drive the backward induction: one command / reply round per exercise date
+double ShardedPricer::coordinate(std::vector<int>& fds, std::vector<LSMShard*>& localShards,
+                                 const BermudanOption& option, int nPaths, ThreadPool* pool) {
+    bool remote = !fds.empty();
+    int n = remote ? static_cast<int>(fds.size()) : static_cast<int>(localShards.size());
+    int p = polynomialDegree + 1;
+    int commandSize = LSMShard::commandSize(polynomialDegree);
+    int replySize = LSMShard::replySize(polynomialDegree);
+    int nExerciseDates = option.getNExerciseDates();
+
+    std::vector<double> command(commandSize, 0.0);
+    std::vector<double> replies(static_cast<size_t>(n) * replySize, 0.0);
+    PolynomialRegression reg(polynomialDegree);
+    exercisePolicy.assign(nExerciseDates - 1, std::vector<double>());
+
+    bool ok = true;
+    for (int m = nExerciseDates - 1; m >= 0 && ok; m--) {
+        command[0] = m;
+
+        // Send to every shard before reading, so workers run concurrently
+        for (int k = 0; k < n && ok; k++) {
+            double* reply = &replies[static_cast<size_t>(k) * replySize];
+            if (remote) {
+                ok = writeDoubles(fds[k], &command[0], commandSize, true);
+            } else if (pool) {
+                LSMShard* shard = localShards[k];
+                const double* cmd = &command[0];
+                pool->submitTo(k, [shard, cmd, reply]() { shard->step(cmd, reply); });
+            } else {
+                localShards[k]->step(&command[0], reply);
+            }
+        }
+        if (pool) {
+            pool->wait();
+        }
+        for (int k = 0; k < n && ok && remote; k++) {
+            ok = readDoubles(fds[k], &replies[static_cast<size_t>(k) * replySize], replySize);
+        }
+        bytesExchanged += static_cast<long long>(n) * (commandSize + replySize) * sizeof(double);
+        if (!ok || m == 0) {
+            break;
+        }
+
+        // Global regression for date m-1 from the merged statistics
+        reg.reset();
+        for (int k = 0; k < n; k++) {
+            const double* s = &replies[static_cast<size_t>(k) * replySize];
+            reg.addNormalEquations(s, s + p * p, static_cast<long long>(s[p * p + p]));
+        }
+        bool anyItm = (reg.getNAccumulated() > 0);
+        command[1] = anyItm ? 1.0 : 0.0;
+        if (anyItm) {
+            reg.solve();
+            for (int j = 0; j < p; j++) {
+                command[2 + j] = reg.getCoefficient(j);
+            }
+            exercisePolicy[m - 1].assign(command.begin() + 2, command.end());
+        }
+    }
+    if (!ok) {
+        return -1.0;
+    }
+
+    // Merge the shards' sums
+    double sum = 0.0;
+    double sumSquared = 0.0;
+    for (int k = 0; k < n; k++) {
+        sum += replies[static_cast<size_t>(k) * replySize];
+        sumSquared += replies[static_cast<size_t>(k) * replySize + 1];
+    }
+    double optionPrice = sum / static_cast<double>(nPaths);
+    double variance = (sumSquared / nPaths) - (optionPrice * optionPrice);
+    standardError = sqrt(variance / nPaths);
+    return optionPrice;
+}
+
+// One forked worker per shard, connected by a socketpair
+double ShardedPricer::price(const SABRParameters& params, unsigned int seed,
+                            const BermudanOption& option, int nPaths) {
+    bytesExchanged = 0;
+    std::vector<int> fds;
+    std::vector<pid_t> workers;
+    bool ok = true;
+
+    for (int k = 0; k < nShards && ok; k++) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+            ok = false;
+            break;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(sv[0]);
+            close(sv[1]);
+            ok = false;
+            break;
+        }
+        if (pid == 0) {
+            // Worker: keep only its own connection
+            for (size_t j = 0; j < fds.size(); j++) {
+                close(fds[j]);
+            }
+            close(sv[0]);
+            int status = 1;
+            try {
+                int first, count;
+                shardRange(k, nShards, nPaths, first, count);
+                LSMShard shard(params, seed, option, first, count, discountRate, polynomialDegree);
+                status = shard.serve(sv[1]) ? 0 : 1;
+            } catch (...) {
+                status = 1;
+            }
+            close(sv[1]);
+            _exit(status);
+        }
+        close(sv[1]);
+        fds.push_back(sv[0]);
+        workers.push_back(pid);
+    }
+
+    double optionPrice = -1.0;
+    if (ok) {
+        std::vector<LSMShard*> noLocalShards;
+        optionPrice = coordinate(fds, noLocalShards, option, nPaths);
+    }
+
+    // Closing the connections ends any worker still waiting for a command
+    for (size_t k = 0; k < fds.size(); k++) {
+        close(fds[k]);
+    }
+    for (size_t k = 0; k < workers.size(); k++) {
+        int status = 0;
+        if (waitpid(workers[k], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = false;
+        }
+    }
+    return ok ? optionPrice : -1.0;
+}
+
+// Shards in this process
+double ShardedPricer::priceInProcess(const SABRParameters& params, unsigned int seed,
+                                     const BermudanOption& option, int nPaths) {
+    bytesExchanged = 0;
+    std::vector<LSMShard*> shards;
+    for (int k = 0; k < nShards; k++) {
+        int first, count;
+        shardRange(k, nShards, nPaths, first, count);
+        shards.push_back(new LSMShard(params, seed, option, first, count,
+                                      discountRate, polynomialDegree));
+        shards.back()->simulate();
+    }
+
+    std::vector<int> noConnections;
+    double optionPrice = coordinate(noConnections, shards, option, nPaths);
+
+    for (size_t k = 0; k < shards.size(); k++) {
+        delete shards[k];
+    }
+    return optionPrice;
+}
+
+// One shard per pool worker, bound to it
+double ShardedPricer::priceOnPool(ThreadPool& pool, const SABRParameters& params, unsigned int seed,
+                                  const BermudanOption& option, int nPaths) {
+    bytesExchanged = 0;
+    int n = pool.getNThreads();
+    std::vector<LSMShard*> shards(n, static_cast<LSMShard*>(0));
+    double r = discountRate;
+    int degree = polynomialDegree;
+    for (int k = 0; k < n; k++) {
+        LSMShard** slot = &shards[k];
+        pool.submitTo(k, [=, &params, &option]() {
+            int first, count;
+            shardRange(k, n, nPaths, first, count);
+            *slot = new LSMShard(params, seed, option, first, count, r, degree);
+            (*slot)->simulate();
+        });
+    }
+    pool.wait();
+
+    std::vector<int> noConnections;
+    double optionPrice = coordinate(noConnections, shards, option, nPaths, &pool);
+
+    for (int k = 0; k < n; k++) {
+        delete shards[k];
+    }
+    return optionPrice;
+}
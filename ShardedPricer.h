@@ -0,0 +1,137 @@
+#ifndef SHARDEDPRICER_H
+#define SHARDEDPRICER_H
+
+#include "SABRSimulator.h"
+#include "BermudanOption.h"
+#include "ThreadPool.h"
+#include <vector>
+
+// One shard of a sharded Longstaff-Schwartz pricing
+// Owns paths [firstPath, firstPath + nPaths) of the simulation, each on its
+// own RNG substream, and keeps only F at the exercise dates plus the path
+// values V. The backward induction is driven from outside one exercise date
+// at a time: the shard reports the date's regression sufficient statistics
+// (X^T X, X^T C and the ITM count over its paths) and applies the
+// coefficients solved from all shards' statistics.
+class LSMShard {
+private:
+    SABRParameters params;
+    unsigned int seed;
+    BermudanOption option;
+    int firstPath;
+    int nPaths;
+    double discountRate;
+    int polynomialDegree;
+    int nExerciseDates;
+    std::vector<int> exerciseSteps;
+    double dt;
+    double* F_dates;     // F at exercise date m of path i: F_dates[m * nPaths + i]
+    double* V;           // Path values at the last processed date
+
+public:
+    // Constructor
+    LSMShard(const SABRParameters& params, unsigned int seed, const BermudanOption& option,
+             int firstPath, int nPaths, double r = 0.05, int polyDegree = 3);
+
+    // Destructor
+    ~LSMShard();
+
+    // Simulate the shard's paths and set V to the payoff at maturity
+    void simulate();
+
+    // Message sizes in doubles
+    // command: [m, anyItm, coefficients (degree+1)]
+    // reply:   statistics [X^T X, X^T C, nItm] or sums [sum, sumSquared]
+    static int commandSize(int polyDegree) { return polyDegree + 3; }
+    static int replySize(int polyDegree) { return (polyDegree + 1) * (polyDegree + 2) + 1; }
+
+    // Sufficient statistics of exercise date m (V holds date m+1 values)
+    void accumulate(int m, double* statistics);
+
+    // Exercise decision at date m with the global coefficients
+    // (anyItm false: no path of any shard was ITM, continue everywhere)
+    void applyExercise(int m, const double* coeffs, bool anyItm);
+
+    // Sum and sum of squares of the discounted values at t = 0
+    void reduce(double* sums);
+
+    // One protocol step: apply command's exercise date m (none at maturity),
+    // then fill reply with the statistics of date m-1, or the sums after
+    // date 0. Returns true once the sums are written.
+    bool step(const double* command, double* reply);
+
+    // Worker side: simulate, then answer commands on stream fd (pipe,
+    // socket) until the pricing is done; false if the stream broke
+    bool serve(int fd);
+
+    int getNPaths() const { return nPaths; }
+};
+
+// Sharded Longstaff-Schwartz pricing across worker processes
+// The paths are split into nShards contiguous ranges, each simulated and
+// kept by its own forked worker process (LSMShard). Per exercise date every
+// worker sends its regression sufficient statistics; the coordinator adds
+// them (PolynomialRegression::addNormalEquations), solves the regression
+// and sends the coefficients back. Finally the shards' sum / sumSquared are
+// merged into price and standard error. Traffic per shard is
+// O(degree^2 x dates) doubles whatever the path count, so the same protocol
+// carries over to workers on other hosts (any stream socket in place of
+// the socketpairs; doubles are sent in host byte order).
+// Paths keep their substreams, so one shard reproduces LSMPricer::price for
+// the same seed exactly; with more shards only the summation order of the
+// normal equations differs.
+class ShardedPricer {
+private:
+    double discountRate;
+    int polynomialDegree;
+    int nShards;
+    double standardError;
+    long long bytesExchanged;
+    std::vector<std::vector<double> > exercisePolicy;
+
+    // Coordinator loop over connected shards (remote or in process; with
+    // pool, in-process shard k steps on worker k)
+    double coordinate(std::vector<int>& fds, std::vector<LSMShard*>& localShards,
+                      const BermudanOption& option, int nPaths, ThreadPool* pool = 0);
+
+public:
+    // Constructor: nShards <= 0 uses the hardware concurrency
+    ShardedPricer(double r = 0.05, int polyDegree = 3, int nShards = 0);
+
+    // Destructor
+    ~ShardedPricer();
+
+    // Price with one forked worker process per shard
+    // Returns -1 if a worker cannot be started or fails
+    double price(const SABRParameters& params, unsigned int seed,
+                 const BermudanOption& option, int nPaths);
+
+    // Same protocol with the shards run in this process, one after another
+    // (reference for the distributed result, no fork)
+    double priceInProcess(const SABRParameters& params, unsigned int seed,
+                          const BermudanOption& option, int nPaths);
+
+    // NUMA-aware threaded pricing: one shard per worker of pool (nShards
+    // is not used). Shard k is allocated, simulated (first touch) and
+    // stepped through every exercise date and the reduction by worker k
+    // only (ThreadPool::submitTo), so with a pinned pool each core reads
+    // only memory on its own node; per date, only the regression
+    // statistics cross sockets.
+    double priceOnPool(ThreadPool& pool, const SABRParameters& params, unsigned int seed,
+                       const BermudanOption& option, int nPaths);
+
+    // Path range [first, first + count) of shard k
+    static void shardRange(int k, int nShards, int nPaths, int& first, int& count);
+
+    // Results of last pricing
+    double getStandardError() const { return standardError; }
+    long long getBytesExchanged() const { return bytesExchanged; }   // Both directions, all shards
+    const std::vector<std::vector<double> >& getExercisePolicy() const { return exercisePolicy; }
+
+    // Get parameters
+    double getDiscountRate() const { return discountRate; }
+    int getPolynomialDegree() const { return polynomialDegree; }
+    int getNShards() const { return nShards; }
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include "ThreadPool.h"
+#include <pthread.h>
+#include <sched.h>
+
+// Worker identity of the calling thread (-1 outside any pool)
+static thread_local const ThreadPool* currentPool = 0;
+static thread_local int currentWorker = -1;
+
+// Constructor
+ThreadPool::ThreadPool(int nThreads, bool pinThreads) {
+    if (nThreads <= 0) {
+        nThreads = static_cast<int>(std::thread::hardware_concurrency());
+        if (nThreads <= 0) {
+            nThreads = 1;
+        }
+    }
+    queued = 0;
+    pending = 0;
+    stopping = false;
+    nextWorker = 0;
+    
+    for (int i = 0; i < nThreads; i++) {
+        workers.push_back(new Worker());
+    }
+    for (int i = 0; i < nThreads; i++) {
+        threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+    }
+    if (pinThreads) {
+        pinWorkers();
+    }
+}
+
+// Pin worker i to the i-th CPU the process may run on
+void ThreadPool::pinWorkers() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return;
+    }
+    std::vector<int> cpus;
+    for (int c = 0; c < CPU_SETSIZE; c++) {
+        if (CPU_ISSET(c, &allowed)) {
+            cpus.push_back(c);
+        }
+    }
+    if (cpus.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        int cpu = cpus[i % cpus.size()];
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        if (pthread_setaffinity_np(threads[i].native_handle(), sizeof(one), &one) == 0) {
+            workers[i]->cpu = cpu;
+        }
+    }
+}
+
+// Destructor
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        delete workers[i];
+    }
+}
+
+// Queue a task on the caller's own deque, or round-robin from outside
+void ThreadPool::submit(const std::function<void()>& task) {
+    int n = static_cast<int>(workers.size());
+    int target;
+    if (currentPool == this && currentWorker >= 0) {
+        target = currentWorker;
+    } else {
+        target = static_cast<int>(nextWorker++ % static_cast<unsigned int>(n));
+    }
+    enqueue(workers[target], task, false);
+}
+
+// Queue a task for one worker only
+void ThreadPool::submitTo(int worker, const std::function<void()>& task) {
+    enqueue(workers[worker % static_cast<int>(workers.size())], task, true);
+}
+
+// Add to a deque and wake workers
+void ThreadPool::enqueue(Worker* worker, const std::function<void()>& task, bool own) {
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        pending++;
+    }
+    {
+        std::unique_lock<std::mutex> lock(worker->mtx);
+        if (own) {
+            worker->ownTasks.push_back(task);
+            worker->nOwnTasks++;
+        } else {
+            worker->tasks.push_back(task);
+            queued++;
+        }
+    }
+    {
+        // Notify under the sleep mutex so no idle worker misses the task;
+        // a worker-bound task must reach its worker, so wake all
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (own) {
+            wakeUp.notify_all();
+        } else {
+            wakeUp.notify_one();
+        }
+    }
+}
+
+// Worker-bound tasks first (FIFO), then own deque newest-first (LIFO),
+// otherwise steal oldest (FIFO) from others
+bool ThreadPool::popTask(int self, std::function<void()>& task) {
+    int n = static_cast<int>(workers.size());
+    {
+        Worker* own = workers[self];
+        std::unique_lock<std::mutex> lock(own->mtx);
+        if (!own->ownTasks.empty()) {
+            task = own->ownTasks.front();
+            own->ownTasks.pop_front();
+            own->nOwnTasks--;
+            return true;
+        }
+        if (!own->tasks.empty()) {
+            task = own->tasks.back();
+            own->tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    for (int k = 1; k < n; k++) {
+        Worker* victim = workers[(self + k) % n];
+        std::unique_lock<std::mutex> lock(victim->mtx);
+        if (!victim->tasks.empty()) {
+            task = victim->tasks.front();
+            victim->tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Worker main loop
+void ThreadPool::workerLoop(int self) {
+    currentPool = this;
+    currentWorker = self;
+    
+    while (true) {
+        std::function<void()> task;
+        if (popTask(self, task)) {
+            try {
+                task();
+            } catch (...) {
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            pending--;
+            if (pending == 0) {
+                allDone.notify_all();
+            }
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        Worker* own = workers[self];
+        wakeUp.wait(lock, [this, own]() { return stopping || queued > 0 || own->nOwnTasks > 0; });
+        if (stopping && queued == 0 && own->nOwnTasks == 0) {
+            return;
+        }
+    }
+}
+
+// Calling worker
+int ThreadPool::currentWorkerIndex() const {
+    return (currentPool == this) ? currentWorker : -1;
+}
+
+// Wait for all tasks
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    allDone.wait(lock, [this]() { return pending == 0; });
+    if (firstError) {
+        std::exception_ptr error = firstError;
+        firstError = std::exception_ptr();
+        std::rethrow_exception(error);
+    }
+}
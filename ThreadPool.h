@@ -0,0 +1,85 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+// Work-stealing thread pool
+// Each worker owns a task deque: it pops its own newest task first and,
+// when idle, steals the oldest task of another worker. Tasks submitted from
+// inside a worker go to that worker's deque (good locality for nested work);
+// tasks submitted from outside are dealt round-robin.
+// Workers can be pinned one per CPU, and submitTo() queues a task that only
+// its worker runs (never stolen): data a worker allocated and first touched
+// is then processed by the same core, on its NUMA node.
+class ThreadPool {
+private:
+    struct Worker {
+        std::deque<std::function<void()> > tasks;
+        std::deque<std::function<void()> > ownTasks;   // submitTo: not stealable
+        std::atomic<int> nOwnTasks;
+        int cpu;                                       // Pinned CPU (-1: not pinned)
+        std::mutex mtx;
+        Worker() : nOwnTasks(0), cpu(-1) {}
+    };
+    
+    std::vector<Worker*> workers;
+    std::vector<std::thread> threads;
+    
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;     // Signals idle workers
+    std::condition_variable allDone;    // Signals wait()
+    std::atomic<int> queued;            // Tasks sitting in deques
+    int pending;                        // Queued + running tasks (guarded by sleepMutex)
+    bool stopping;
+    std::atomic<unsigned int> nextWorker;  // Round-robin target for external submits
+    std::exception_ptr firstError;         // First exception thrown by a task
+    
+    // Take a task from own deque or steal one; false if all deques empty
+    bool popTask(int self, std::function<void()>& task);
+    
+    // Worker thread main loop
+    void workerLoop(int self);
+    
+    // Bind worker threads to distinct CPUs of the process affinity mask
+    void pinWorkers();
+    
+    // Count a new task and wake workers
+    void enqueue(Worker* worker, const std::function<void()>& task, bool own);
+    
+public:
+    // Constructor: nThreads <= 0 uses the hardware concurrency
+    // pinThreads: bind worker i to the i-th allowed CPU (round-robin if
+    // there are more workers than CPUs)
+    ThreadPool(int nThreads = 0, bool pinThreads = false);
+    
+    // Destructor: finishes queued tasks, then joins workers
+    ~ThreadPool();
+    
+    // Queue a task
+    void submit(const std::function<void()>& task);
+    
+    // Queue a task that runs on the given worker only
+    void submitTo(int worker, const std::function<void()>& task);
+    
+    // Block until every submitted task has run
+    // Rethrows the first exception raised by a task, if any
+    void wait();
+    
+    // Get number of worker threads
+    int getNThreads() const { return static_cast<int>(threads.size()); }
+    
+    // CPU worker i is pinned to (-1 if not pinned)
+    int getWorkerCpu(int i) const { return workers[i]->cpu; }
+    
+    // Index of the calling worker in this pool (-1 from other threads)
+    int currentWorkerIndex() const;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "TimeGrid.h"
+#include <cmath>
+#include <algorithm>
+
+// Constructor
+TimeGrid::TimeGrid() {
+    times.push_back(0.0);
+}
+
+// Uniform grid
+TimeGrid TimeGrid::uniform(double T, int nSteps) {
+    TimeGrid grid;
+    double dt = T / static_cast<double>(nSteps);
+    for (int j = 1; j <= nSteps; j++) {
+        grid.times.push_back((j == nSteps) ? T : j * dt);
+    }
+    return grid;
+}
+
+// Grid through the exercise dates
+TimeGrid TimeGrid::fromSchedule(const std::vector<double>& dates, double maxDt,
+                                int minStepsPerInterval) {
+    TimeGrid grid;
+    double previous = 0.0;
+    for (size_t m = 0; m < dates.size(); m++) {
+        double length = dates[m] - previous;
+        if (length > 0.0) {
+            // Small tolerance: an interval of exactly k * maxDt takes k steps
+            int n = static_cast<int>(ceil(length / maxDt - 1e-9));
+            n = std::max(n, std::max(minStepsPerInterval, 1));
+            for (int k = 1; k < n; k++) {
+                grid.times.push_back(previous + length * k / n);
+            }
+            grid.times.push_back(dates[m]);   // Date itself, exactly
+            previous = dates[m];
+        }
+        grid.exerciseSteps.push_back(grid.getNSteps());
+    }
+    return grid;
+}
+
+TimeGrid TimeGrid::fromSchedule(const BermudanOption& option, double maxDt,
+                                int minStepsPerInterval) {
+    return fromSchedule(option.getExerciseDates(), maxDt, minStepsPerInterval);
+}
+
+// Nested refinement of a schedule: the periods' interior points are
+// previous + length * k / 2^n, so every coarser refinement's points recur
+// exactly (k even); the dates themselves are copied
+std::vector<double> TimeGrid::refineSchedule(const std::vector<double>& dates, int nBisections) {
+    int parts = 1 << nBisections;
+    std::vector<double> refined;
+    double previous = 0.0;
+    for (size_t m = 0; m < dates.size(); m++) {
+        double length = dates[m] - previous;
+        for (int k = 1; k < parts; k++) {
+            refined.push_back(previous + length * k / parts);
+        }
+        refined.push_back(dates[m]);
+        previous = dates[m];
+    }
+    return refined;
+}
+
+// Largest step
+double TimeGrid::getMaxDt() const {
+    double largest = 0.0;
+    for (int j = 0; j < getNSteps(); j++) {
+        largest = std::max(largest, getDt(j));
+    }
+    return largest;
+}
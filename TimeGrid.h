@@ -0,0 +1,51 @@
+#ifndef TIMEGRID_H
+#define TIMEGRID_H
+
+#include "BermudanOption.h"
+#include <vector>
+
+// Simulation time grid 0 = t_0 < t_1 < ... < t_N = T
+// Built from an exercise schedule, every exercise date is a grid point
+// (no rounding of dates to the nearest step) and each interval between
+// consecutive dates gets its own step count, so long stubs no longer cost
+// steps where none are needed and short ones are not skipped.
+class TimeGrid {
+private:
+    std::vector<double> times;        // t_0 .. t_N
+    std::vector<int> exerciseSteps;   // Grid index of each exercise date
+    
+public:
+    // Constructor (empty grid: t_0 = 0 only)
+    TimeGrid();
+    
+    // Uniform grid j * (T / nSteps)
+    static TimeGrid uniform(double T, int nSteps);
+    
+    // Grid through every date of an ascending schedule: the interval
+    // ending at a date gets ceil(length / maxDt) equal steps, at least
+    // minStepsPerInterval
+    static TimeGrid fromSchedule(const std::vector<double>& dates, double maxDt,
+                                 int minStepsPerInterval = 1);
+    static TimeGrid fromSchedule(const BermudanOption& option, double maxDt,
+                                 int minStepsPerInterval = 1);
+    
+    // Schedule with every period, [0, first date] included, split into
+    // 2^nBisections equal parts: nested (each refinement contains the
+    // dates of the coarser ones, bit for bit) and ending on the same dates
+    static std::vector<double> refineSchedule(const std::vector<double>& dates, int nBisections);
+    
+    // Grid points
+    int getNSteps() const { return static_cast<int>(times.size()) - 1; }
+    double getTime(int j) const { return times[j]; }
+    double getDt(int j) const { return times[j + 1] - times[j]; }   // Step j: t_j -> t_{j+1}
+    double getT() const { return times.back(); }
+    
+    // Exercise dates the grid was built from (none for uniform grids)
+    int getNExerciseDates() const { return static_cast<int>(exerciseSteps.size()); }
+    int getExerciseStep(int m) const { return exerciseSteps[m]; }
+    
+    // Largest step
+    double getMaxDt() const;
+};
+
+#endif
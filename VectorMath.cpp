@@ -0,0 +1,495 @@
+#include "VectorMath.h"
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTORMATH_X86 1
+#endif
+
+// Every kernel relies on separately rounded multiplies and adds (Dekker
+// products, TwoSum, identical results on every instruction set): no FMA
+// contraction, whatever the build flags
+#pragma GCC optimize ("fp-contract=off")
+
+#define VM_INLINE inline __attribute__((always_inline))
+
+// Lane types (GCC vector extensions)
+typedef double v2d __attribute__((vector_size(16)));
+typedef long long v2i __attribute__((vector_size(16)));
+typedef unsigned long long v2u __attribute__((vector_size(16)));
+typedef double v4d __attribute__((vector_size(32)));
+typedef long long v4i __attribute__((vector_size(32)));
+typedef unsigned long long v4u __attribute__((vector_size(32)));
+typedef double v8d __attribute__((vector_size(64)));
+typedef long long v8i __attribute__((vector_size(64)));
+typedef unsigned long long v8u __attribute__((vector_size(64)));
+
+// Kernel instantiations: value, mask / integer and unsigned lane types
+struct Lanes2 { typedef v2d V; typedef v2i I; typedef v2u U; enum { W = 2 }; };
+struct Lanes4 { typedef v4d V; typedef v4i I; typedef v4u U; enum { W = 4 }; };
+struct Lanes8 { typedef v8d V; typedef v8i I; typedef v8u U; enum { W = 8 }; };
+
+// Round to nearest: (x + 1.5 * 2^52) - 1.5 * 2^52; the low bits of the sum
+// hold the integer
+const double ROUND_MAGIC = 6755399441055744.0;
+const long long ROUND_MAGIC_BITS = 0x4338000000000000LL;
+const unsigned long long ABS_MASK = 0x7fffffffffffffffULL;
+
+const double LOG2E = 1.44269504088896338700e+00;
+const double LN2_HI = 6.93147180369123816490e-01;   // 32 bits: n * LN2_HI exact
+const double LN2_LO = 1.90821492927058770002e-10;
+const double SQRT2 = 1.41421356237309504880e+00;
+const double SPLITTER = 134217729.0;                 // 2^27 + 1 (Dekker split)
+
+// log(1 + f) = f - hfsq + s * (hfsq + R(s^2)), s = f / (2 + f) (fdlibm)
+const double LG1 = 6.666666666666735130e-01;
+const double LG2 = 3.999999999940941908e-01;
+const double LG3 = 2.857142874366239149e-01;
+const double LG4 = 2.222219843214978396e-01;
+const double LG5 = 1.818357216161805012e-01;
+const double LG6 = 1.531383769920937332e-01;
+const double LG7 = 1.479819860511658591e-01;
+
+// pi/2 in 33-bit pieces (n * piece exact for |n| < 2^20) and a tail
+const double TWO_OVER_PI = 6.36619772367581382433e-01;
+const double PIO2_1 = 1.57079632673412561417e+00;
+const double PIO2_2 = 6.07710050630396597660e-11;
+const double PIO2_3 = 2.02226624871116645580e-21;
+const double PIO2_3T = 8.47842766036889956997e-32;
+
+// sin and cos on [-pi/4, pi/4] (fdlibm __kernel_sin / __kernel_cos)
+const double S1 = -1.66666666666666324348e-01;
+const double S2 = 8.33333333332248946124e-03;
+const double S3 = -1.98412698298579493134e-04;
+const double S4 = 2.75573137070700676789e-06;
+const double S5 = -2.50507602534068634195e-08;
+const double S6 = 1.58969099521155010221e-10;
+const double C1 = 4.16666666666666019037e-02;
+const double C2 = -1.38888888888741095749e-03;
+const double C3 = 2.48015872894767294178e-05;
+const double C4 = -2.75573143513906633035e-07;
+const double C5 = 2.08757232129817482790e-09;
+const double C6 = -1.13596475577881948265e-11;
+
+// Fast-path limits
+const double EXP_LIMIT = 708.0;
+const double POW_Y_LIMIT = 4.0;
+const double SINCOS_LIMIT = 1.0e6;
+
+// Lane loads and stores (the last partial vector is padded with fill)
+template <class T>
+static VM_INLINE void loadLanes(typename T::V& v, const double* x, int count, double fill) {
+    if (count >= T::W) {
+        memcpy(&v, x, sizeof(v));
+    } else {
+        v = typename T::V() + fill;
+        memcpy(&v, x, count * sizeof(double));
+    }
+}
+
+template <class T>
+static VM_INLINE void storeLanes(double* y, const typename T::V& v, int count) {
+    memcpy(y, &v, (count >= T::W ? T::W : count) * sizeof(double));
+}
+
+// Fast-path tests on bit patterns: a lane is outside [lo, hi] if (b - lo)
+// or (hi - b) wraps, so the test is one compare however many ranges are
+// combined (GCC lowers a mask made of several vector compares inside these
+// templates lane by lane for the AVX-512 instantiation)
+static VM_INLINE unsigned long long bitsOf(double x) {
+    unsigned long long b;
+    memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+// fail is nonzero in the lanes whose bit pattern b lies outside [lo, hi]
+template <class T>
+static VM_INLINE void markOutside(const typename T::U& b, unsigned long long lo, unsigned long long hi,
+                                  typename T::U& fail) {
+    fail |= ((b - lo) | (hi - b)) >> 63;
+}
+
+template <class T>
+static VM_INLINE bool allLanes(const typename T::I& mask) {
+    for (int k = 0; k < T::W; k++) {
+        if (!mask[k]) return false;
+    }
+    return true;
+}
+
+// exp(hi + lo) for |hi| <= EXP_LIMIT
+// hi = n ln2 + r, exp = 2^n * exp(r + lo), exp on |r| <= ln2/2 by its
+// Taylor series to degree 13 (truncation < 2^-57)
+template <class T>
+static VM_INLINE void expKernel(const typename T::V& hi, const typename T::V& lo, typename T::V& y) {
+    typedef typename T::V V;
+    typedef typename T::I I;
+    V t = hi * LOG2E + ROUND_MAGIC;
+    V n = t - ROUND_MAGIC;
+    V r = (hi - n * LN2_HI) - n * LN2_LO + lo;
+    V p = r * (1.0 / 6227020800.0) + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+    I scale = (((I)t - ROUND_MAGIC_BITS) + 1023) << 52;
+    y = p * (V)scale;
+}
+
+// x = 2^k * m, m in [sqrt(2)/2, sqrt(2)), f = m - 1:
+// log(x) = k ln2 + f - (hfsq - sR)
+template <class T>
+static VM_INLINE void logReduce(const typename T::V& x, typename T::V& dk, typename T::V& f,
+                                typename T::V& hfsq, typename T::V& sR) {
+    typedef typename T::V V;
+    typedef typename T::I I;
+    typedef typename T::U U;
+    I bits = (I)x;
+    I k = (I)((U)bits >> 52) - 1023;
+    V m = (V)((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+    I big = m > SQRT2;
+    m = big ? m * 0.5 : m;
+    k = k - big;
+    f = m - 1.0;
+    hfsq = 0.5 * f * f;
+    V s = f / (2.0 + f);
+    V z = s * s;
+    V w = z * z;
+    V t1 = w * (LG2 + w * (LG4 + w * LG6));
+    V t2 = z * (LG1 + w * (LG3 + w * (LG5 + w * LG7)));
+    sR = s * (hfsq + (t2 + t1));
+    dk = (V)(k + ROUND_MAGIC_BITS) - ROUND_MAGIC;
+}
+
+template <class T>
+static VM_INLINE void logKernel(const typename T::V& x, typename T::V& y) {
+    typename T::V dk, f, hfsq, sR;
+    logReduce<T>(x, dk, f, hfsq, sR);
+    y = dk * LN2_HI - ((hfsq - (sR + dk * LN2_LO)) - f);
+}
+
+// x^y = exp(y log x); y * k ln2_hi is kept exact as a double-double so the
+// exponent's rounding does not grow with |y log x| (ph: y log x rounded)
+template <class T>
+static VM_INLINE void powKernel(const typename T::V& x, const typename T::V& y,
+                                typename T::V& r, typename T::V& ph) {
+    typedef typename T::V V;
+    V dk, f, hfsq, sR;
+    logReduce<T>(x, dk, f, hfsq, sR);
+    V a = dk * LN2_HI;
+    V b = (f - (hfsq - sR)) + dk * LN2_LO;
+    ph = y * a;
+    V c = y * SPLITTER;
+    V yh = c - (c - y);
+    V yl = y - yh;
+    c = a * SPLITTER;
+    V ah = c - (c - a);
+    V al = a - ah;
+    V pl = ((yh * ah - ph) + yh * al + yl * ah) + yl * al;
+    // Renormalize ph + lo (TwoSum) so the reduction sees the whole exponent
+    V lo = pl + y * b;
+    V hi = ph + lo;
+    V bb = hi - ph;
+    lo = (ph - (hi - bb)) + (lo - bb);
+    ph = hi;
+    expKernel<T>(hi, lo, r);
+}
+
+// Reduce by n pi/2 (Cody-Waite), kernels on [-pi/4, pi/4], select by n mod 4
+template <class T>
+static VM_INLINE void sincosKernel(const typename T::V& x, typename T::V& s, typename T::V& c) {
+    typedef typename T::V V;
+    typedef typename T::I I;
+    typedef typename T::U U;
+    V q = x * TWO_OVER_PI + ROUND_MAGIC;
+    V n = q - ROUND_MAGIC;
+    I ni = (I)q - ROUND_MAGIC_BITS;
+    V r = (((x - n * PIO2_1) - n * PIO2_2) - n * PIO2_3) - n * PIO2_3T;
+    V z = r * r;
+    V v = z * r;
+    V sinR = r + v * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+    V w = z * z;
+    V cr = z * (C1 + z * (C2 + z * C3)) + w * w * (C4 + z * (C5 + z * C6));
+    V hz = 0.5 * z;
+    w = 1.0 - hz;
+    V cosR = w + (((1.0 - w) - hz) + z * cr);
+    I swap = -(ni & 1);
+    V sv = swap ? cosR : sinR;
+    V cv = swap ? sinR : cosR;
+    s = (V)((U)sv ^ ((U)(ni & 2) << 62));
+    c = (V)((U)cv ^ ((U)((ni + 1) & 2) << 62));
+}
+
+// Array loops; lanes outside the fast path are recomputed with libm
+template <class T>
+static VM_INLINE void logArray(const double* x, double* y, int n) {
+    typedef typename T::V V;
+    typedef typename T::I I;
+    typedef typename T::U U;
+    for (int i = 0; i < n; i += T::W) {
+        V xv, r;
+        loadLanes<T>(xv, x + i, n - i, 1.0);
+        U fail = U();
+        markOutside<T>((U)xv, bitsOf(DBL_MIN), bitsOf(DBL_MAX), fail);
+        I ok = fail == 0;
+        logKernel<T>(xv, r);
+        if (!allLanes<T>(ok)) {
+            for (int k = 0; k < T::W; k++) {
+                if (!ok[k]) r[k] = std::log(xv[k]);
+            }
+        }
+        storeLanes<T>(y + i, r, n - i);
+    }
+}
+
+template <class T>
+static VM_INLINE void expArray(const double* x, double* y, int n) {
+    typedef typename T::V V;
+    typedef typename T::I I;
+    typedef typename T::U U;
+    for (int i = 0; i < n; i += T::W) {
+        V xv, r;
+        loadLanes<T>(xv, x + i, n - i, 0.0);
+        U fail = U();
+        markOutside<T>((U)xv & ABS_MASK, 0, bitsOf(EXP_LIMIT), fail);
+        I ok = fail == 0;
+        expKernel<T>(xv, V(), r);
+        if (!allLanes<T>(ok)) {
+            for (int k = 0; k < T::W; k++) {
+                if (!ok[k]) r[k] = std::exp(xv[k]);
+            }
+        }
+        storeLanes<T>(y + i, r, n - i);
+    }
+}
+
+// Exponent y[i] (yStride 1) or y[0] for every lane (yStride 0)
+template <class T>
+static VM_INLINE void powArray(const double* x, const double* y, int yStride, double* r, int n) {
+    typedef typename T::V V;
+    typedef typename T::I I;
+    typedef typename T::U U;
+    V ySplat = V() + y[0];
+    for (int i = 0; i < n; i += T::W) {
+        V xv, yv = ySplat, rv, hi;
+        loadLanes<T>(xv, x + i, n - i, 1.0);
+        if (yStride) loadLanes<T>(yv, y + i, n - i, 1.0);
+        powKernel<T>(xv, yv, rv, hi);
+        U fail = U();
+        markOutside<T>((U)xv, bitsOf(DBL_MIN), bitsOf(DBL_MAX), fail);
+        markOutside<T>((U)yv & ABS_MASK, 0, bitsOf(POW_Y_LIMIT), fail);
+        markOutside<T>((U)hi & ABS_MASK, 0, bitsOf(EXP_LIMIT), fail);
+        I ok = fail == 0;
+        if (!allLanes<T>(ok)) {
+            for (int k = 0; k < T::W; k++) {
+                if (!ok[k]) rv[k] = std::pow(xv[k], yv[k]);
+            }
+        }
+        storeLanes<T>(r + i, rv, n - i);
+    }
+}
+
+template <class T>
+static VM_INLINE void sincosArray(const double* x, double* s, double* c, int n) {
+    typedef typename T::V V;
+    typedef typename T::I I;
+    typedef typename T::U U;
+    for (int i = 0; i < n; i += T::W) {
+        V xv, sv, cv;
+        loadLanes<T>(xv, x + i, n - i, 0.0);
+        U fail = U();
+        markOutside<T>((U)xv & ABS_MASK, 0, bitsOf(SINCOS_LIMIT), fail);
+        I ok = fail == 0;
+        sincosKernel<T>(xv, sv, cv);
+        if (!allLanes<T>(ok)) {
+            for (int k = 0; k < T::W; k++) {
+                if (!ok[k]) {
+                    sv[k] = std::sin(xv[k]);
+                    cv[k] = std::cos(xv[k]);
+                }
+            }
+        }
+        storeLanes<T>(s + i, sv, n - i);
+        storeLanes<T>(c + i, cv, n - i);
+    }
+}
+
+// Entry points of one instruction set
+struct VectorKernels {
+    void (*log)(const double*, double*, int);
+    void (*exp)(const double*, double*, int);
+    void (*sqrt)(const double*, double*, int);
+    void (*pow)(const double*, const double*, int, double*, int);
+    void (*sincos)(const double*, double*, double*, int);
+};
+
+static void logPortable(const double* x, double* y, int n) { logArray<Lanes2>(x, y, n); }
+static void expPortable(const double* x, double* y, int n) { expArray<Lanes2>(x, y, n); }
+static void sqrtPortable(const double* x, double* y, int n) {
+    for (int i = 0; i < n; i++) {
+        y[i] = std::sqrt(x[i]);
+    }
+}
+static void powPortable(const double* x, const double* y, int yStride, double* r, int n) {
+    powArray<Lanes2>(x, y, yStride, r, n);
+}
+static void sincosPortable(const double* x, double* s, double* c, int n) {
+    sincosArray<Lanes2>(x, s, c, n);
+}
+
+static const VectorKernels portableKernels = {
+    logPortable, expPortable, sqrtPortable, powPortable, sincosPortable
+};
+
+#ifdef VECTORMATH_X86
+#define VM_AVX2 __attribute__((target("avx2")))
+#define VM_AVX512 __attribute__((target("avx512f,avx512dq")))
+
+VM_AVX2 static void logAvx2(const double* x, double* y, int n) { logArray<Lanes4>(x, y, n); }
+VM_AVX2 static void expAvx2(const double* x, double* y, int n) { expArray<Lanes4>(x, y, n); }
+VM_AVX2 static void sqrtAvx2(const double* x, double* y, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(y + i, _mm256_sqrt_pd(_mm256_loadu_pd(x + i)));
+    }
+    sqrtPortable(x + i, y + i, n - i);
+}
+VM_AVX2 static void powAvx2(const double* x, const double* y, int yStride, double* r, int n) {
+    powArray<Lanes4>(x, y, yStride, r, n);
+}
+VM_AVX2 static void sincosAvx2(const double* x, double* s, double* c, int n) {
+    sincosArray<Lanes4>(x, s, c, n);
+}
+
+VM_AVX512 static void logAvx512(const double* x, double* y, int n) { logArray<Lanes8>(x, y, n); }
+VM_AVX512 static void expAvx512(const double* x, double* y, int n) { expArray<Lanes8>(x, y, n); }
+VM_AVX512 static void sqrtAvx512(const double* x, double* y, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(y + i, _mm512_maskz_sqrt_pd(0xff, _mm512_loadu_pd(x + i)));
+    }
+    sqrtPortable(x + i, y + i, n - i);
+}
+VM_AVX512 static void powAvx512(const double* x, const double* y, int yStride, double* r, int n) {
+    powArray<Lanes8>(x, y, yStride, r, n);
+}
+VM_AVX512 static void sincosAvx512(const double* x, double* s, double* c, int n) {
+    sincosArray<Lanes8>(x, s, c, n);
+}
+
+static const VectorKernels avx2Kernels = {
+    logAvx2, expAvx2, sqrtAvx2, powAvx2, sincosAvx2
+};
+static const VectorKernels avx512Kernels = {
+    logAvx512, expAvx512, sqrtAvx512, powAvx512, sincosAvx512
+};
+#endif
+
+// Active instruction set (-1 until first use)
+static std::atomic<int> activeIsa(-1);
+
+static const VectorKernels* kernels() {
+    switch (VectorMath::getIsa()) {
+#ifdef VECTORMATH_X86
+        case ISA_AVX512: return &avx512Kernels;
+        case ISA_AVX2: return &avx2Kernels;
+#endif
+        default: return &portableKernels;
+    }
+}
+
+// Scalar versions: one lane of the portable kernels
+double VectorMath::log(double x) {
+    double y;
+    logPortable(&x, &y, 1);
+    return y;
+}
+
+double VectorMath::exp(double x) {
+    double y;
+    expPortable(&x, &y, 1);
+    return y;
+}
+
+double VectorMath::pow(double x, double y) {
+    double r;
+    powPortable(&x, &y, 0, &r, 1);
+    return r;
+}
+
+double VectorMath::sqrt(double x) {
+    return std::sqrt(x);
+}
+
+void VectorMath::sincos(double x, double& s, double& c) {
+    sincosPortable(&x, &s, &c, 1);
+}
+
+// Array versions on the active instruction set
+void VectorMath::log(const double* x, double* y, int n) {
+    kernels()->log(x, y, n);
+}
+
+void VectorMath::exp(const double* x, double* y, int n) {
+    kernels()->exp(x, y, n);
+}
+
+void VectorMath::sqrt(const double* x, double* y, int n) {
+    kernels()->sqrt(x, y, n);
+}
+
+void VectorMath::pow(const double* x, double y, double* r, int n) {
+    kernels()->pow(x, &y, 0, r, n);
+}
+
+void VectorMath::pow(const double* x, const double* y, double* r, int n) {
+    kernels()->pow(x, y, 1, r, n);
+}
+
+void VectorMath::sincos(const double* x, double* s, double* c, int n) {
+    kernels()->sincos(x, s, c, n);
+}
+
+// Instruction set selection
+VectorIsa VectorMath::detectIsa() {
+#ifdef VECTORMATH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) return ISA_AVX512;
+    if (__builtin_cpu_supports("avx2")) return ISA_AVX2;
+#endif
+    return ISA_PORTABLE;
+}
+
+VectorIsa VectorMath::getIsa() {
+    int isa = activeIsa.load(std::memory_order_relaxed);
+    if (isa < 0) {
+        isa = detectIsa();
+        activeIsa.store(isa, std::memory_order_relaxed);
+    }
+    return static_cast<VectorIsa>(isa);
+}
+
+VectorIsa VectorMath::setIsa(VectorIsa isa) {
+    VectorIsa best = detectIsa();
+    activeIsa.store(isa <= best ? isa : best, std::memory_order_relaxed);
+    return getIsa();
+}
+
+const char* VectorMath::isaName(VectorIsa isa) {
+    switch (isa) {
+        case ISA_AVX512: return "avx512";
+        case ISA_AVX2: return "avx2";
+        default: return "portable";
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef VECTORMATH_H
+#define VECTORMATH_H
+
+// Instruction sets of the vector kernels
+enum VectorIsa { ISA_PORTABLE, ISA_AVX2, ISA_AVX512 };
+
+// Vectorized elementary functions for the simulation hot loop
+// log, exp, pow, sqrt and sincos over arrays, without libm calls, so a
+// step of many paths runs in SIMD registers. One kernel per function is
+// written once on GCC vector types and instantiated for 2 lanes (portable
+// baseline: SSE2 on x86-64, generic elsewhere), 4 lanes (AVX2) and 8 lanes
+// (AVX-512F+DQ); the widest the CPU supports is selected at run time.
+//
+// Every lane performs the same IEEE operations in the same order (FMA
+// contraction is off in VectorMath.cpp), so all instruction sets and the
+// scalar overloads give bit for bit the same results and a path simulated
+// alone matches the same path simulated in a batch.
+//
+// Accuracy against glibc, fast-path domain (measured by test_vector_math):
+//   log     x in [DBL_MIN, DBL_MAX]                   <= 1 ulp
+//   exp     |x| <= 708                                <= 1 ulp
+//   pow     x in [DBL_MIN, DBL_MAX], |y log x| <= 708,
+//           |y| <= 1                                  <= 2 ulp
+//           |y| <= 4                                  <= 4 ulp
+//   sqrt    correctly rounded (hardware)
+//   sincos  [0, 2 pi)                                 <= 1 ulp
+//           |x| <= 1e6                                <= 2 ulp
+// Arguments outside the fast path (zero, negative, subnormal, infinite, NaN,
+// overflowing results, large pow exponents, huge angles) fall back to libm
+// lane by lane, so special values follow libm exactly.
+class VectorMath {
+public:
+    // Scalar versions (same results as the array versions)
+    static double log(double x);
+    static double exp(double x);
+    static double pow(double x, double y);
+    static double sqrt(double x);
+    static void sincos(double x, double& s, double& c);
+
+    // y[i] = f(x[i]), i < n (in place allowed)
+    static void log(const double* x, double* y, int n);
+    static void exp(const double* x, double* y, int n);
+    static void sqrt(const double* x, double* y, int n);
+    static void pow(const double* x, double y, double* r, int n);
+    static void pow(const double* x, const double* y, double* r, int n);
+    static void sincos(const double* x, double* s, double* c, int n);
+
+    // Instruction set in use (best supported by default)
+    static VectorIsa getIsa();
+
+    // Use isa if the CPU supports it; returns the instruction set now in use
+    static VectorIsa setIsa(VectorIsa isa);
+
+    // Best instruction set of this CPU
+    static VectorIsa detectIsa();
+
+    static const char* isaName(VectorIsa isa);
+};
+
+#endif
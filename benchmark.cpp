@@ -0,0 +1,528 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <algorithm>
+#include "RandomGenerator.h"
+#include "SABRSimulator.h"
+#include "BermudanOption.h"
+#include "PolynomialRegression.h"
+#include "LSMPricer.h"
+#include "PolicyPricer.h"
+#include "ThreadPool.h"
+#include "ShardedPricer.h"
+#include "Instrumentation.h"
+#include "VectorMath.h"
+
+using namespace std;
+
+// Micro and macro benchmarks
+// Usage: benchmark [--quick] [--threads 1,2,4] [--output FILE]
+//                  [--baseline FILE] [--threshold 0.10]
+// Results go to stdout as tab-separated "name value unit" lines; every value
+// is a throughput (higher is better). With --baseline, results are compared
+// to a previous --output file and the exit code is 2 if any benchmark is
+// slower than the baseline by more than the threshold (relative).
+
+struct BenchResult {
+    string name;
+    double value;
+    string unit;
+};
+
+static const unsigned int BENCH_SEED = 12345;
+
+// Run body() until at least minSeconds have elapsed, best of nRepeats;
+// returns work units per second (body returns the units it processed)
+template <typename Body>
+static double bestThroughput(Body body, int nRepeats = 3, double minSeconds = 0.2) {
+    double best = 0.0;
+    for (int rep = 0; rep < nRepeats; rep++) {
+        double units = 0.0;
+        double start = Instrumentation::wallTime();
+        double elapsed = 0.0;
+        do {
+            units += body();
+            elapsed = Instrumentation::wallTime() - start;
+        } while (elapsed < minSeconds);
+        best = max(best, units / elapsed);
+    }
+    return best;
+}
+
+// Normal variates per second from RandomGenerator
+static BenchResult benchNormals() {
+    RandomGenerator rng(BENCH_SEED);
+    volatile double sink = 0.0;
+    const int n = 1 << 20;
+    double rate = bestThroughput([&]() {
+        double sum = 0.0;
+        for (int i = 0; i < n; i++) {
+            sum += rng.generateNormal();
+        }
+        sink = sink + sum;
+        return static_cast<double>(n);
+    });
+    BenchResult r = {"rng_normals", rate, "normals/s"};
+    return r;
+}
+
+// Euler steps per second in SABRSimulator::simulatePath
+static BenchResult benchSimulatePath() {
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, BENCH_SEED);
+    const int nSteps = 75;
+    const int nPaths = 1000;
+    vector<double> F(nSteps + 1), alpha(nSteps + 1);
+    double rate = bestThroughput([&]() {
+        for (int i = 0; i < nPaths; i++) {
+            sim.simulatePath(nSteps, 0.75, &F[0], &alpha[0]);
+        }
+        return static_cast<double>(nPaths) * nSteps;
+    });
+    BenchResult r = {"sim_path_steps", rate, "steps/s"};
+    return r;
+}
+
+// Euler steps per second in SABRSimulator::simulatePaths (paths advanced
+// in lockstep blocks on the vector kernels)
+static BenchResult benchSimulatePaths() {
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, BENCH_SEED);
+    const int nSteps = 75;
+    const int nPaths = 1000;
+    vector<double> storage(2 * nPaths * (nSteps + 1));
+    vector<double*> F_rows(nPaths), alpha_rows(nPaths);
+    for (int i = 0; i < nPaths; i++) {
+        F_rows[i] = &storage[(2 * i) * (nSteps + 1)];
+        alpha_rows[i] = &storage[(2 * i + 1) * (nSteps + 1)];
+    }
+    double rate = bestThroughput([&]() {
+        sim.simulatePaths(nPaths, nSteps, 0.75, &F_rows[0], &alpha_rows[0]);
+        return static_cast<double>(nPaths) * nSteps;
+    });
+    BenchResult r = {"sim_lockstep_steps", rate, "steps/s"};
+    return r;
+}
+
+// Values per second of libm and of VectorMath on every supported
+// instruction set, over arrays of 4096 (Box-Muller and F^beta arguments)
+static void benchVectorMath(vector<BenchResult>& results) {
+    const int n = 4096;
+    RandomGenerator rng(BENCH_SEED);
+    vector<double> u(n), theta(n), F(n), out(n), out2(n);
+    for (int i = 0; i < n; i++) {
+        u[i] = 1.0 - rng.generateUniform();
+        theta[i] = 2.0 * 3.14159265358979323846 * rng.generateUniform();
+        F[i] = 50.0 + 100.0 * rng.generateUniform();
+    }
+    const char* names[] = {"log", "exp", "sqrt", "pow", "sincos"};
+
+    for (int f = 0; f < 5; f++) {
+        double rate = bestThroughput([&]() {
+            for (int i = 0; i < n; i++) {
+                switch (f) {
+                    case 0: out[i] = log(u[i]); break;
+                    case 1: out[i] = exp(-u[i]); break;
+                    case 2: out[i] = sqrt(F[i]); break;
+                    case 3: out[i] = pow(F[i], 0.5); break;
+                    default: out[i] = sin(theta[i]); out2[i] = cos(theta[i]); break;
+                }
+            }
+            return static_cast<double>(n);
+        }, 3, 0.05);
+        BenchResult r = {string("libm_") + names[f], rate, "values/s"};
+        results.push_back(r);
+    }
+
+    VectorIsa active = VectorMath::getIsa();
+    for (int isa = ISA_PORTABLE; isa <= VectorMath::detectIsa(); isa++) {
+        VectorMath::setIsa(static_cast<VectorIsa>(isa));
+        for (int f = 0; f < 5; f++) {
+            double rate = bestThroughput([&]() {
+                switch (f) {
+                    case 0: VectorMath::log(&u[0], &out[0], n); break;
+                    case 1: VectorMath::exp(&u[0], &out[0], n); break;
+                    case 2: VectorMath::sqrt(&F[0], &out[0], n); break;
+                    case 3: VectorMath::pow(&F[0], 0.5, &out[0], n); break;
+                    default: VectorMath::sincos(&theta[0], &out[0], &out2[0], n); break;
+                }
+                return static_cast<double>(n);
+            }, 3, 0.05);
+            BenchResult r = {string("vm_") + names[f] + "_" + VectorMath::isaName(static_cast<VectorIsa>(isa)),
+                             rate, "values/s"};
+            results.push_back(r);
+        }
+    }
+    VectorMath::setIsa(active);
+}
+
+// Points per second in PolynomialRegression::fit for nPoints points
+static BenchResult benchRegression(int nPoints) {
+    RandomGenerator rng(BENCH_SEED);
+    vector<double> F(nPoints), C(nPoints);
+    for (int i = 0; i < nPoints; i++) {
+        F[i] = 100.0 + 10.0 * rng.generateNormal();
+        C[i] = max(F[i] - 100.0, 0.0) + rng.generateNormal();
+    }
+    PolynomialRegression reg(3);
+    double rate = bestThroughput([&]() {
+        reg.fit(&F[0], &C[0], nPoints);
+        return static_cast<double>(nPoints);
+    });
+    ostringstream name;
+    name << "regression_fit_" << nPoints;
+    BenchResult r = {name.str(), rate, "points/s"};
+    return r;
+}
+
+// Backward induction only, on pre-simulated paths: LSMPricer::priceFromPaths
+// (per-path, boundary decision and subsampled regression) against the policy-based
+// PolicyPricer<VanillaCall> (same price)
+static void benchBackward(int nPaths, vector<BenchResult>& results) {
+    std::vector<double> exerciseDates = {0.25, 0.5, 0.75, 1.0};
+    BermudanOption option(100.0, exerciseDates, CALL);
+    int nSteps = LSMPricer::simulationSteps(option);
+    double T = exerciseDates.back();
+    double** F_paths = new double*[nPaths];
+    double** alpha_paths = new double*[nPaths];
+    for (int i = 0; i < nPaths; i++) {
+        F_paths[i] = new double[nSteps + 1];
+        alpha_paths[i] = new double[nSteps + 1];
+    }
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, BENCH_SEED);
+    sim.simulatePaths(nPaths, nSteps, T, F_paths, alpha_paths);
+
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    double rate = bestThroughput([&]() {
+        pricer.priceFromPaths(F_paths, alpha_paths, nPaths, nSteps, T, option);
+        return static_cast<double>(nPaths);
+    });
+    ostringstream name;
+    name << "lsm_backward_" << nPaths;
+    BenchResult r = {name.str(), rate, "paths/s"};
+    results.push_back(r);
+
+    pricer.setBoundaryDecision(true);
+    rate = bestThroughput([&]() {
+        pricer.priceFromPaths(F_paths, alpha_paths, nPaths, nSteps, T, option);
+        return static_cast<double>(nPaths);
+    });
+    name.str("");
+    name << "lsm_boundary_backward_" << nPaths;
+    BenchResult b = {name.str(), rate, "paths/s"};
+    results.push_back(b);
+
+    pricer.setBoundaryDecision(false);
+    pricer.setRegressionSubsampling(1000);
+    rate = bestThroughput([&]() {
+        pricer.priceFromPaths(F_paths, alpha_paths, nPaths, nSteps, T, option);
+        return static_cast<double>(nPaths);
+    });
+    name.str("");
+    name << "lsm_subsampled_backward_" << nPaths;
+    BenchResult s = {name.str(), rate, "paths/s"};
+    results.push_back(s);
+
+    PolicyPricer<VanillaCall> policy(VanillaCall(100.0), exerciseDates, 0.05);
+    rate = bestThroughput([&]() {
+        policy.priceFromPaths(F_paths, alpha_paths, nPaths, nSteps, T);
+        return static_cast<double>(nPaths);
+    });
+    name.str("");
+    name << "policy_backward_" << nPaths;
+    BenchResult q = {name.str(), rate, "paths/s"};
+    results.push_back(q);
+
+    for (int i = 0; i < nPaths; i++) {
+        delete[] F_paths[i];
+        delete[] alpha_paths[i];
+    }
+    delete[] F_paths;
+    delete[] alpha_paths;
+}
+
+// Paths per second for a full LSM pricing (simulation + backward induction)
+// One thread: LSMPricer::price. More threads: paths are simulated in
+// per-thread chunks on a ThreadPool (each path keeps its own RNG substream,
+// so the price is identical) and then priced with priceFromPaths.
+static BenchResult benchPricing(int nPaths, int nThreads, double& price) {
+    std::vector<double> exerciseDates = {0.25, 0.5, 0.75, 1.0};
+    BermudanOption option(100.0, exerciseDates, CALL);
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    SABRParameters params = {100.0, 0.20, 0.5, 0.4, -0.3};
+
+    double start = Instrumentation::wallTime();
+    if (nThreads <= 1) {
+        SABRSimulator sim(params, BENCH_SEED);
+        price = pricer.price(sim, option, nPaths);
+    } else {
+        int nSteps = LSMPricer::simulationSteps(option);
+        double T = exerciseDates.back();
+        double** F_paths = new double*[nPaths];
+        double** alpha_paths = new double*[nPaths];
+        for (int i = 0; i < nPaths; i++) {
+            F_paths[i] = new double[nSteps + 1];
+            alpha_paths[i] = new double[nSteps + 1];
+        }
+
+        ThreadPool pool(nThreads);
+        int chunk = (nPaths + nThreads - 1) / nThreads;
+        for (int first = 0; first < nPaths; first += chunk) {
+            int count = min(chunk, nPaths - first);
+            pool.submit([=]() {
+                SABRSimulator sim(params, BENCH_SEED);
+                sim.simulatePaths(count, nSteps, T, F_paths + first, alpha_paths + first, first);
+            });
+        }
+        pool.wait();
+        price = pricer.priceFromPaths(F_paths, alpha_paths, nPaths, nSteps, T, option);
+
+        for (int i = 0; i < nPaths; i++) {
+            delete[] F_paths[i];
+            delete[] alpha_paths[i];
+        }
+        delete[] F_paths;
+        delete[] alpha_paths;
+    }
+    double elapsed = Instrumentation::wallTime() - start;
+
+    ostringstream name;
+    name << "lsm_price_" << nPaths << "_t" << nThreads;
+    BenchResult r = {name.str(), nPaths / elapsed, "paths/s"};
+    return r;
+}
+
+// Paths per second for the NUMA-aware pricing: pinned pool, one shard per
+// worker, allocated, simulated, stepped and reduced by that worker only
+// (ShardedPricer::priceOnPool)
+static BenchResult benchPinnedPricing(int nPaths, int nThreads, double& price) {
+    std::vector<double> exerciseDates = {0.25, 0.5, 0.75, 1.0};
+    BermudanOption option(100.0, exerciseDates, CALL);
+    SABRParameters params = {100.0, 0.20, 0.5, 0.4, -0.3};
+    ThreadPool pool(nThreads, true);
+    ShardedPricer pricer(0.05, 3, nThreads);
+
+    double start = Instrumentation::wallTime();
+    price = pricer.priceOnPool(pool, params, BENCH_SEED, option, nPaths);
+    double elapsed = Instrumentation::wallTime() - start;
+
+    ostringstream name;
+    name << "numa_price_" << nPaths << "_t" << nThreads;
+    BenchResult r = {name.str(), nPaths / elapsed, "paths/s"};
+    return r;
+}
+
+// Paths per second for LSMPricer::priceRecompute (no path storage)
+// checkpointInterval 1: states saved at every date; 0: none (regenerated
+// from t = 0 for every date)
+// Paths per second for the American limit of a quarterly put: Richardson
+// over 4/8/16 dates on one simulation, and a dense 128-date Bermudan on the
+// same time step for comparison
+static void benchAmericanLimit(int nPaths, vector<BenchResult>& results) {
+    std::vector<double> quarterly = {0.25, 0.5, 0.75, 1.0};
+    std::vector<double> denseDates;
+    for (int k = 1; k <= 128; k++) {
+        denseDates.push_back(k / 128.0);
+    }
+    BermudanOption option(110.0, quarterly, PUT);
+    BermudanOption dense(110.0, denseDates, PUT);
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    pricer.setMaxTimeStep(1.0 / 128.0);
+
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, BENCH_SEED);
+    double start = Instrumentation::wallTime();
+    pricer.priceAmericanLimit(sim, option, nPaths, 3);
+    double elapsed = Instrumentation::wallTime() - start;
+    ostringstream name;
+    name << "lsm_american_limit_" << nPaths;
+    BenchResult r = {name.str(), nPaths / elapsed, "paths/s"};
+    results.push_back(r);
+
+    start = Instrumentation::wallTime();
+    pricer.price(sim, dense, nPaths);
+    elapsed = Instrumentation::wallTime() - start;
+    ostringstream denseName;
+    denseName << "lsm_american_dense128_" << nPaths;
+    BenchResult d = {denseName.str(), nPaths / elapsed, "paths/s"};
+    results.push_back(d);
+}
+
+static BenchResult benchRecompute(int nPaths, int checkpointInterval) {
+    std::vector<double> exerciseDates = {0.25, 0.5, 0.75, 1.0};
+    BermudanOption option(100.0, exerciseDates, CALL);
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, BENCH_SEED);
+
+    double start = Instrumentation::wallTime();
+    pricer.priceRecompute(sim, option, nPaths, checkpointInterval);
+    double elapsed = Instrumentation::wallTime() - start;
+
+    ostringstream name;
+    name << "lsm_recompute_" << nPaths << "_k" << checkpointInterval;
+    BenchResult r = {name.str(), nPaths / elapsed, "paths/s"};
+    return r;
+}
+
+// Read a previous --output file into name -> value
+static bool loadBaseline(const string& filename, map<string, double>& baseline) {
+    ifstream file(filename.c_str());
+    if (!file) {
+        return false;
+    }
+    string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        istringstream iss(line);
+        string name;
+        double value;
+        if (iss >> name >> value) {
+            baseline[name] = value;
+        }
+    }
+    return true;
+}
+
+// Parse "1,2,4"
+static vector<int> parseList(const string& text) {
+    vector<int> values;
+    istringstream iss(text);
+    string item;
+    while (getline(iss, item, ',')) {
+        int v = atoi(item.c_str());
+        if (v > 0) {
+            values.push_back(v);
+        }
+    }
+    return values;
+}
+
+int main(int argc, char* argv[]) {
+    bool quick = false;
+    string outputFile;
+    string baselineFile;
+    double threshold = 0.10;
+    vector<int> threadCounts;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--quick") {
+            quick = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threadCounts = parseList(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baselineFile = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else {
+            cerr << "Usage: " << argv[0]
+                 << " [--quick] [--threads 1,2,4] [--output FILE]"
+                 << " [--baseline FILE] [--threshold 0.10]" << endl;
+            return 1;
+        }
+    }
+
+    // Default thread counts: powers of two up to the hardware concurrency
+    if (threadCounts.empty()) {
+        int hardware = max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int t = 1; t <= hardware; t *= 2) {
+            threadCounts.push_back(t);
+        }
+        if (threadCounts.back() != hardware) {
+            threadCounts.push_back(hardware);
+        }
+    }
+
+    vector<BenchResult> results;
+
+    // Micro-benchmarks
+    cerr << "Micro-benchmarks..." << endl;
+    results.push_back(benchNormals());
+    results.push_back(benchSimulatePath());
+    results.push_back(benchSimulatePaths());
+    benchVectorMath(results);
+    int regressionSizes[] = {1000, 10000, 100000, 1000000};
+    for (int k = 0; k < (quick ? 3 : 4); k++) {
+        results.push_back(benchRegression(regressionSizes[k]));
+    }
+    benchBackward(100000, results);
+
+    // Macro-benchmarks
+    int pathCounts[] = {10000, 100000, 1000000};
+    for (int k = 0; k < (quick ? 2 : 3); k++) {
+        for (size_t t = 0; t < threadCounts.size(); t++) {
+            cerr << "LSM pricing: " << pathCounts[k] << " paths, "
+                 << threadCounts[t] << " thread(s)..." << endl;
+            double price = 0.0;
+            results.push_back(benchPricing(pathCounts[k], threadCounts[t], price));
+            cerr << "  price " << fixed << setprecision(6) << price << endl;
+            results.push_back(benchPinnedPricing(pathCounts[k], threadCounts[t], price));
+            cerr << "  pinned shards: price " << fixed << setprecision(6) << price << endl;
+        }
+    }
+
+    cerr << "LSM pricing, recomputed paths..." << endl;
+    results.push_back(benchRecompute(100000, 1));
+    results.push_back(benchRecompute(100000, 0));
+
+    cerr << "LSM pricing, American limit..." << endl;
+    benchAmericanLimit(100000, results);
+
+    // Machine-readable results
+    ostringstream table;
+    table << "# benchmark\tvalue\tunit" << endl;
+    table << setprecision(6) << scientific;
+    for (size_t i = 0; i < results.size(); i++) {
+        table << results[i].name << "\t" << results[i].value << "\t" << results[i].unit << endl;
+    }
+    cout << table.str();
+    if (!outputFile.empty()) {
+        ofstream file(outputFile.c_str());
+        file << table.str();
+        cerr << "Results saved to " << outputFile << endl;
+    }
+
+    // Comparison against a saved baseline
+    if (baselineFile.empty()) {
+        return 0;
+    }
+    map<string, double> baseline;
+    if (!loadBaseline(baselineFile, baseline)) {
+        cerr << "Cannot read baseline " << baselineFile << endl;
+        return 1;
+    }
+    int nRegressions = 0;
+    cerr << endl << "Comparison with " << baselineFile
+         << " (threshold " << fixed << setprecision(1) << 100.0 * threshold << "%):" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        map<string, double>::const_iterator it = baseline.find(results[i].name);
+        if (it == baseline.end() || it->second <= 0.0) {
+            continue;
+        }
+        double change = results[i].value / it->second - 1.0;
+        bool regressed = change < -threshold;
+        if (regressed) {
+            nRegressions++;
+        }
+        cerr << "  " << left << setw(26) << results[i].name << right
+             << showpos << setw(8) << 100.0 * change << "%" << noshowpos
+             << (regressed ? "  REGRESSION" : "") << endl;
+    }
+    if (nRegressions > 0) {
+        cerr << nRegressions << " benchmark(s) regressed" << endl;
+        return 2;
+    }
+    cerr << "No regressions" << endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include "PriceSurface.h"
+#include "SABRSimulator.h"
+#include "BermudanOption.h"
+#include "LSMPricer.h"
+
+using namespace std;
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Bermudan Price Surface Builder" << endl;
+    cout << "========================================" << endl << endl;
+    
+    // Base parameters
+    SweepScenario base;
+    base.F0 = 100.0;
+    base.alpha0 = 0.20;
+    base.beta = 0.5;
+    base.nu = 0.4;
+    base.rho = -0.3;
+    base.strike = 100.0;
+    double r = 0.05;
+    std::vector<double> exerciseDates = {0.25, 0.5, 0.75, 1.0};
+    int nPaths = 10000;
+    int polyDegree = 3;
+    unsigned int seed = 12345;
+    
+    // Surface over (F0, K, alpha0)
+    PriceSurface surface(base, exerciseDates, CALL, r, polyDegree, nPaths, seed);
+    surface.addAxis(SWEEP_F0, 95.0, 105.0, 12);
+    surface.addAxis(SWEEP_STRIKE, 95.0, 105.0, 12);
+    surface.addAxis(SWEEP_ALPHA0, 0.15, 0.25, 4);
+    
+    ThreadPool pool;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    surface.build(pool);
+    double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    cout << fixed << setprecision(4);
+    cout << "Built " << surface.getNNodes() << " nodes in " << buildSeconds << " s" << endl;
+    cout << "Truncation error estimate: " << surface.getTruncationError() << endl;
+    cout << "Max node standard error:   " << surface.getMaxStandardError() << endl;
+    cout << "Stated error bound:        " << surface.getErrorBound() << endl << endl;
+    
+    surface.save("price_surface.bin");
+    PriceSurface loaded;
+    if (!loaded.load("price_surface.bin")) {
+        cout << "Failed to reload price_surface.bin" << endl;
+        return 1;
+    }
+    
+    // Query latency
+    int nQueries = 100000;
+    double checksum = 0.0;
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < nQueries; q++) {
+        SweepScenario s = base;
+        s.F0 = 96.0 + 8.0 * (q % 97) / 96.0;
+        s.strike = 96.0 + 8.0 * (q % 89) / 88.0;
+        checksum += loaded.price(s) + loaded.delta(s);
+    }
+    double querySeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Query (price + delta): " << setprecision(3)
+         << 1e6 * querySeconds / nQueries << " us" << setprecision(4)
+         << " (checksum " << checksum << ")" << endl << endl;
+    
+    // Spot checks against direct LSM pricing off the nodes
+    cout << "F0\tK\talpha0\tSurface\t\tLSM\t\tDelta" << endl;
+    double checks[][3] = {{100.0, 100.0, 0.20}, {98.0, 101.0, 0.18}, {103.0, 97.0, 0.23}};
+    LSMPricer pricer(r, polyDegree);
+    pricer.setVerbose(false);
+    for (int i = 0; i < 3; i++) {
+        SweepScenario s = base;
+        s.F0 = checks[i][0];
+        s.strike = checks[i][1];
+        s.alpha0 = checks[i][2];
+        SABRSimulator sim(s.F0, s.alpha0, s.beta, s.nu, s.rho, seed);
+        BermudanOption opt(s.strike, exerciseDates, CALL);
+        double direct = pricer.price(sim, opt, nPaths);
+        cout << s.F0 << "\t" << s.strike << "\t" << s.alpha0 << "\t"
+             << loaded.price(s) << "\t\t" << direct << "\t\t" << loaded.delta(s) << endl;
+    }
+    
+    cout << endl << "Surface saved to price_surface.bin" << endl;
+    return 0;
+}
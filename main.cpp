@@ -3,6 +3,7 @@
 #include "SABRSimulator.h"
 #include "BermudanOption.h"
 #include "LSMPricer.h"
+#include "PricingResults.h"
 
 using namespace std;
 
@@ -78,6 +79,16 @@ int main() {
          << (price + 1.96 * stdError) << "]" << endl;
     cout << "========================================" << endl << endl;
     
+    // Instrumentation of the main pricing
+    PricingResults results;
+    results.setPrice(price);
+    results.setStandardError(stdError);
+    results.setExerciseBoundary(pricer.getExerciseBoundary());
+    results.setDiagnostics(pricer.getDiagnostics());
+    results.display();
+    results.saveToJSON("pricing_results.json");
+    cout << "Diagnostics saved to pricing_results.json" << endl << endl;
+    
     // Convergence test with different number of paths
     cout << "Convergence Analysis:" << endl;
     cout << "N Paths\t\tPrice\t\tStd Error" << endl;
@@ -0,0 +1,60 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include "PricingService.h"
+
+using namespace std;
+
+// Long-lived pricing service
+// Usage: pricing_service [--threads N] [--socket PATH] [--cache-size N] [--cache-dir DIR]
+//                        [--paths FILE]...
+// Without --socket, requests are read from stdin and answered on stdout.
+int main(int argc, char* argv[]) {
+    int nThreads = 0;
+    string socketPath;
+    size_t cacheSize = 1024;
+    string cacheDir;
+    vector<string> pathFiles;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            nThreads = atoi(argv[++i]);
+        } else if (arg == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (arg == "--cache-size" && i + 1 < argc) {
+            cacheSize = static_cast<size_t>(atol(argv[++i]));
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cacheDir = argv[++i];
+        } else if (arg == "--paths" && i + 1 < argc) {
+            pathFiles.push_back(argv[++i]);
+        } else {
+            cerr << "Usage: " << argv[0]
+                 << " [--threads N] [--socket PATH] [--cache-size N] [--cache-dir DIR]"
+                 << " [--paths FILE]..." << endl;
+            return 1;
+        }
+    }
+    
+    PricingService service(nThreads, cacheSize, cacheDir);
+    for (size_t i = 0; i < pathFiles.size(); i++) {
+        if (!service.addPathFile(pathFiles[i])) {
+            cerr << "Cannot map path file " << pathFiles[i] << endl;
+            return 1;
+        }
+    }
+    
+    if (!socketPath.empty()) {
+        cerr << "Listening on " << socketPath << endl;
+        if (service.serveSocket(socketPath) != 0) {
+            cerr << "Cannot listen on " << socketPath << endl;
+            return 1;
+        }
+    } else {
+        service.serve(STDIN_FILENO, STDOUT_FILENO);
+    }
+    
+    cerr << service.statsLine() << endl;
+    return 0;
+}
@@ -1,26 +1,73 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
-#include "SABRSimulator.h"
-#include "BermudanOption.h"
-#include "LSMPricer.h"
+#include "ParameterSweep.h"
+#include "ThreadPool.h"
 
 using namespace std;
 
+// Print and save one grid's results as a table
+static void printGrid(const vector<SweepResult>& results, const string& grid,
+                      SweepParameter parameter, ofstream& outfile) {
+    for (size_t i = 0; i < results.size(); i++) {
+        const SweepResult& r = results[i];
+        if (r.grid != grid) continue;
+        
+        double value = 0.0;
+        switch (parameter) {
+            case SWEEP_BETA:   value = r.scenario.beta; break;
+            case SWEEP_NU:     value = r.scenario.nu; break;
+            case SWEEP_RHO:    value = r.scenario.rho; break;
+            default:           value = r.scenario.strike; break;
+        }
+        
+        if (parameter == SWEEP_STRIKE) {
+            const char* moneyness = (value < r.scenario.F0) ? "ITM"
+                                  : (value > r.scenario.F0) ? "OTM" : "ATM";
+            cout << value << "\t" << moneyness << "\t\t" << r.price << "\t\t" << r.standardError << endl;
+            outfile << value << "\t" << moneyness << "\t" << r.price << "\t" << r.standardError << endl;
+        } else {
+            cout << value << "\t" << r.price << "\t\t" << r.standardError << endl;
+            outfile << value << "\t" << r.price << "\t" << r.standardError << endl;
+        }
+    }
+    cout << endl;
+    outfile << endl;
+}
+
 int main() {
     cout << "========================================" << endl;
     cout << "SABR Parameter Sensitivity Analysis" << endl;
     cout << "========================================" << endl << endl;
     
     // Base parameters
-    double F0 = 100.0;
-    double alpha0 = 0.20;
-    double K = 100.0;
+    SweepScenario base;
+    base.F0 = 100.0;
+    base.alpha0 = 0.20;
+    base.beta = 0.5;
+    base.nu = 0.4;
+    base.rho = -0.3;
+    base.strike = 100.0;
     double r = 0.05;
     std::vector<double> exerciseDates = {0.25, 0.5, 0.75, 1.0};
     int nPaths = 10000;
-    int stepsPerPeriod = 25;
     int polyDegree = 3;
+    unsigned int seed = 12345;   // Shared by all scenarios (common random numbers)
+    
+    // Declarative sweep: one grid per sensitivity test
+    ParameterSweep sweep(base, exerciseDates, CALL, r, polyDegree, nPaths, seed);
+    sweep.addGrid("beta",   {{SWEEP_BETA,   {0.0, 0.3, 0.5, 0.7, 1.0}}});
+    sweep.addGrid("nu",     {{SWEEP_NU,     {0.1, 0.2, 0.4, 0.6, 0.8}}});
+    sweep.addGrid("rho",    {{SWEEP_RHO,    {-0.7, -0.3, 0.0, 0.3, 0.7}}});
+    sweep.addGrid("strike", {{SWEEP_STRIKE, {90.0, 95.0, 100.0, 105.0, 110.0}}});
+    sweep.setImportanceSampling(true);   // OTM strikes: one shared drifted simulation
+    
+    ThreadPool pool;
+    vector<SweepResult> results = sweep.run(pool);
+    
+    cout << "Priced " << results.size() << " scenarios with "
+         << sweep.getNSimulations() << " simulations on "
+         << pool.getNThreads() << " threads" << endl << endl;
     
     cout << fixed << setprecision(4);
     
@@ -33,108 +80,47 @@ int main() {
     cout << "====================================" << endl;
     cout << "Beta\tPrice\t\tStd Error" << endl;
     cout << "----\t-----\t\t---------" << endl;
-    
     outfile << "BETA SENSITIVITY" << endl;
     outfile << "Beta\tPrice\tStdError" << endl;
-    
-    double betas[] = {0.0, 0.3, 0.5, 0.7, 1.0};
-    for (int i = 0; i < 5; i++) {
-        double beta = betas[i];
-        SABRSimulator sim(F0, alpha0, beta, 0.4, -0.3);
-        BermudanOption opt(K, exerciseDates, CALL);
-        LSMPricer pricer(r, polyDegree);
-        
-        double price = pricer.price(sim, opt, nPaths);
-        double stdErr = pricer.getStandardError();
-        
-        cout << beta << "\t" << price << "\t\t" << stdErr << endl;
-        outfile << beta << "\t" << price << "\t" << stdErr << endl;
-    }
-    cout << endl;
-    outfile << endl;
+    printGrid(results, "beta", SWEEP_BETA, outfile);
     
     // Test 2: Nu (vol-of-vol) sensitivity
     cout << "Test 2: Nu (Vol-of-Vol) Sensitivity" << endl;
     cout << "====================================" << endl;
     cout << "Nu\tPrice\t\tStd Error" << endl;
     cout << "----\t-----\t\t---------" << endl;
-    
     outfile << "NU SENSITIVITY" << endl;
     outfile << "Nu\tPrice\tStdError" << endl;
-    
-    double nus[] = {0.1, 0.2, 0.4, 0.6, 0.8};
-    for (int i = 0; i < 5; i++) {
-        double nu = nus[i];
-        SABRSimulator sim(F0, alpha0, 0.5, nu, -0.3);
-        BermudanOption opt(K, exerciseDates, CALL);
-        LSMPricer pricer(r, polyDegree);
-        
-        double price = pricer.price(sim, opt, nPaths);
-        double stdErr = pricer.getStandardError();
-        
-        cout << nu << "\t" << price << "\t\t" << stdErr << endl;
-        outfile << nu << "\t" << price << "\t" << stdErr << endl;
-    }
-    cout << endl;
-    outfile << endl;
+    printGrid(results, "nu", SWEEP_NU, outfile);
     
     // Test 3: Rho (correlation) sensitivity
     cout << "Test 3: Rho (Correlation) Sensitivity" << endl;
     cout << "======================================" << endl;
     cout << "Rho\tPrice\t\tStd Error" << endl;
     cout << "----\t-----\t\t---------" << endl;
-    
     outfile << "RHO SENSITIVITY" << endl;
     outfile << "Rho\tPrice\tStdError" << endl;
-    
-    double rhos[] = {-0.7, -0.3, 0.0, 0.3, 0.7};
-    for (int i = 0; i < 5; i++) {
-        double rho = rhos[i];
-        SABRSimulator sim(F0, alpha0, 0.5, 0.4, rho);
-        BermudanOption opt(K, exerciseDates, CALL);
-        LSMPricer pricer(r, polyDegree);
-        
-        double price = pricer.price(sim, opt, nPaths);
-        double stdErr = pricer.getStandardError();
-        
-        cout << rho << "\t" << price << "\t\t" << stdErr << endl;
-        outfile << rho << "\t" << price << "\t" << stdErr << endl;
-    }
-    cout << endl;
-    outfile << endl;
+    printGrid(results, "rho", SWEEP_RHO, outfile);
     
     // Test 4: Strike (moneyness) sensitivity
     cout << "Test 4: Strike (Moneyness) Sensitivity" << endl;
     cout << "=======================================" << endl;
     cout << "Strike\tMoneyness\tPrice\t\tStd Error" << endl;
     cout << "------\t---------\t-----\t\t---------" << endl;
-    
     outfile << "STRIKE SENSITIVITY" << endl;
     outfile << "Strike\tMoneyness\tPrice\tStdError" << endl;
-    
-    double strikes[] = {90.0, 95.0, 100.0, 105.0, 110.0};
-    const char* moneyness[] = {"ITM", "ITM", "ATM", "OTM", "OTM"};
-    
-    for (int i = 0; i < 5; i++) {
-        double strike = strikes[i];
-        SABRSimulator sim(F0, alpha0, 0.5, 0.4, -0.3);
-        BermudanOption opt(strike, exerciseDates, CALL);
-        LSMPricer pricer(r, polyDegree);
-        
-        double price = pricer.price(sim, opt, nPaths);
-        double stdErr = pricer.getStandardError();
-        
-        cout << strike << "\t" << moneyness[i] << "\t\t" << price << "\t\t" << stdErr << endl;
-        outfile << strike << "\t" << moneyness[i] << "\t" << price << "\t" << stdErr << endl;
-    }
-    cout << endl;
-    outfile << endl;
+    printGrid(results, "strike", SWEEP_STRIKE, outfile);
+    cout << "(OTM strikes priced with importance sampling on one drifted simulation:" << endl;
+    cout << " coupled to each other, not to the ITM strikes across K = F0)" << endl << endl;
     
     outfile.close();
     
+    // Structured output of every scenario
+    ParameterSweep::saveToCSV(results, "sensitivity_results.csv");
+    
     cout << "========================================" << endl;
     cout << "Analysis complete!" << endl;
-    cout << "Results saved to sensitivity_results.txt" << endl;
+    cout << "Results saved to sensitivity_results.txt and sensitivity_results.csv" << endl;
     cout << "========================================" << endl;
     
     return 0;
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <cstdlib>
+#include "SABRSimulator.h"
+#include "BermudanOption.h"
+#include "LSMPricer.h"
+#include "PathFile.h"
+
+using namespace std;
+
+// Simulate a path set once and store it for later pricing
+// Usage: simulate_paths FILE [nPaths] [seed]
+// Uses the baseline model and the grid LSMPricer uses for quarterly
+// exercise up to one year, so pricing_service --paths FILE can serve
+// baseline requests from it.
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " FILE [nPaths] [seed]" << endl;
+        return 1;
+    }
+    string filename = argv[1];
+    int nPaths = (argc > 2) ? atoi(argv[2]) : 10000;
+    unsigned int seed = (argc > 3) ? static_cast<unsigned int>(strtoul(argv[3], 0, 10)) : 12345;
+    
+    std::vector<double> exerciseDates = {0.25, 0.5, 0.75, 1.0};
+    BermudanOption option(100.0, exerciseDates, CALL);
+    int nSteps = LSMPricer::simulationSteps(option);
+    double T = exerciseDates.back();
+    
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, seed);
+    cout << "Writing " << nPaths << " paths x " << nSteps << " steps to " << filename << endl;
+    if (!sim.writePaths(filename, nPaths, nSteps, T)) {
+        cerr << "Failed to write " << filename << endl;
+        return 1;
+    }
+    
+    // Price straight from the mapping as a check
+    MappedPaths paths;
+    if (!paths.open(filename)) {
+        cerr << "Failed to map " << filename << endl;
+        return 1;
+    }
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    double price = pricer.priceFromFile(paths, option);
+    cout << "ATM call from mapped paths: " << price
+         << " (std error " << pricer.getStandardError() << ")" << endl;
+    return 0;
+}
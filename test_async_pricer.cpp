@@ -0,0 +1,82 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include "AsyncPricer.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Async Pricer Test" << endl;
+    cout << "========================================" << endl << endl;
+
+    vector<double> dates = {0.25, 0.5, 0.75, 1.0};
+    BermudanOption call(100.0, dates, CALL);
+    SABRParameters params = {100.0, 0.20, 0.5, 0.4, -0.3};
+    unsigned int seed = 12345;
+    cout << fixed << setprecision(6);
+
+    ThreadPool pool(2);
+    AsyncPricer async(pool, 0.05, 3, 4096);
+
+    // Test 1: same price as the blocking pricer
+    cout << "Test 1: Async vs Blocking Price" << endl;
+    int nPaths = 20000;
+    PricingHandle handle = async.submit(params, seed, call, nPaths);
+    SABRSimulator sim(params, seed);
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    double blocking = pricer.price(sim, call, nPaths);
+    double asyncPrice = handle.get();
+    cout << "Blocking: " << blocking << ", async: " << asyncPrice
+         << " (std error " << handle.getStandardError() << ")" << endl;
+    bool priceOK = fabs(blocking - asyncPrice) < 1e-12
+                && handle.getPathsSimulated() == nPaths
+                && handle.getDatesProcessed() == handle.getNDates();
+    cout << "Price test: " << (priceOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: cancellation of a large pricing
+    cout << "Test 2: Cancellation" << endl;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    PricingHandle big = async.submit(params, seed, call, 1000000);
+    while (big.getPathsSimulated() == 0) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    big.cancel();
+    double cancelled = big.get();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Cancelled after " << big.getPathsSimulated() << " of " << big.getNPaths()
+         << " paths, result " << cancelled << " in " << seconds << " s" << endl;
+    bool cancelOK = cancelled == -1.0 && big.isCancelled()
+                 && big.getPathsSimulated() < big.getNPaths();
+    cout << "Cancellation test: " << (cancelOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: many pricings queued on the shared pool
+    cout << "Test 3: Many Pricings on One Pool" << endl;
+    vector<double> strikes = {90.0, 95.0, 100.0, 105.0, 110.0, 100.0, 100.0, 100.0};
+    vector<PricingHandle> handles;
+    for (size_t k = 0; k < strikes.size(); k++) {
+        BermudanOption option(strikes[k], dates, CALL);
+        handles.push_back(async.submit(params, seed + static_cast<unsigned int>(k), option, 5000));
+    }
+    int nDone = 0;
+    bool monotone = true;
+    for (size_t k = 0; k < handles.size(); k++) {
+        double p = handles[k].get();
+        if (p >= 0.0 && handles[k].isDone()) nDone++;
+        if (k > 0 && k < 5 && !(p < handles[k - 1].get())) monotone = false;
+    }
+    cout << nDone << " of " << handles.size() << " pricings done on "
+         << pool.getNThreads() << " threads" << endl;
+    bool poolOK = nDone == static_cast<int>(handles.size()) && monotone;
+    cout << "Shared pool test: " << (poolOK ? "PASS" : "FAIL") << endl << endl;
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (priceOK && cancelOK && poolOK) ? 0 : 1;
+}
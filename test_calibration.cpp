@@ -0,0 +1,95 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include "SABRCalibrator.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "SABR Calibrator Test" << endl;
+    cout << "========================================" << endl << endl;
+    
+    double F0 = 100.0, T = 1.0, beta = 0.5;
+    double alpha = 2.0, rho = -0.3, nu = 0.4;    // alpha*F^(beta-1) ~ 20% ATM vol
+    cout << fixed << setprecision(6);
+    
+    // Test 1: analytic Jacobian against central differences
+    cout << "Test 1: Analytic Jacobian" << endl;
+    double maxRelErr = 0.0;
+    double strikes[] = {70.0, 90.0, 100.0, 110.0, 140.0};
+    for (int i = 0; i < 5; i++) {
+        double g[3];
+        SABRCalibrator::impliedVol(F0, strikes[i], T, alpha, beta, rho, nu, g);
+        double p[3] = {alpha, rho, nu};
+        for (int k = 0; k < 3; k++) {
+            double h = 1e-6;
+            double up[3] = {p[0], p[1], p[2]};
+            double dn[3] = {p[0], p[1], p[2]};
+            up[k] += h;
+            dn[k] -= h;
+            double fd = (SABRCalibrator::impliedVol(F0, strikes[i], T, up[0], beta, up[1], up[2])
+                       - SABRCalibrator::impliedVol(F0, strikes[i], T, dn[0], beta, dn[1], dn[2])) / (2.0 * h);
+            double err = fabs(fd - g[k]) / max(fabs(fd), 1e-8);
+            maxRelErr = max(maxRelErr, err);
+        }
+    }
+    cout << "Max relative error: " << maxRelErr << endl;
+    bool jacOK = (maxRelErr < 1e-5);
+    cout << "Jacobian test: " << (jacOK ? "PASS" : "FAIL") << endl << endl;
+    
+    // Test 2: recover parameters from a synthetic Hagan smile
+    cout << "Test 2: Parameter Recovery" << endl;
+    SABRSmile smile;
+    smile.F0 = F0;
+    smile.T = T;
+    for (double K = 70.0; K <= 140.0; K += 10.0) {
+        smile.strikes.push_back(K);
+        smile.vols.push_back(SABRCalibrator::impliedVol(F0, K, T, alpha, beta, rho, nu));
+    }
+    SABRCalibrator calibrator(beta);
+    SABRCalibrationResult res = calibrator.calibrate(smile);
+    cout << "alpha: " << res.parameters.alpha0 << " (true " << alpha << ")" << endl;
+    cout << "rho:   " << res.parameters.rho << " (true " << rho << ")" << endl;
+    cout << "nu:    " << res.parameters.nu << " (true " << nu << ")" << endl;
+    cout << "RMSE: " << scientific << res.rmse << fixed << ", iterations: " << res.iterations << endl;
+    bool fitOK = res.converged && fabs(res.parameters.alpha0 - alpha) < 1e-4
+              && fabs(res.parameters.rho - rho) < 1e-4 && fabs(res.parameters.nu - nu) < 1e-4;
+    cout << "Recovery test: " << (fitOK ? "PASS" : "FAIL") << endl << endl;
+    
+    // Test 3: batch calibration throughput
+    cout << "Test 3: Batch Calibration" << endl;
+    vector<SABRSmile> smiles;
+    for (int e = 0; e < 2000; e++) {
+        SABRSmile s = smile;
+        s.T = 0.25 + 0.01 * (e % 100);
+        double rho_e = -0.6 + 0.0006 * e;
+        for (size_t i = 0; i < s.strikes.size(); i++) {
+            s.vols[i] = SABRCalibrator::impliedVol(F0, s.strikes[i], s.T, alpha, beta, rho_e, nu);
+        }
+        smiles.push_back(s);
+    }
+    ThreadPool pool;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<SABRCalibrationResult> batch = calibrator.calibrateBatch(smiles, pool);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    int nConverged = 0;
+    double worst = 0.0;
+    for (size_t e = 0; e < batch.size(); e++) {
+        if (batch[e].converged) nConverged++;
+        worst = max(worst, batch[e].rmse);
+    }
+    cout << "Calibrated " << batch.size() << " smiles in " << seconds << " s ("
+         << setprecision(0) << batch.size() / seconds << " smiles/sec)" << setprecision(6) << endl;
+    cout << "Worst RMSE: " << scientific << worst << fixed << endl;
+    bool batchOK = (nConverged == static_cast<int>(batch.size())) && worst < 1e-6;
+    cout << "Batch test: " << (batchOK ? "PASS" : "FAIL") << endl << endl;
+    
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+    
+    return (jacOK && fitOK && batchOK) ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "SABRSimulator.h"
+#include "BermudanOption.h"
+#include "LSMPricer.h"
+#include "PricingResults.h"
+
+using namespace std;
+
+#ifdef LSM_INSTRUMENT
+// Phase ran at least once with non-negative times
+static bool phaseRecorded(const PhaseStats& p) {
+    return p.calls >= 1 && p.wallSeconds >= 0.0 && p.cpuSeconds >= 0.0;
+}
+#endif
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Instrumentation Test" << endl;
+    cout << "========================================" << endl << endl;
+    cout << setprecision(6);
+
+    vector<double> quarterly = {0.25, 0.5, 0.75, 1.0};
+    const int nPaths = 20000;
+    BermudanOption put(100.0, quarterly, PUT);
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, 12345);
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    double price = pricer.price(sim, put, nPaths);
+    const PricingDiagnostics& d = pricer.getDiagnostics();
+
+    // Test 1: per-date diagnostics, one entry per exercise date but maturity
+    cout << "Test 1: Pricing Diagnostics" << endl;
+    bool diagnosticsOK = d.nPaths == nPaths;
+#ifdef LSM_INSTRUMENT
+    size_t nDates = quarterly.size() - 1;
+    diagnosticsOK = diagnosticsOK && d.nItm.size() == nDates && d.itmFraction.size() == nDates
+                 && d.conditionNumber.size() == nDates && d.regressionPoints.size() == nDates;
+    for (size_t m = 0; m < d.nItm.size() && diagnosticsOK; m++) {
+        cout << "Date " << m << ": ITM " << d.nItm[m] << " (" << d.itmFraction[m]
+             << "), regression points " << d.regressionPoints[m]
+             << ", condition " << scientific << d.conditionNumber[m] << defaultfloat << endl;
+        diagnosticsOK = d.nItm[m] > 0 && d.nItm[m] <= nPaths
+                     && d.itmFraction[m] == static_cast<double>(d.nItm[m]) / nPaths
+                     && d.regressionPoints[m] == d.nItm[m]
+                     && std::isfinite(d.conditionNumber[m]) && d.conditionNumber[m] >= 1.0;
+    }
+    bool phasesOK = phaseRecorded(d.simulation) && phaseRecorded(d.itmScan)
+                 && phaseRecorded(d.regression) && phaseRecorded(d.exerciseDecision)
+                 && phaseRecorded(d.reduction) && d.pathsPerSecond > 0.0;
+    cout << "Simulation " << 1e3 * d.simulation.wallSeconds << " ms, regression "
+         << d.regression.calls << " calls, " << d.pathsPerSecond << " paths/s" << endl;
+    diagnosticsOK = diagnosticsOK && phasesOK;
+#ifdef LSM_COUNT_ALLOCATIONS
+    // The simulation allocates at least the path block
+    diagnosticsOK = diagnosticsOK && d.simulation.allocations >= 1;
+    cout << "Simulation allocations: " << d.simulation.allocations << endl;
+#else
+    diagnosticsOK = diagnosticsOK && d.simulation.allocations == 0;
+#endif
+#else
+    // Compiled out: nothing recorded
+    diagnosticsOK = diagnosticsOK && d.nItm.empty() && d.itmFraction.empty()
+                 && d.simulation.calls == 0 && d.regression.calls == 0;
+    cout << "Instrumentation compiled out (LSM_NO_INSTRUMENTATION)" << endl;
+#endif
+    cout << "Diagnostics test: " << (diagnosticsOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: the JSON dump carries the price and the diagnostics
+    cout << "Test 2: JSON Dump" << endl;
+    PricingResults results;
+    results.setPrice(price);
+    results.setStandardError(pricer.getStandardError());
+    results.setExerciseBoundary(pricer.getExerciseBoundary());
+    results.setDiagnostics(d);
+    char jsonTemplate[] = "/tmp/instrumentation_json_XXXXXX";
+    int jsonFd = mkstemp(jsonTemplate);
+    close(jsonFd);
+    results.saveToJSON(jsonTemplate);
+    string json;
+    {
+        ifstream in(jsonTemplate);
+        ostringstream content;
+        content << in.rdbuf();
+        json = content.str();
+    }
+    remove(jsonTemplate);
+    ostringstream priceField;
+    priceField << setprecision(10) << "\"price\": " << price << ",";
+    const char* keys[] = {"\"standard_error\"", "\"exercise_boundary\"", "\"diagnostics\"",
+                          "\"simulation\"", "\"regression\"", "\"itm_fraction\"",
+                          "\"condition_number\"", "\"regression_points\""};
+    bool jsonOK = json == results.toJSON() && json.find(priceField.str()) != string::npos;
+    for (int k = 0; k < 8; k++) {
+        jsonOK = jsonOK && json.find(keys[k]) != string::npos;
+    }
+    int depth = 0;
+    for (size_t i = 0; i < json.size(); i++) {
+        if (json[i] == '{' || json[i] == '[') depth++;
+        if (json[i] == '}' || json[i] == ']') depth--;
+        jsonOK = jsonOK && depth >= 0;
+    }
+    jsonOK = jsonOK && depth == 0;
+    cout << "Written " << json.size() << " bytes, fields and brackets complete: " << jsonOK << endl;
+    cout << "JSON test: " << (jsonOK ? "PASS" : "FAIL") << endl << endl;
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (diagnosticsOK && jsonOK) ? 0 : 1;
+}
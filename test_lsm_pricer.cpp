@@ -0,0 +1,249 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <unistd.h>
+#include "SABRSimulator.h"
+#include "BermudanOption.h"
+#include "LSMPricer.h"
+#include "PathFile.h"
+
+using namespace std;
+
+// Fitted continuation value at F
+static double continuation(const vector<double>& coeffs, double F) {
+    double value = 0.0;
+    double basis = 1.0;
+    for (size_t j = 0; j < coeffs.size(); j++) {
+        value += coeffs[j] * basis;
+        basis *= F;
+    }
+    return value;
+}
+
+// Boundaries agree where both are NaN or both are equal
+static bool sameBoundary(const vector<double>& a, const vector<double>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t m = 0; m < a.size(); m++) {
+        if (!(a[m] == b[m] || (std::isnan(a[m]) && std::isnan(b[m])))) return false;
+    }
+    return true;
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "LSM Pricer Test" << endl;
+    cout << "========================================" << endl << endl;
+    cout << setprecision(15);
+
+    vector<double> quarterly = {0.25, 0.5, 0.75, 1.0};
+    const int nPaths = 20000;
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+
+    // Test 1: boundary decision reproduces the per-path decision exactly
+    cout << "Test 1: Boundary vs Per-Path Decision" << endl;
+    bool boundaryOK = true;
+    for (int t = 0; t < 2; t++) {
+        OptionType type = (t == 0) ? CALL : PUT;
+        for (double K = 90.0; K <= 110.0; K += 5.0) {
+            BermudanOption option(K, quarterly, type);
+            SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, 12345);
+            pricer.setBoundaryDecision(false);
+            double perPath = pricer.price(sim, option, nPaths);
+            vector<double> perPathBoundary = pricer.getExerciseBoundary();
+            pricer.setBoundaryDecision(true);
+            double boundary = pricer.price(sim, option, nPaths);
+            bool same = boundary == perPath
+                     && sameBoundary(pricer.getExerciseBoundary(), perPathBoundary);
+            cout << (type == CALL ? "Call" : "Put ") << " K=" << K << ": per-path " << perPath
+                 << ", boundary " << boundary << (same ? "" : "  MISMATCH") << endl;
+            boundaryOK = boundaryOK && same;
+        }
+    }
+    pricer.setBoundaryDecision(false);
+    cout << "Boundary decision test: " << (boundaryOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: exercise region separates payoff > continuation from the rest
+    cout << "Test 2: Exercise Region" << endl;
+    bool regionOK = true;
+    for (int t = 0; t < 2; t++) {
+        OptionType type = (t == 0) ? CALL : PUT;
+        BermudanOption option(100.0, quarterly, type);
+        SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, 12345);
+        pricer.price(sim, option, nPaths);
+        const vector<vector<double> >& policy = pricer.getExercisePolicy();
+        const vector<double>& boundary = pricer.getExerciseBoundary();
+        double lo = (type == CALL) ? 100.0 : 40.0;
+        double hi = (type == CALL) ? 160.0 : 100.0;
+        for (size_t m = 0; m < policy.size(); m++) {
+            if (policy[m].empty()) continue;
+            vector<double> intervals;
+            int n = LSMPricer::exerciseRegion(policy[m], option, lo, hi, intervals);
+            bool consistent = n == static_cast<int>(intervals.size() / 2);
+            // Sample the search range away from the roots
+            for (int s = 0; s <= 600 && consistent; s++) {
+                double F = lo + (hi - lo) * s / 600.0;
+                double gap = option.payoff(F) - continuation(policy[m], F);
+                bool inside = false;
+                bool nearRoot = false;
+                for (size_t r = 0; r < intervals.size(); r += 2) {
+                    inside = inside || (F >= intervals[r] && F <= intervals[r + 1]);
+                    nearRoot = nearRoot || fabs(F - intervals[r]) < 1e-6
+                                        || fabs(F - intervals[r + 1]) < 1e-6;
+                }
+                if (!nearRoot && F != option.getStrike()) {
+                    consistent = (inside == (gap > 0.0));
+                }
+            }
+            // Region edges are roots of payoff - continuation or search bounds
+            for (size_t r = 0; r < intervals.size() && consistent; r++) {
+                double edge = intervals[r];
+                consistent = edge == lo || edge == hi
+                          || fabs(option.payoff(edge) - continuation(policy[m], edge)) < 1e-8;
+            }
+            cout << (type == CALL ? "Call" : "Put ") << " date " << m << ": " << n
+                 << " interval(s), boundary " << boundary[m] << (consistent ? "" : "  INCONSISTENT") << endl;
+            regionOK = regionOK && consistent;
+        }
+    }
+    cout << "Exercise region test: " << (regionOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: out-of-core and recompute pricings report price()'s boundary
+    // (the per-path decision there, so the boundary is not stale either)
+    cout << "Test 3: Boundary of Out-of-Core and Recompute" << endl;
+    BermudanOption put(100.0, quarterly, PUT);
+    BermudanOption call(110.0, quarterly, CALL);
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, 12345);
+    pricer.price(sim, put, nPaths);
+    vector<double> putBoundary = pricer.getExerciseBoundary();
+    pricer.price(sim, call, nPaths);
+    pricer.priceOutOfCore(sim, put, nPaths, 1 << 20);
+    bool outOfCoreSame = sameBoundary(pricer.getExerciseBoundary(), putBoundary);
+    pricer.price(sim, call, nPaths);
+    pricer.priceRecompute(sim, put, nPaths, 2);
+    bool recomputeSame = sameBoundary(pricer.getExerciseBoundary(), putBoundary);
+    cout << "Out-of-core boundary matches: " << outOfCoreSame
+         << ", recompute boundary matches: " << recomputeSame << endl;
+    bool entryPointsOK = outOfCoreSame && recomputeSame;
+    cout << "Entry point boundary test: " << (entryPointsOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 4: out-of-core pricing gives price() exactly (several chunks)
+    cout << "Test 4: Out-of-Core vs In-Memory" << endl;
+    bool outOfCoreOK = true;
+    for (int t = 0; t < 2; t++) {
+        BermudanOption option(100.0, quarterly, (t == 0) ? CALL : PUT);
+        double inMemory = pricer.price(sim, option, 30000);
+        double inMemoryError = pricer.getStandardError();
+        double outOfCore = pricer.priceOutOfCore(sim, option, 30000, 1 << 20);
+        bool same = outOfCore == inMemory && pricer.getStandardError() == inMemoryError;
+        cout << (t == 0 ? "Call" : "Put ") << ": in memory " << inMemory
+             << ", out of core " << outOfCore << (same ? "" : "  MISMATCH") << endl;
+        outOfCoreOK = outOfCoreOK && same;
+    }
+    cout << "Out-of-core test: " << (outOfCoreOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 5: recompute pricing gives price() exactly, whatever the
+    // checkpoint interval (0: regenerate from t = 0, 1: every date)
+    cout << "Test 5: Recompute vs Stored Paths" << endl;
+    bool recomputeOK = true;
+    for (int t = 0; t < 2; t++) {
+        BermudanOption option(100.0, quarterly, (t == 0) ? CALL : PUT);
+        double stored = pricer.price(sim, option, 30000);
+        double storedError = pricer.getStandardError();
+        cout << (t == 0 ? "Call" : "Put ") << ": stored " << stored;
+        for (int k = 0; k <= 2; k++) {
+            double recomputed = pricer.priceRecompute(sim, option, 30000, k);
+            bool same = recomputed == stored && pricer.getStandardError() == storedError;
+            cout << ", interval " << k << " " << recomputed << (same ? "" : " MISMATCH");
+            recomputeOK = recomputeOK && same;
+        }
+        cout << endl;
+    }
+    cout << "Recompute test: " << (recomputeOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 6: subsampled regression stops before using every ITM path and
+    // prices within a standard error of the full fit
+    cout << "Test 6: Subsampled Regression" << endl;
+    bool subsampleOK = true;
+    for (int t = 0; t < 2; t++) {
+        BermudanOption option(100.0, quarterly, (t == 0) ? CALL : PUT);
+        double full = pricer.price(sim, option, 100000);
+        double fullError = pricer.getStandardError();
+        pricer.setRegressionSubsampling(1000, 0.01);
+        double subsampled = pricer.price(sim, option, 100000);
+        pricer.setRegressionSubsampling(0);
+        bool close = fabs(subsampled - full) < fullError;
+        bool converged = true;
+#ifdef LSM_INSTRUMENT
+        const PricingDiagnostics& d = pricer.getDiagnostics();
+        cout << (t == 0 ? "Call" : "Put ") << " points used / ITM:";
+        for (size_t m = 0; m < d.nItm.size(); m++) {
+            cout << " " << d.regressionPoints[m] << "/" << d.nItm[m];
+            converged = converged && d.regressionPoints[m] < d.nItm[m];
+        }
+        cout << endl;
+#endif
+        cout << (t == 0 ? "Call" : "Put ") << ": full fit " << full << " (" << fullError
+             << "), subsampled " << subsampled << ((close && converged) ? "" : "  MISMATCH") << endl;
+        subsampleOK = subsampleOK && close && converged;
+    }
+    cout << "Subsampled regression test: " << (subsampleOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 7: paths written to a file and mapped back price exactly as
+    // price(); truncated or foreign-version files are refused
+    cout << "Test 7: Path File Round Trip" << endl;
+    char pathTemplate[] = "/tmp/lsm_pricer_paths_XXXXXX";
+    int pathFd = mkstemp(pathTemplate);
+    close(pathFd);
+    string pathFile = pathTemplate;
+    string badFile = pathFile + ".bad";
+    BermudanOption filePut(100.0, quarterly, PUT);
+    bool written = sim.writePaths(pathFile, 20000, LSMPricer::simulationSteps(filePut), 1.0);
+    MappedPaths mapped;
+    bool opened = written && mapped.open(pathFile);
+    double inMemory = pricer.price(sim, filePut, 20000);
+    double fromFile = opened ? pricer.priceFromFile(mapped, filePut) : -1.0;
+    double inMemoryHalf = pricer.price(sim, filePut, 10000);
+    double fromFileHalf = opened ? pricer.priceFromFile(mapped, filePut, 10000) : -1.0;
+    mapped.close();
+    vector<char> bytes;
+    {
+        ifstream in(pathFile.c_str(), ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    {
+        ofstream out(badFile.c_str(), ios::binary);
+        out.write(&bytes[0], bytes.size() - sizeof(double));
+    }
+    bool truncatedRefused = !mapped.open(badFile);
+    {
+        vector<char> other(bytes);
+        int version = PATH_FILE_VERSION + 1;
+        memcpy(&other[offsetof(PathFileHeader, version)], &version, sizeof(int));
+        ofstream out(badFile.c_str(), ios::binary);
+        out.write(&other[0], other.size());
+    }
+    bool versionRefused = !mapped.open(badFile);
+    remove(pathFile.c_str());
+    remove(badFile.c_str());
+    cout << "In memory " << inMemory << ", from file " << fromFile << "; 10000 paths: "
+         << inMemoryHalf << " vs " << fromFileHalf << endl;
+    cout << "Truncated refused: " << truncatedRefused << ", wrong version refused: "
+         << versionRefused << endl;
+    bool pathFileOK = opened && fromFile == inMemory && fromFileHalf == inMemoryHalf
+                   && truncatedRefused && versionRefused;
+    cout << "Path file test: " << (pathFileOK ? "PASS" : "FAIL") << endl << endl;
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (boundaryOK && regionOK && entryPointsOK && outOfCoreOK && recomputeOK && subsampleOK
+            && pathFileOK) ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include "ParameterSweep.h"
+#include "ThreadPool.h"
+#include "SABRSimulator.h"
+#include "LSMPricer.h"
+
+using namespace std;
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Parameter Sweep Test" << endl;
+    cout << "========================================" << endl << endl;
+    cout << fixed << setprecision(6);
+
+    SweepScenario base;
+    base.F0 = 100.0;
+    base.alpha0 = 0.20;
+    base.beta = 0.5;
+    base.nu = 0.4;
+    base.rho = -0.3;
+    base.strike = 100.0;
+    vector<double> quarterly = {0.25, 0.5, 0.75, 1.0};
+    vector<double> strikes = {90.0, 95.0, 100.0, 105.0, 110.0};
+    ThreadPool pool(4);
+
+    // Test 1: importance-weighted and plain prices agree for calls and puts
+    // (within 3 combined standard errors; ITM strikes are priced the same way)
+    cout << "Test 1: Importance Sampling vs Plain" << endl;
+    bool agreeOK = true;
+    bool countOK = true;
+    for (int t = 0; t < 2; t++) {
+        OptionType type = (t == 0) ? CALL : PUT;
+        ParameterSweep plain(base, quarterly, type, 0.05, 3, 20000, 12345);
+        ParameterSweep sampled(base, quarterly, type, 0.05, 3, 20000, 12345);
+        plain.addGrid("strike", {{SWEEP_STRIKE, strikes}});
+        sampled.addGrid("strike", {{SWEEP_STRIKE, strikes}});
+        sampled.setImportanceSampling(true);
+        vector<SweepResult> p = plain.run(pool);
+        vector<SweepResult> s = sampled.run(pool);
+        for (size_t i = 0; i < p.size(); i++) {
+            double combined = sqrt(p[i].standardError * p[i].standardError
+                                 + s[i].standardError * s[i].standardError);
+            bool otm = (type == CALL) ? (p[i].scenario.strike > base.F0)
+                                      : (p[i].scenario.strike < base.F0);
+            bool agree = otm ? fabs(p[i].price - s[i].price) <= 3.0 * combined
+                             : p[i].price == s[i].price;
+            cout << (type == CALL ? "Call" : "Put ") << " K=" << p[i].scenario.strike
+                 << ": plain " << p[i].price << " (" << p[i].standardError << "), weighted "
+                 << s[i].price << " (" << s[i].standardError << ")" << (agree ? "" : "  MISMATCH") << endl;
+            agreeOK = agreeOK && agree;
+        }
+        // One plain simulation, plus one drifted one shared by the OTM strikes
+        countOK = countOK && plain.getNSimulations() == 1 && sampled.getNSimulations() == 2;
+    }
+    cout << "Simulations per model: " << (countOK ? "1 plain + 1 drifted" : "unexpected") << endl;
+    bool importanceOK = agreeOK && countOK;
+    cout << "Importance sampling test: " << (importanceOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: every sweep result is the standalone LSM price on the shared
+    // seed (common random numbers): a 6-strike group on one model (wider
+    // than the batch of 4) and 6 models x 2 strikes (two batches)
+    cout << "Test 2: Sweep vs Standalone Pricing" << endl;
+    ParameterSweep sweep(base, quarterly, PUT, 0.05, 3, 5000, 12345);
+    sweep.addGrid("strike", {{SWEEP_STRIKE, {90.0, 95.0, 100.0, 105.0, 110.0, 115.0}}});
+    sweep.addGrid("nu_strike", {{SWEEP_NU, {0.1, 0.2, 0.3, 0.5, 0.6, 0.7}},
+                                {SWEEP_STRIKE, {95.0, 105.0}}});
+    vector<SweepResult> swept = sweep.run(pool);
+    bool standaloneOK = swept.size() == 18 && sweep.getNSimulations() == 7;
+    for (size_t i = 0; i < swept.size(); i++) {
+        const SweepScenario& sc = swept[i].scenario;
+        SABRSimulator sim(sc.F0, sc.alpha0, sc.beta, sc.nu, sc.rho, 12345);
+        BermudanOption option(sc.strike, quarterly, PUT);
+        LSMPricer pricer(0.05, 3);
+        pricer.setVerbose(false);
+        double direct = pricer.price(sim, option, 5000);
+        bool same = swept[i].price == direct && swept[i].standardError == pricer.getStandardError();
+        if (!same) {
+            cout << swept[i].grid << " nu=" << sc.nu << " K=" << sc.strike << ": sweep "
+                 << swept[i].price << ", standalone " << direct << "  MISMATCH" << endl;
+        }
+        standaloneOK = standaloneOK && same;
+    }
+    cout << swept.size() << " scenarios on " << sweep.getNSimulations()
+         << " simulations, all equal to standalone prices: " << standaloneOK << endl;
+    cout << "Standalone pricing test: " << (standaloneOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: each scenario of a multi-scenario batch reproduces simulatePaths
+    // for its own parameters (same seed, mixed F0/beta/nu/rho, offset paths)
+    cout << "Test 3: Batched Simulation vs Single Model" << endl;
+    SABRParameters models[4] = {{100.0, 0.20, 0.5, 0.4, -0.3},
+                                {95.0, 0.25, 0.0, 0.2, 0.0},
+                                {110.0, 0.15, 1.0, 0.8, -0.7},
+                                {100.0, 0.20, 0.7, 0.0, 0.5}};
+    const int nBatchPaths = 64, nSteps = 75, firstPath = 5;
+    vector<vector<double> > F_store(4 * nBatchPaths, vector<double>(nSteps + 1));
+    vector<vector<double> > alpha_store(4 * nBatchPaths, vector<double>(nSteps + 1));
+    vector<vector<double*> > F_rows(4, vector<double*>(nBatchPaths));
+    vector<vector<double*> > alpha_rows(4, vector<double*>(nBatchPaths));
+    vector<double**> F_batch(4), alpha_batch(4);
+    for (int k = 0; k < 4; k++) {
+        for (int i = 0; i < nBatchPaths; i++) {
+            F_rows[k][i] = &F_store[k * nBatchPaths + i][0];
+            alpha_rows[k][i] = &alpha_store[k * nBatchPaths + i][0];
+        }
+        F_batch[k] = &F_rows[k][0];
+        alpha_batch[k] = &alpha_rows[k][0];
+    }
+    SABRSimulator batchSim(models[0], 12345);
+    batchSim.simulatePathsBatch(4, models, nBatchPaths, nSteps, 1.0, &F_batch[0], &alpha_batch[0],
+                                firstPath);
+    bool batchOK = true;
+    for (int k = 0; k < 4; k++) {
+        vector<vector<double> > F(nBatchPaths, vector<double>(nSteps + 1));
+        vector<vector<double> > alpha(nBatchPaths, vector<double>(nSteps + 1));
+        vector<double*> F_single(nBatchPaths), alpha_single(nBatchPaths);
+        for (int i = 0; i < nBatchPaths; i++) {
+            F_single[i] = &F[i][0];
+            alpha_single[i] = &alpha[i][0];
+        }
+        SABRSimulator single(models[k], 12345);
+        single.simulatePaths(nBatchPaths, nSteps, 1.0, &F_single[0], &alpha_single[0], firstPath);
+        bool same = true;
+        for (int i = 0; i < nBatchPaths; i++) {
+            same = same && F[i] == F_store[k * nBatchPaths + i]
+                        && alpha[i] == alpha_store[k * nBatchPaths + i];
+        }
+        cout << "Scenario " << k << " (F0=" << models[k].F0 << ", beta=" << models[k].beta
+             << ", nu=" << models[k].nu << ", rho=" << models[k].rho << "): "
+             << (same ? "identical" : "DIFFERS") << endl;
+        batchOK = batchOK && same;
+    }
+    cout << "Batched simulation test: " << (batchOK ? "PASS" : "FAIL") << endl << endl;
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (importanceOK && standaloneOK && batchOK) ? 0 : 1;
+}
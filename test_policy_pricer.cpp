@@ -0,0 +1,92 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include "SABRSimulator.h"
+#include "BermudanOption.h"
+#include "LSMPricer.h"
+#include "PolicyPricer.h"
+
+using namespace std;
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Policy-Based Pricer Test" << endl;
+    cout << "========================================" << endl << endl;
+
+    // One simulation shared by every pricer below
+    vector<double> dates = {0.25, 0.5, 0.75, 1.0};
+    int nPaths = 20000;
+    int nSteps = 75;
+    double T = 1.0;
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, 12345);
+    double** F = new double*[nPaths];
+    double** alpha = new double*[nPaths];
+    for (int i = 0; i < nPaths; i++) {
+        F[i] = new double[nSteps + 1];
+        alpha[i] = new double[nSteps + 1];
+    }
+    sim.simulatePaths(nPaths, nSteps, T, F, alpha);
+    cout << fixed << setprecision(6);
+
+    // Test 1: vanilla policies reproduce LSMPricer
+    cout << "Test 1: Vanilla Call/Put against LSMPricer" << endl;
+    LSMPricer lsm(0.05, 3);
+    lsm.setVerbose(false);
+    BermudanOption call(100.0, dates, CALL);
+    BermudanOption put(100.0, dates, PUT);
+    double lsmCall = lsm.priceFromPaths(F, alpha, nPaths, nSteps, T, call);
+    double lsmPut = lsm.priceFromPaths(F, alpha, nPaths, nSteps, T, put);
+    PolicyPricer<VanillaCall> policyCall(VanillaCall(100.0), dates, 0.05);
+    PolicyPricer<VanillaPut> policyPut(VanillaPut(100.0), dates, 0.05);
+    double pCall = policyCall.priceFromPaths(F, alpha, nPaths, nSteps, T);
+    double pPut = policyPut.priceFromPaths(F, alpha, nPaths, nSteps, T);
+    cout << "Call: LSMPricer " << lsmCall << ", PolicyPricer " << pCall << endl;
+    cout << "Put:  LSMPricer " << lsmPut << ", PolicyPricer " << pPut << endl;
+    bool vanillaOK = fabs(lsmCall - pCall) < 1e-12 && fabs(lsmPut - pPut) < 1e-12;
+    cout << "Vanilla test: " << (vanillaOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: payoff ordering on common paths
+    cout << "Test 2: Exotic Payoffs" << endl;
+    PolicyPricer<CappedCall> capped(CappedCall(100.0, 2.0), dates, 0.05);
+    PolicyPricer<DigitalCall> digital(DigitalCall(100.0, 1.0), dates, 0.05);
+    PolicyPricer<SpreadToStrikeCall> spread(SpreadToStrikeCall(100.0, 0.0, 100.0), dates, 0.05);
+    PolicyPricer<VanillaCall, MonomialBasis<3>, NoEarlyExercise> european(VanillaCall(100.0), dates, 0.05);
+    double pCapped = capped.priceFromPaths(F, alpha, nPaths, nSteps, T);
+    double pDigital = digital.priceFromPaths(F, alpha, nPaths, nSteps, T);
+    double pSpread = spread.priceFromPaths(F, alpha, nPaths, nSteps, T);
+    double pEuropean = european.priceFromPaths(F, alpha, nPaths, nSteps, T);
+    cout << "Capped call (cap 2):       " << pCapped << endl;
+    cout << "Digital call:              " << pDigital << endl;
+    cout << "Spread-to-strike (0, 100): " << pSpread << endl;
+    cout << "European call:             " << pEuropean << endl;
+    // Capped <= vanilla; digital in [0, 1]; zero spread with notional K is
+    // the vanilla call; European <= Bermudan (up to LSM's low bias noise)
+    bool exoticOK = pCapped > 0.0 && pCapped <= pCall + 1e-12
+                 && pDigital > 0.0 && pDigital < 1.0
+                 && fabs(pSpread - pCall) < 1e-9
+                 && pEuropean <= pCall + 2.0 * policyCall.getStandardError();
+    cout << "Exotic test: " << (exoticOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: two-factor basis
+    cout << "Test 3: Stochastic-Vol Basis" << endl;
+    PolicyPricer<VanillaPut, StochasticVolBasis> putSV(VanillaPut(100.0), dates, 0.05);
+    double pPutSV = putSV.priceFromPaths(F, alpha, nPaths, nSteps, T);
+    cout << "Put with (F, alpha) basis: " << pPutSV << " (monomial basis " << pPut << ")" << endl;
+    bool basisOK = fabs(pPutSV - pPut) < 3.0 * policyPut.getStandardError()
+                && putSV.getExercisePolicy()[0].size() == 6;
+    cout << "Basis test: " << (basisOK ? "PASS" : "FAIL") << endl << endl;
+
+    for (int i = 0; i < nPaths; i++) {
+        delete[] F[i];
+        delete[] alpha[i];
+    }
+    delete[] F;
+    delete[] alpha;
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (vanillaOK && exoticOK && basisOK) ? 0 : 1;
+}
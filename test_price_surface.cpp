@@ -0,0 +1,212 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <limits>
+#include <cstring>
+#include <unistd.h>
+#include <cmath>
+#include "PriceSurface.h"
+#include "SABRSimulator.h"
+#include "LSMPricer.h"
+
+using namespace std;
+
+// Offsets in the surface file (PriceSurface::save layout, 4 dates)
+static const long FIRST_AXIS = 8 + 4 + 6 * 8 + 4 + 8 + 4 + 4 + 4 + 4 + 4 * 8 + 4;
+static const long AXIS_NODES = FIRST_AXIS + 4 + 8 + 8;
+
+// Copy of file with an int overwritten at offset
+static void writeCorrupted(const string& from, const string& to, long offset, int value) {
+    ifstream in(from.c_str(), ios::binary);
+    vector<char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    ofstream out(to.c_str(), ios::binary);
+    out.write(&bytes[0], bytes.size());
+    out.seekp(offset);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(int));
+}
+
+// Copy of file cut to its first length bytes
+static void writeTruncated(const string& from, const string& to, long length) {
+    ifstream in(from.c_str(), ios::binary);
+    vector<char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    ofstream out(to.c_str(), ios::binary);
+    out.write(&bytes[0], length);
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Price Surface Test" << endl;
+    cout << "========================================" << endl << endl;
+    cout << fixed << setprecision(6);
+
+    SweepScenario base;
+    base.F0 = 100.0;
+    base.alpha0 = 0.20;
+    base.beta = 0.5;
+    base.nu = 0.4;
+    base.rho = -0.3;
+    base.strike = 100.0;
+    vector<double> quarterly = {0.25, 0.5, 0.75, 1.0};
+    ThreadPool pool(4);
+    PriceSurface surface(base, quarterly, PUT, 0.05, 3, 2000, 12345);
+    surface.addAxis(SWEEP_F0, 95.0, 105.0, 4);
+    surface.addAxis(SWEEP_STRIKE, 95.0, 105.0, 3);
+    surface.build(pool);
+
+    char dirTemplate[] = "/tmp/price_surface_test_XXXXXX";
+    string directory = mkdtemp(dirTemplate);
+    string file = directory + "/surface.bin";
+    string corrupted = directory + "/corrupted.bin";
+
+    // Test 1: save / load round trip
+    cout << "Test 1: Save and Load" << endl;
+    bool saved = surface.save(file);
+    PriceSurface loaded;
+    bool read = loaded.load(file);
+    SweepScenario probe = base;
+    probe.F0 = 101.3;
+    probe.strike = 98.7;
+    const SweepScenario& b = loaded.getBase();
+    bool sameBase = b.F0 == base.F0 && b.alpha0 == base.alpha0 && b.beta == base.beta
+                 && b.nu == base.nu && b.rho == base.rho && b.strike == base.strike;
+    cout << "Saved: " << saved << ", loaded: " << read << ", price " << surface.price(probe)
+         << " vs " << loaded.price(probe) << endl;
+    bool roundTripOK = saved && read && sameBase && loaded.getNNodes() == 12
+                    && loaded.price(probe) == surface.price(probe)
+                    && loaded.delta(probe) == surface.delta(probe);
+    cout << "Round trip test: " << (roundTripOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: malformed files are rejected and leave the surface unchanged
+    cout << "Test 2: Malformed Files" << endl;
+    writeCorrupted(file, corrupted, AXIS_NODES, 0);
+    bool zeroNodes = !loaded.load(corrupted);
+    writeCorrupted(file, corrupted, AXIS_NODES, 1 << 30);
+    bool hugeNodes = !loaded.load(corrupted);
+    writeCorrupted(file, corrupted, FIRST_AXIS, 17);
+    bool badParameter = !loaded.load(corrupted);
+    writeCorrupted(file, corrupted, FIRST_AXIS - 4 - 4 * 8 - 4, 1 << 30);
+    bool hugeDates = !loaded.load(corrupted);
+    writeTruncated(file, corrupted, FIRST_AXIS + 2 * 24 + 8 + 8 + 8 + 5 * 8);
+    bool truncated = !loaded.load(corrupted);
+    {
+        // hi = lo on the first axis
+        ifstream in(file.c_str(), ios::binary);
+        vector<char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        memcpy(&bytes[FIRST_AXIS + 4 + 8], &bytes[FIRST_AXIS + 4], sizeof(double));
+        ofstream out(corrupted.c_str(), ios::binary);
+        out.write(&bytes[0], bytes.size());
+    }
+    bool emptyDomain = !loaded.load(corrupted);
+    bool unchanged = loaded.isBuilt() && loaded.price(probe) == surface.price(probe);
+    cout << "Rejected: nNodes 0 " << zeroNodes << ", nNodes 2^30 " << hugeNodes
+         << ", parameter 17 " << badParameter << ", nDates 2^30 " << hugeDates
+         << ", truncated " << truncated << ", lo == hi " << emptyDomain
+         << "; surface unchanged " << unchanged << endl;
+    bool malformedOK = zeroNodes && hugeNodes && badParameter && hugeDates && truncated
+                    && emptyDomain && unchanged;
+    cout << "Malformed file test: " << (malformedOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: addAxis rejects degenerate domains
+    cout << "Test 3: Axis Validation" << endl;
+    PriceSurface axisCheck(base, quarterly, PUT, 0.05, 3, 2000, 12345);
+    bool flat = !axisCheck.addAxis(SWEEP_F0, 100.0, 100.0, 4);
+    bool reversed = !axisCheck.addAxis(SWEEP_F0, 105.0, 95.0, 4);
+    bool infinite = !axisCheck.addAxis(SWEEP_F0, 95.0, numeric_limits<double>::infinity(), 4);
+    bool nan = !axisCheck.addAxis(SWEEP_F0, numeric_limits<double>::quiet_NaN(), 105.0, 4);
+    bool noNodes = !axisCheck.addAxis(SWEEP_F0, 95.0, 105.0, 0);
+    bool accepted = axisCheck.addAxis(SWEEP_F0, 95.0, 105.0, 4);
+    cout << "Rejected: lo == hi " << flat << ", lo > hi " << reversed << ", infinite " << infinite
+         << ", NaN " << nan << ", no nodes " << noNodes << "; valid accepted " << accepted << endl;
+    bool axisOK = flat && reversed && infinite && nan && noNodes && accepted;
+    cout << "Axis validation test: " << (axisOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 4: off-node prices match the LSM pricer within the error bound
+    // (direct pricing on the surface's seed and path count)
+    cout << "Test 4: Surface vs Direct Pricing" << endl;
+    PriceSurface fine(base, quarterly, PUT, 0.05, 3, 5000, 12345);
+    fine.addAxis(SWEEP_F0, 95.0, 105.0, 8);
+    fine.addAxis(SWEEP_STRIKE, 95.0, 105.0, 8);
+    fine.build(pool);
+    cout << "Error bound " << fine.getErrorBound() << " (truncation " << fine.getTruncationError()
+         << ", max std error " << fine.getMaxStandardError() << ")" << endl;
+    double offNode[][2] = {{96.3, 101.7}, {100.0, 100.0}, {102.9, 97.1}, {104.2, 104.6}};
+    bool directOK = true;
+    for (int p = 0; p < 4; p++) {
+        SweepScenario s = base;
+        s.F0 = offNode[p][0];
+        s.strike = offNode[p][1];
+        SABRSimulator sim(s.F0, s.alpha0, s.beta, s.nu, s.rho, 12345);
+        BermudanOption option(s.strike, quarterly, PUT);
+        LSMPricer pricer(0.05, 3);
+        pricer.setVerbose(false);
+        double direct = pricer.price(sim, option, 5000);
+        double interpolated = fine.price(s);
+        bool within = fabs(interpolated - direct) <= fine.getErrorBound();
+        cout << "F0=" << s.F0 << " K=" << s.strike << ": surface " << interpolated
+             << ", direct " << direct << (within ? "" : "  OUTSIDE BOUND") << endl;
+        directOK = directOK && within;
+    }
+    cout << "Direct pricing test: " << (directOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 5: delta (derivative of the series along F0) matches a central
+    // difference of price()
+    cout << "Test 5: Delta vs Finite Difference" << endl;
+    bool deltaOK = true;
+    for (int p = 0; p < 4; p++) {
+        SweepScenario s = base;
+        s.F0 = offNode[p][0];
+        s.strike = offNode[p][1];
+        double h = 1e-4;
+        SweepScenario up = s, down = s;
+        up.F0 += h;
+        down.F0 -= h;
+        double difference = (fine.price(up) - fine.price(down)) / (2.0 * h);
+        double delta = fine.delta(s);
+        bool close = fabs(delta - difference) <= 1e-6 * (1.0 + fabs(delta));
+        cout << "F0=" << s.F0 << " K=" << s.strike << ": delta " << delta
+             << ", finite difference " << difference << (close ? "" : "  MISMATCH") << endl;
+        deltaOK = deltaOK && close;
+    }
+    cout << "Delta test: " << (deltaOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 6: rebuildIfDrifted keeps the surface while the scenario stays in
+    // the domain, and re-centres the drifted axis when it leaves
+    cout << "Test 6: Rebuild on Drift" << endl;
+    SweepScenario inside = base;
+    inside.F0 = 103.0;
+    inside.strike = 99.0;
+    double before = surface.price(inside);
+    bool kept = !surface.rebuildIfDrifted(inside, pool) && surface.price(inside) == before;
+    SweepScenario outside = base;
+    outside.F0 = 112.0;
+    outside.strike = 99.0;
+    bool coveredBefore = surface.covers(outside);
+    bool rebuilt = surface.rebuildIfDrifted(outside, pool);
+    SweepScenario edge = outside;
+    edge.F0 = 107.5;   // Inside the re-centred [107, 117]
+    bool recentred = surface.covers(outside) && surface.covers(edge) && !surface.covers(inside)
+                  && surface.isBuilt();
+    SweepScenario moved = base;
+    moved.F0 = 112.0;
+    moved.strike = 99.0;
+    moved.nu = 0.5;     // Fixed parameter: any change rebuilds
+    bool fixedRebuilt = surface.rebuildIfDrifted(moved, pool) && surface.getBase().nu == 0.5;
+    cout << "Inside kept: " << kept << ", outside covered before: " << coveredBefore
+         << ", rebuilt: " << rebuilt << ", re-centred: " << recentred
+         << ", fixed parameter change rebuilt: " << fixedRebuilt << endl;
+    bool driftOK = kept && !coveredBefore && rebuilt && recentred && fixedRebuilt;
+    cout << "Rebuild test: " << (driftOK ? "PASS" : "FAIL") << endl << endl;
+
+    remove(file.c_str());
+    remove(corrupted.c_str());
+    rmdir(directory.c_str());
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (roundTripOK && malformedOK && axisOK && directOK && deltaOK && driftOK) ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <unistd.h>
+#include "PricingCache.h"
+
+using namespace std;
+
+// Synthetic key differing by strike
+static PricingKey makeTestKey(double strike) {
+    PricingKey key;
+    key.F0 = 100.0;
+    key.alpha0 = 0.20;
+    key.beta = 0.5;
+    key.nu = 0.4;
+    key.rho = -0.3;
+    key.strike = strike;
+    key.type = static_cast<int>(PUT);
+    key.dates = {0.25, 0.5, 0.75, 1.0};
+    key.r = 0.05;
+    key.polyDegree = 3;
+    key.nPaths = 1000;
+    key.nSteps = 75;
+    key.seed = 12345;
+    return key;
+}
+
+static CacheEntry makeTestEntry(double price) {
+    CacheEntry entry;
+    entry.price = price;
+    entry.standardError = 0.01;
+    entry.exercisePolicy.assign(3, vector<double>(4, price));
+    return entry;
+}
+
+// Disk file of a key (PricingCache::diskPath layout)
+static string cacheFile(const string& directory, const PricingKey& key) {
+    ostringstream oss;
+    oss << directory << "/" << hex << setw(16) << setfill('0')
+        << PricingCache::hashKey(key) << ".cache";
+    return oss.str();
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Pricing Cache Test" << endl;
+    cout << "========================================" << endl << endl;
+    cout << fixed << setprecision(6);
+
+    // Test 1: read-through pricing, miss then hit
+    cout << "Test 1: Hit and Miss" << endl;
+    vector<double> quarterly = {0.25, 0.5, 0.75, 1.0};
+    BermudanOption put(100.0, quarterly, PUT);
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    SABRSimulator sim(100.0, 0.20, 0.5, 0.4, -0.3, 12345);
+    PricingCache cache(8);
+    double first = cache.price(pricer, sim, put, 5000);
+    double second = cache.price(pricer, sim, put, 5000);
+    double direct = pricer.price(sim, put, 5000);
+    cout << "First: " << first << ", second: " << second << ", uncached: " << direct
+         << " (hits " << cache.getHits() << ", misses " << cache.getMisses() << ")" << endl;
+    bool hitOK = first == direct && second == direct
+              && cache.getHits() == 1 && cache.getMisses() == 1;
+    cout << "Hit/miss test: " << (hitOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: least recently used entry is evicted
+    cout << "Test 2: LRU Eviction" << endl;
+    PricingCache small(2);
+    CacheEntry found;
+    small.store(makeTestKey(90.0), makeTestEntry(1.0));
+    small.store(makeTestKey(100.0), makeTestEntry(2.0));
+    small.lookup(makeTestKey(90.0), found);              // 90 most recent
+    small.store(makeTestKey(110.0), makeTestEntry(3.0));  // Evicts 100
+    bool kept90 = small.lookup(makeTestKey(90.0), found) && found.price == 1.0;
+    bool kept110 = small.lookup(makeTestKey(110.0), found) && found.price == 3.0;
+    bool evicted100 = !small.lookup(makeTestKey(100.0), found);
+    cout << "Size " << small.size() << ", K=90 kept: " << kept90 << ", K=110 kept: " << kept110
+         << ", K=100 evicted: " << evicted100 << endl;
+    bool evictionOK = small.size() == 2 && kept90 && kept110 && evicted100;
+    cout << "Eviction test: " << (evictionOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: disk tier survives a new cache instance and clear()
+    cout << "Test 3: Disk Round Trip" << endl;
+    char dirTemplate[] = "/tmp/pricing_cache_test_XXXXXX";
+    string directory = mkdtemp(dirTemplate);
+    PricingKey key = makeTestKey(105.0);
+    CacheEntry stored = makeTestEntry(4.25);
+    {
+        PricingCache writer(4, directory);
+        writer.store(key, stored);
+    }
+    PricingCache reader(4, directory);
+    bool loaded = reader.lookup(key, found);
+    bool sameEntry = loaded && found.price == stored.price
+                  && found.standardError == stored.standardError
+                  && found.exercisePolicy == stored.exercisePolicy;
+    reader.clear();
+    bool reloaded = reader.lookup(key, found) && found.price == stored.price;
+    cout << "Loaded: " << loaded << ", identical: " << sameEntry
+         << ", reloaded after clear: " << reloaded << endl;
+    bool diskOK = sameEntry && reloaded;
+    cout << "Disk test: " << (diskOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 4: entry written under another PRICER_VERSION_TAG is ignored
+    // (magic, tag length, then the tag: overwrite its first byte)
+    cout << "Test 4: Stale Version Tag" << endl;
+    string file = cacheFile(directory, key);
+    {
+        fstream f(file.c_str(), ios::in | ios::out | ios::binary);
+        f.seekp(8 + sizeof(int));
+        f.put('#');
+    }
+    PricingCache stale(4, directory);
+    bool staleRejected = !stale.lookup(key, found);
+    cout << "Stale entry rejected: " << staleRejected << endl;
+    bool staleOK = staleRejected;
+    cout << "Stale tag test: " << (staleOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 5: invalid results are never cached
+    cout << "Test 5: Invalid Entries" << endl;
+    PricingCache guarded(4, directory);
+    PricingKey badKey = makeTestKey(95.0);
+    bool negativeRejected = !guarded.store(badKey, makeTestEntry(-1.0));
+    bool nanRejected = !guarded.store(badKey, makeTestEntry(numeric_limits<double>::quiet_NaN()));
+    PricingControl control;
+    control.cancel();
+    pricer.setControl(&control);
+    double cancelled = guarded.price(pricer, sim, put, 5000);
+    pricer.setControl(0);
+    bool nothingStored = guarded.size() == 0 && !guarded.lookup(badKey, found);
+    cout << "Negative rejected: " << negativeRejected << ", NaN rejected: " << nanRejected
+         << ", cancelled pricing " << cancelled << " not stored: " << nothingStored << endl;
+    bool invalidOK = negativeRejected && nanRejected && cancelled == -1.0 && nothingStored;
+    cout << "Invalid entry test: " << (invalidOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Remove the disk tier
+    remove(file.c_str());
+    remove(cacheFile(directory, badKey).c_str());
+    rmdir(directory.c_str());
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (hitOK && evictionOK && diskOK && staleOK && invalidOK) ? 0 : 1;
+}
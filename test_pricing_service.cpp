@@ -0,0 +1,133 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "PricingService.h"
+#include "SABRSimulator.h"
+#include "LSMPricer.h"
+
+using namespace std;
+
+// Value of "key=" in a response line ("" if absent)
+static string field(const string& line, const string& key) {
+    istringstream in(line);
+    string token;
+    while (in >> token) {
+        if (token.compare(0, key.size() + 1, key + "=") == 0) {
+            return token.substr(key.size() + 1);
+        }
+    }
+    return "";
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Pricing Service Test" << endl;
+    cout << "========================================" << endl << endl;
+    cout << setprecision(10);
+
+    PricingService service(2, 64);
+
+    // Test 1: malformed and out-of-range requests are answered with errors
+    cout << "Test 1: Request Validation" << endl;
+    vector<string> bad = {
+        "id=1 paths=-4294957296", "id=2 degree=-4294967295", "id=3 paths=0",
+        "id=4 paths=10000001", "id=5 paths=12x", "id=6 degree=11", "id=7 seed=-1",
+        "id=8 rho=1", "id=9 F0=-1", "id=10 K=nan", "id=11 beta=1.5", "id=12 nu=-0.1",
+        "id=13 type=straddle", "id=14 dates=0.5,0.25", "id=15 color=blue", "id=16 noequals",
+        "id=17 paths=10000000 dates=1,2,3,4,5"};
+    vector<string> badResponses = service.processBatch(bad);
+    bool validationOK = badResponses.size() == bad.size();
+    for (size_t i = 0; i < badResponses.size(); i++) {
+        bool rejected = !field(badResponses[i], "error").empty() && field(badResponses[i], "price").empty();
+        if (!rejected) {
+            cout << "Accepted: " << bad[i] << " -> " << badResponses[i] << endl;
+        }
+        validationOK = validationOK && rejected;
+    }
+    cout << bad.size() << " requests, all rejected: " << validationOK << endl;
+    cout << "Validation test: " << (validationOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: a strike ladder on one model shares one simulation, a second
+    // model gets its own; prices match a standalone LSMPricer
+    cout << "Test 2: Shared Simulation per Group" << endl;
+    vector<string> batch = {
+        "id=a K=95 paths=5000", "id=b K=100 paths=5000", "id=c K=105 type=put paths=5000",
+        "id=d K=100 nu=0.6 paths=5000"};
+    vector<string> priced = service.processBatch(batch);
+    string stats = service.processBatch(vector<string>(1, "stats"))[0];
+    vector<double> strikes = {95.0, 100.0, 105.0, 100.0};
+    vector<OptionType> types = {CALL, CALL, PUT, CALL};
+    vector<double> quarterly = {0.25, 0.5, 0.75, 1.0};
+    bool pricesOK = priced.size() == batch.size();
+    for (size_t i = 0; i < priced.size() && pricesOK; i++) {
+        SABRSimulator sim(100.0, 0.20, 0.5, (i == 3) ? 0.6 : 0.4, -0.3, 12345);
+        BermudanOption option(strikes[i], quarterly, types[i]);
+        LSMPricer pricer(0.05, 3);
+        pricer.setVerbose(false);
+        double direct = pricer.price(sim, option, 5000);
+        double served = atof(field(priced[i], "price").c_str());
+        cout << priced[i] << " (direct " << direct << ")" << endl;
+        pricesOK = fabs(served - direct) <= 1e-9 * fabs(direct) + 1e-12;
+    }
+    bool groupsOK = field(stats, "simulations") == "2";
+    cout << "Simulations: " << field(stats, "simulations") << endl;
+    bool groupOK = pricesOK && groupsOK;
+    cout << "Group test: " << (groupOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: a repeated request is a cache hit and simulates nothing
+    cout << "Test 3: Cache Hit" << endl;
+    string again = service.processBatch(vector<string>(1, "id=b2 K=100 paths=5000"))[0];
+    stats = service.processBatch(vector<string>(1, "stats"))[0];
+    cout << again << endl << stats << endl;
+    bool cacheOK = field(again, "cached") == "1" && field(again, "price") == field(priced[1], "price")
+                && field(stats, "cache_hits") == "1" && field(stats, "simulations") == "2";
+    cout << "Cache test: " << (cacheOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 4: stats counts priced requests (not stats lines or rejected
+    // requests) and the batches completed before it (4 so far)
+    cout << "Test 4: Stats" << endl;
+    bool statsOK = stats.compare(0, 6, "stats ") == 0 && field(stats, "requests") == "5"
+                && field(stats, "batches") == "4" && !field(stats, "p99_us").empty();
+    cout << "Requests " << field(stats, "requests") << ", batches " << field(stats, "batches") << endl;
+    cout << "Stats test: " << (statsOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 5: serve() answers an over-long unterminated line with an error
+    // and carries on with the next line
+    cout << "Test 5: Line Length Limit" << endl;
+    char inName[] = "/tmp/pricing_service_in_XXXXXX";
+    char outName[] = "/tmp/pricing_service_out_XXXXXX";
+    int inFd = mkstemp(inName);
+    int outFd = mkstemp(outName);
+    {
+        ofstream in(inName);
+        in << string(200000, 'x') << "\nid=z K=100 paths=5000\n";
+    }
+    service.serve(inFd, outFd);
+    close(inFd);
+    close(outFd);
+    vector<string> served;
+    {
+        ifstream out(outName);
+        string line;
+        while (getline(out, line)) served.push_back(line);
+    }
+    remove(inName);
+    remove(outName);
+    for (size_t i = 0; i < served.size(); i++) cout << served[i] << endl;
+    bool lineOK = served.size() == 2 && !field(served[0], "error").empty()
+               && field(served[1], "id") == "z" && field(served[1], "price") == field(priced[1], "price");
+    cout << "Line length test: " << (lineOK ? "PASS" : "FAIL") << endl << endl;
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (validationOK && groupOK && cacheOK && statsOK && lineOK) ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include "ShardedPricer.h"
+#include "ThreadPool.h"
+#include "LSMPricer.h"
+
+using namespace std;
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Sharded Pricer Test" << endl;
+    cout << "========================================" << endl << endl;
+
+    vector<double> dates = {0.25, 0.5, 0.75, 1.0};
+    BermudanOption put(100.0, dates, PUT);
+    SABRParameters params = {100.0, 0.20, 0.5, 0.4, -0.3};
+    unsigned int seed = 12345;
+    int nPaths = 20000;
+    cout << fixed << setprecision(8);
+
+    // Test 1: one shard reproduces the single-process pricer
+    cout << "Test 1: One Shard vs LSMPricer" << endl;
+    SABRSimulator sim(params, seed);
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    double reference = pricer.price(sim, put, nPaths);
+    ShardedPricer single(0.05, 3, 1);
+    double oneShard = single.price(params, seed, put, nPaths);
+    cout << "LSMPricer: " << reference << ", one shard: " << oneShard << endl;
+    bool singleOK = oneShard == reference
+                 && single.getStandardError() == pricer.getStandardError();
+    cout << "Single shard test: " << (singleOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: worker processes vs in-process shards
+    cout << "Test 2: Four Worker Processes" << endl;
+    ShardedPricer sharded(0.05, 3, 4);
+    double processes = sharded.price(params, seed, put, nPaths);
+    double processesError = sharded.getStandardError();
+    double inProcess = sharded.priceInProcess(params, seed, put, nPaths);
+    cout << "Processes: " << processes << " (std error " << processesError
+         << "), in process: " << inProcess << endl;
+    bool shardedOK = processes > 0.0 && processes == inProcess
+                  && fabs(processes - reference) < pricer.getStandardError();
+    cout << "Sharded test: " << (shardedOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: traffic does not grow with the path count
+    cout << "Test 3: Communication Volume" << endl;
+    long long bytesSmall = sharded.getBytesExchanged();
+    sharded.price(params, seed, put, 4 * nPaths);
+    long long bytesLarge = sharded.getBytesExchanged();
+    cout << nPaths << " paths: " << bytesSmall << " bytes, "
+         << 4 * nPaths << " paths: " << bytesLarge << " bytes" << endl;
+    bool trafficOK = bytesSmall > 0 && bytesSmall == bytesLarge;
+    cout << "Communication test: " << (trafficOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 4: one shard per pinned pool worker
+    cout << "Test 4: Pinned Thread Pool" << endl;
+    ThreadPool pool(3, true);
+    ShardedPricer threaded(0.05, 3, 3);
+    double onPool = threaded.priceOnPool(pool, params, seed, put, nPaths);
+    double reference3 = threaded.priceInProcess(params, seed, put, nPaths);
+    cout << "Pool: " << onPool << " (worker 0 on CPU " << pool.getWorkerCpu(0)
+         << "), in process: " << reference3 << endl;
+    bool poolOK = onPool > 0.0 && onPool == reference3;
+    cout << "Pool test: " << (poolOK ? "PASS" : "FAIL") << endl << endl;
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (singleOK && shardedOK && trafficOK && poolOK) ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include "TimeGrid.h"
+#include "SABRSimulator.h"
+#include "LSMPricer.h"
+
+using namespace std;
+
+// Standard normal CDF
+static double normalCdf(double x) {
+    return 0.5 * erfc(-x / sqrt(2.0));
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Time Grid Test" << endl;
+    cout << "========================================" << endl << endl;
+    cout << fixed << setprecision(6);
+
+    // Test 1: irregular schedule, dates on the grid
+    cout << "Test 1: Grid from an Irregular Schedule" << endl;
+    vector<double> dates = {0.1, 0.35, 1.0};
+    TimeGrid grid = TimeGrid::fromSchedule(dates, 0.02);
+    bool onGrid = grid.getNExerciseDates() == 3;
+    for (int m = 0; m < grid.getNExerciseDates(); m++) {
+        cout << "Date " << dates[m] << " -> step " << grid.getExerciseStep(m)
+             << " (t = " << grid.getTime(grid.getExerciseStep(m)) << ")" << endl;
+        onGrid = onGrid && grid.getTime(grid.getExerciseStep(m)) == dates[m];
+    }
+    // Periods of 0.1, 0.25 and 0.65 take 5, 13 and 33 steps
+    bool gridOK = onGrid && grid.getExerciseStep(0) == 5 && grid.getExerciseStep(1) == 18
+               && grid.getNSteps() == 51 && grid.getMaxDt() <= 0.02 + 1e-15;
+    cout << grid.getNSteps() << " steps, largest dt " << grid.getMaxDt() << endl;
+    cout << "Grid test: " << (gridOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: regular schedule, schedule grid vs uniform grid
+    cout << "Test 2: Regular Schedule" << endl;
+    vector<double> quarterly = {0.25, 0.5, 0.75, 1.0};
+    BermudanOption put(100.0, quarterly, PUT);
+    SABRParameters params = {100.0, 0.20, 0.5, 0.4, -0.3};
+    LSMPricer pricer(0.05, 3);
+    pricer.setVerbose(false);
+    SABRSimulator sim(params, 12345);
+    double uniformPrice = pricer.price(sim, put, 20000);
+    double error = pricer.getStandardError();
+    pricer.setMaxTimeStep(0.01);
+    double schedulePrice = pricer.price(sim, put, 20000);
+    cout << "Uniform grid: " << uniformPrice << ", schedule grid: " << schedulePrice
+         << " (std error " << error << ")" << endl;
+    bool regularOK = fabs(uniformPrice - schedulePrice) < error;
+    cout << "Regular schedule test: " << (regularOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: single date (no uniform grid) against Black's formula
+    // (beta = 1, nu = 0: lognormal forward with volatility alpha0)
+    cout << "Test 3: European Limit vs Black" << endl;
+    vector<double> maturity = {1.0};
+    BermudanOption call(100.0, maturity, CALL);
+    SABRSimulator lognormal(100.0, 0.20, 1.0, 0.0, 0.0, 12345);
+    double european = pricer.price(lognormal, call, 50000);
+    double europeanError = pricer.getStandardError();
+    double d1 = 0.5 * 0.20;
+    double black = exp(-0.05) * 100.0 * (normalCdf(d1) - normalCdf(-d1));
+    cout << "Monte Carlo: " << european << " (std error " << europeanError
+         << "), Black: " << black << endl;
+    bool europeanOK = fabs(european - black) < 3.0 * europeanError;
+    cout << "European test: " << (europeanOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 4: dates off the grid are rejected
+    cout << "Test 4: Date Off the Grid" << endl;
+    TimeGrid coarse = TimeGrid::uniform(1.0, 10);
+    double** F_paths = new double*[10];
+    double** alpha_paths = new double*[10];
+    for (int i = 0; i < 10; i++) {
+        F_paths[i] = new double[coarse.getNSteps() + 1];
+        alpha_paths[i] = new double[coarse.getNSteps() + 1];
+    }
+    sim.simulatePaths(10, coarse, F_paths, alpha_paths);
+    BermudanOption offGrid(100.0, dates, PUT);
+    double rejected = pricer.priceFromPaths(F_paths, alpha_paths, 10, coarse, offGrid);
+    for (int i = 0; i < 10; i++) {
+        delete[] F_paths[i];
+        delete[] alpha_paths[i];
+    }
+    delete[] F_paths;
+    delete[] alpha_paths;
+    bool offGridOK = rejected == -1.0;
+    cout << "Off-grid test: " << (offGridOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 5: nested schedules; each level of the American-limit pricing is
+    // the Bermudan price of its schedule on the same paths
+    cout << "Test 5: Nested Schedules" << endl;
+    vector<double> fine = TimeGrid::refineSchedule(quarterly, 2);
+    vector<double> middle = TimeGrid::refineSchedule(quarterly, 1);
+    bool nested = fine.size() == 16 && middle.size() == 8 && fine[0] == 0.0625;
+    for (size_t k = 0; k < middle.size(); k++) {
+        nested = nested && fine[2 * k + 1] == middle[k];
+    }
+    BermudanOption itmPut(110.0, quarterly, PUT);
+    LSMPricer limitPricer(0.05, 3);
+    limitPricer.setVerbose(false);
+    limitPricer.setMaxTimeStep(1.0 / 128.0);
+    SABRSimulator limitSim(params, 12345);
+    double limit = limitPricer.priceAmericanLimit(limitSim, itmPut, 20000, 3);
+    vector<double> levels = limitPricer.getLevelPrices();
+    TimeGrid fineGrid = TimeGrid::fromSchedule(fine, 1.0 / 128.0);
+    vector<vector<double> > storage(2 * 20000, vector<double>(fineGrid.getNSteps() + 1));
+    vector<double*> F_rows(20000), alpha_rows(20000);
+    for (int i = 0; i < 20000; i++) {
+        F_rows[i] = &storage[2 * i][0];
+        alpha_rows[i] = &storage[2 * i + 1][0];
+    }
+    limitSim.simulatePaths(20000, fineGrid, &F_rows[0], &alpha_rows[0]);
+    BermudanOption level2(110.0, fine, PUT);
+    BermudanOption level1(110.0, middle, PUT);
+    double fullLevel2 = pricer.priceFromPaths(&F_rows[0], &alpha_rows[0], 20000, fineGrid, level2);
+    double fullLevel1 = pricer.priceFromPaths(&F_rows[0], &alpha_rows[0], 20000, fineGrid, level1);
+    double fullLevel0 = pricer.priceFromPaths(&F_rows[0], &alpha_rows[0], 20000, fineGrid, itmPut);
+    cout << "Levels (4, 8, 16 dates): " << levels[0] << ", " << levels[1] << ", " << levels[2]
+         << "; full paths: " << fullLevel0 << ", " << fullLevel1 << ", " << fullLevel2 << endl;
+    bool nestedOK = nested && levels.size() == 3 && levels[0] == fullLevel0
+                 && levels[1] == fullLevel1 && levels[2] == fullLevel2;
+    cout << "Nested schedule test: " << (nestedOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 6: extrapolated limit against a dense (128-date) schedule
+    cout << "Test 6: American Limit vs Dense Schedule" << endl;
+    double limitError = limitPricer.getStandardError();
+    double indicator = limitPricer.getExtrapolationError();
+    vector<double> denseDates;
+    for (int k = 1; k <= 128; k++) {
+        denseDates.push_back(k / 128.0);
+    }
+    BermudanOption densePut(110.0, denseDates, PUT);
+    SABRSimulator denseSim(params, 12345);
+    double dense = limitPricer.price(denseSim, densePut, 20000);
+    cout << "Extrapolated: " << limit << " (std error " << limitError << ", extrapolation "
+         << indicator << "), 128 dates: " << dense << ", 16 dates: " << levels[2] << endl;
+    bool limitOK = limit > 0.0
+                && fabs(limit - dense) < 3.0 * limitError + indicator
+                && fabs(limit - dense) < fabs(levels[2] - dense);
+    cout << "American limit test: " << (limitOK ? "PASS" : "FAIL") << endl << endl;
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (gridOK && regularOK && europeanOK && offGridOK && nestedOK && limitOK) ? 0 : 1;
+}
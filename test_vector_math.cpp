@@ -0,0 +1,259 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "VectorMath.h"
+#include "RandomGenerator.h"
+#include "SABRSimulator.h"
+
+using namespace std;
+
+// Distance in units in the last place (0 if equal or both NaN)
+static long long ulpDistance(double a, double b) {
+    if (a == b || (a != a && b != b)) return 0;
+    if (a != a || b != b) return 1LL << 62;
+    long long ia, ib;
+    memcpy(&ia, &a, sizeof(a));
+    memcpy(&ib, &b, sizeof(b));
+    if (ia < 0) ia = static_cast<long long>(0x8000000000000000ULL) - ia;
+    if (ib < 0) ib = static_cast<long long>(0x8000000000000000ULL) - ib;
+    return ia > ib ? ia - ib : ib - ia;
+}
+
+static bool sameBits(const vector<double>& a, const vector<double>& b) {
+    return memcmp(&a[0], &b[0], a.size() * sizeof(double)) == 0;
+}
+
+// Largest error of one function over a sample, against its bound
+static bool checkAccuracy(const char* name, long long maxUlp, long long bound) {
+    bool ok = maxUlp <= bound;
+    cout << left << setw(28) << name << right << setw(4) << maxUlp << " ulp (bound "
+         << bound << ")" << (ok ? "" : "  <-- FAIL") << endl;
+    return ok;
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "Vector Math Test" << endl;
+    cout << "========================================" << endl << endl;
+
+    RandomGenerator rng(2024);
+    const int n = 200001;   // Odd: exercises the partial last vector
+    vector<double> x(n), y(n), r(n), s(n), c(n);
+    long long worst, worst2;
+
+    // Test 1: accuracy against libm on the active instruction set
+    cout << "Test 1: Accuracy vs libm (" << VectorMath::isaName(VectorMath::getIsa()) << ")" << endl;
+    bool accuracyOK = true;
+    for (int i = 0; i < n; i++) x[i] = exp(-745.0 + 1454.0 * rng.generateUniform());
+    VectorMath::log(&x[0], &r[0], n);
+    worst = 0;
+    for (int i = 0; i < n; i++) worst = max(worst, ulpDistance(r[i], log(x[i])));
+    accuracyOK = checkAccuracy("log, full range", worst, 1) && accuracyOK;
+
+    for (int i = 0; i < n; i++) x[i] = rng.generateUniform();
+    VectorMath::log(&x[0], &r[0], n);
+    worst = 0;
+    for (int i = 0; i < n; i++) worst = max(worst, ulpDistance(r[i], log(x[i])));
+    accuracyOK = checkAccuracy("log, (0, 1)", worst, 1) && accuracyOK;
+
+    for (int i = 0; i < n; i++) x[i] = -708.0 + 1416.0 * rng.generateUniform();
+    VectorMath::exp(&x[0], &r[0], n);
+    worst = 0;
+    for (int i = 0; i < n; i++) worst = max(worst, ulpDistance(r[i], exp(x[i])));
+    accuracyOK = checkAccuracy("exp, [-708, 708]", worst, 1) && accuracyOK;
+
+    for (int i = 0; i < n; i++) x[i] = 0.001 + 1000.0 * rng.generateUniform();
+    VectorMath::pow(&x[0], 0.5, &r[0], n);
+    worst = 0;
+    for (int i = 0; i < n; i++) worst = max(worst, ulpDistance(r[i], pow(x[i], 0.5)));
+    accuracyOK = checkAccuracy("pow, F^0.5", worst, 1) && accuracyOK;
+
+    for (int i = 0; i < n; i++) {
+        x[i] = exp(-700.0 + 1400.0 * rng.generateUniform());
+        y[i] = -1.0 + 2.0 * rng.generateUniform();
+    }
+    VectorMath::pow(&x[0], &y[0], &r[0], n);
+    worst = 0;
+    for (int i = 0; i < n; i++) worst = max(worst, ulpDistance(r[i], pow(x[i], y[i])));
+    accuracyOK = checkAccuracy("pow, |y| <= 1", worst, 2) && accuracyOK;
+
+    for (int i = 0; i < n; i++) {
+        x[i] = exp(-170.0 + 340.0 * rng.generateUniform());
+        y[i] = -4.0 + 8.0 * rng.generateUniform();
+    }
+    VectorMath::pow(&x[0], &y[0], &r[0], n);
+    worst = 0;
+    for (int i = 0; i < n; i++) worst = max(worst, ulpDistance(r[i], pow(x[i], y[i])));
+    accuracyOK = checkAccuracy("pow, |y| <= 4", worst, 4) && accuracyOK;
+
+    for (int i = 0; i < n; i++) x[i] = 2.0 * M_PI * rng.generateUniform();
+    VectorMath::sincos(&x[0], &s[0], &c[0], n);
+    worst = 0;
+    worst2 = 0;
+    for (int i = 0; i < n; i++) {
+        worst = max(worst, ulpDistance(s[i], sin(x[i])));
+        worst2 = max(worst2, ulpDistance(c[i], cos(x[i])));
+    }
+    accuracyOK = checkAccuracy("sin, [0, 2 pi)", worst, 1) && accuracyOK;
+    accuracyOK = checkAccuracy("cos, [0, 2 pi)", worst2, 1) && accuracyOK;
+
+    for (int i = 0; i < n; i++) x[i] = -1.0e6 + 2.0e6 * rng.generateUniform();
+    VectorMath::sincos(&x[0], &s[0], &c[0], n);
+    worst = 0;
+    for (int i = 0; i < n; i++) {
+        worst = max(worst, ulpDistance(s[i], sin(x[i])));
+        worst = max(worst, ulpDistance(c[i], cos(x[i])));
+    }
+    accuracyOK = checkAccuracy("sincos, |x| <= 1e6", worst, 2) && accuracyOK;
+
+    for (int i = 0; i < n; i++) x[i] = 1.0e4 * rng.generateUniform();
+    VectorMath::sqrt(&x[0], &r[0], n);
+    worst = 0;
+    for (int i = 0; i < n; i++) worst = max(worst, ulpDistance(r[i], sqrt(x[i])));
+    accuracyOK = checkAccuracy("sqrt", worst, 0) && accuracyOK;
+    cout << "Accuracy test: " << (accuracyOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 2: special values follow libm
+    cout << "Test 2: Special Values" << endl;
+    double inf = HUGE_VAL;
+    double nan = std::nan("");
+    vector<double> special = {0.0, -0.0, -1.0, 1.0, 4.9e-324, 1.0e-310, 2.2250738585072014e-308,
+                              1.7976931348623157e308, inf, -inf, nan, 709.9, -709.9, -745.5,
+                              800.0, -800.0, 1.0e7, -3.0e15, 1.0e300};
+    int nSpecial = static_cast<int>(special.size());
+    vector<double> out(nSpecial), out2(nSpecial);
+    long long specialWorst = 0;
+    VectorMath::log(&special[0], &out[0], nSpecial);
+    for (int i = 0; i < nSpecial; i++) specialWorst = max(specialWorst, ulpDistance(out[i], log(special[i])));
+    VectorMath::exp(&special[0], &out[0], nSpecial);
+    for (int i = 0; i < nSpecial; i++) specialWorst = max(specialWorst, ulpDistance(out[i], exp(special[i])));
+    VectorMath::sqrt(&special[0], &out[0], nSpecial);
+    for (int i = 0; i < nSpecial; i++) specialWorst = max(specialWorst, ulpDistance(out[i], sqrt(special[i])));
+    VectorMath::sincos(&special[0], &out[0], &out2[0], nSpecial);
+    for (int i = 0; i < nSpecial; i++) {
+        specialWorst = max(specialWorst, ulpDistance(out[i], sin(special[i])));
+        specialWorst = max(specialWorst, ulpDistance(out2[i], cos(special[i])));
+    }
+    double exponents[] = {0.0, 0.5, -1.0, 2.0, 3.0, 100.0, -inf, nan};
+    for (size_t e = 0; e < sizeof(exponents) / sizeof(exponents[0]); e++) {
+        VectorMath::pow(&special[0], exponents[e], &out[0], nSpecial);
+        for (int i = 0; i < nSpecial; i++) {
+            specialWorst = max(specialWorst, ulpDistance(out[i], pow(special[i], exponents[e])));
+        }
+    }
+    cout << "Largest deviation from libm: " << specialWorst << " ulp" << endl;
+    bool specialOK = specialWorst <= 1;
+    cout << "Special values test: " << (specialOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 3: every instruction set and the scalar overloads agree bit for bit
+    cout << "Test 3: Instruction Sets" << endl;
+    const int m = 1003;
+    vector<double> a(m), b(m);
+    for (int i = 0; i < m; i++) {
+        a[i] = exp(-20.0 + 40.0 * rng.generateUniform());
+        b[i] = -50.0 + 100.0 * rng.generateUniform();
+    }
+    VectorIsa best = VectorMath::detectIsa();
+    vector<vector<double> > reference;
+    bool isaOK = true;
+    for (int isa = ISA_PORTABLE; isa <= best; isa++) {
+        VectorMath::setIsa(static_cast<VectorIsa>(isa));
+        vector<vector<double> > results(7, vector<double>(m));
+        VectorMath::log(&a[0], &results[0][0], m);
+        VectorMath::exp(&b[0], &results[1][0], m);
+        VectorMath::sqrt(&a[0], &results[2][0], m);
+        VectorMath::pow(&a[0], 0.7, &results[3][0], m);
+        VectorMath::pow(&a[0], &b[0], &results[4][0], m);
+        VectorMath::sincos(&b[0], &results[5][0], &results[6][0], m);
+        if (reference.empty()) {
+            reference = results;
+            for (int i = 0; i < m; i++) {
+                double sv, cv;
+                VectorMath::sincos(b[i], sv, cv);
+                isaOK = isaOK && VectorMath::log(a[i]) == results[0][i]
+                     && VectorMath::exp(b[i]) == results[1][i]
+                     && VectorMath::pow(a[i], 0.7) == results[3][i]
+                     && sv == results[5][i] && cv == results[6][i];
+            }
+        }
+        bool same = true;
+        for (size_t f = 0; f < results.size(); f++) {
+            same = same && sameBits(results[f], reference[f]);
+        }
+        cout << VectorMath::isaName(static_cast<VectorIsa>(isa)) << ": "
+             << (same ? "identical to portable" : "DIFFERS") << endl;
+        isaOK = isaOK && same;
+    }
+    VectorMath::setIsa(best);
+    cout << "Instruction set test: " << (isaOK ? "PASS" : "FAIL") << endl << endl;
+
+    // Test 4: batched paths reproduce single paths
+    cout << "Test 4: Batched vs Single-Path Simulation" << endl;
+    const int nStreams = 3;
+    const int nPairs = 50;
+    unsigned long long positions[nStreams];
+    vector<double> Z1(nPairs * nStreams), Z3(nPairs * nStreams);
+    for (int k = 0; k < nStreams; k++) {
+        rng.setStream(99, k);
+        positions[k] = rng.getPosition();
+    }
+    for (int p = 0; p < nPairs; p++) {
+        RandomGenerator::generateNormalPairs(positions, nStreams, &Z1[p * nStreams], &Z3[p * nStreams]);
+    }
+    bool normalsOK = true;
+    for (int k = 0; k < nStreams; k++) {
+        rng.setStream(99, k);
+        for (int p = 0; p < nPairs; p++) {
+            double first = rng.generateNormal();
+            double second = rng.generateNormal();
+            normalsOK = normalsOK && first == Z1[p * nStreams + k] && second == Z3[p * nStreams + k];
+        }
+        normalsOK = normalsOK && rng.getPosition() == positions[k];
+    }
+
+    // Lockstep simulatePaths vs the scalar scenario batch (all paths) and
+    // vs simulatePath on substream 0 (importance drift and weights)
+    int nPaths = 300;   // Not a multiple of the block size
+    int nSteps = 40;
+    SABRParameters params = {100.0, 0.20, 0.5, 0.4, -0.3};
+    SABRSimulator sim(params, 7);
+    vector<vector<double> > F(nPaths, vector<double>(nSteps + 1));
+    vector<vector<double> > alpha(nPaths, vector<double>(nSteps + 1));
+    vector<vector<double> > F_batch(nPaths, vector<double>(nSteps + 1));
+    vector<vector<double> > alpha_batch(nPaths, vector<double>(nSteps + 1));
+    vector<double*> F_rows(nPaths), alpha_rows(nPaths), F_batch_rows(nPaths), alpha_batch_rows(nPaths);
+    for (int i = 0; i < nPaths; i++) {
+        F_rows[i] = &F[i][0];
+        alpha_rows[i] = &alpha[i][0];
+        F_batch_rows[i] = &F_batch[i][0];
+        alpha_batch_rows[i] = &alpha_batch[i][0];
+    }
+    sim.simulatePaths(nPaths, nSteps, 1.0, &F_rows[0], &alpha_rows[0]);
+    double** F_scenario = &F_batch_rows[0];
+    double** alpha_scenario = &alpha_batch_rows[0];
+    sim.simulatePathsBatch(1, &params, nPaths, nSteps, 1.0, &F_scenario, &alpha_scenario);
+    bool pathsOK = F == F_batch && alpha == alpha_batch;
+
+    sim.setImportanceDrift(0.3);
+    vector<double> weight(nSteps + 1);
+    double* weight_row = &weight[0];
+    sim.simulatePaths(1, nSteps, 1.0, &F_rows[0], &alpha_rows[0], 0, &weight_row);
+    SABRSimulator single(params, 7);
+    single.setImportanceDrift(0.3);
+    vector<double> F_single(nSteps + 1), alpha_single(nSteps + 1), weight_single(nSteps + 1);
+    single.simulatePath(nSteps, 1.0, &F_single[0], &alpha_single[0], &weight_single[0]);
+    pathsOK = pathsOK && F[0] == F_single && alpha[0] == alpha_single && weight == weight_single;
+
+    cout << "Normals: " << (normalsOK ? "match" : "differ") << ", paths: "
+         << (pathsOK ? "match" : "differ") << endl;
+    bool batchOK = normalsOK && pathsOK;
+    cout << "Batch test: " << (batchOK ? "PASS" : "FAIL") << endl << endl;
+
+    cout << "========================================" << endl;
+    cout << "All tests completed!" << endl;
+    cout << "========================================" << endl;
+
+    return (accuracyOK && specialOK && isaOK && batchOK) ? 0 : 1;
+}